@@ -33,8 +33,7 @@ public:
  
   void counter() {
     DataFrame* v = kd_.wait_and_get(&main);
-    double sum = 0;
-    for (size_t i = 0; i < 100*1000; ++i) sum += v->get_double(0,i);
+    double sum = v->sum(0);
     p("The sum is  ").pln(sum);
     DataFrame* df = DataFrame::from_scalar(&verify, &kd_, sum);
 
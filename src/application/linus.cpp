@@ -108,12 +108,16 @@ public:
     SetUpdater upd(delta);  
     newUsers->map(upd); // all of the new users are copied to delta.
     delete newUsers;
+    // The taggers only read the pid and the author uid of the commits
+    IntArray pid_uid(2);
+    pid_uid.push(0);
+    pid_uid.push(1);
     ProjectsTagger ptagger(delta, *pSet, projects);
-    commits->local_map(ptagger); // marking all projects touched by delta
+    commits->local_pmap(ptagger, pid_uid); // marking all projects touched by delta
     merge(ptagger.newProjects, "projects", stage);
     pSet->union_(ptagger.newProjects); // 
     UsersTagger utagger(ptagger.newProjects, *uSet, users);
-    commits->local_map(utagger);
+    commits->local_pmap(utagger, pid_uid);
     merge(utagger.newUsers, "users", stage + 1);
     uSet->union_(utagger.newUsers);
     p("    after stage ").p(stage).pln(":");
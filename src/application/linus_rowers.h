@@ -70,10 +70,13 @@ public:
   
   SetUpdater(Set& set): set_(set) {}
 
-  /** Assume a row with at least one column of type I. Assumes that there
-   * are no missing. Reads the value and sets the corresponding position.
+  /** Assume a row with at least one column of type I. Reads the value and
+   * sets the corresponding position, a missing value is skipped.
    * The return value is irrelevant here. */
-  bool accept(Row & row) { set_.set(row.get_int(0));  return false; }
+  bool accept(Row & row) {
+    if (!row.is_missing(0)) set_.set(row.get_int(0));
+    return false;
+  }
 
   void join_delete(Rower* other) { delete other; }
 
@@ -116,7 +119,7 @@ public:
  * of Linus, then the project is added to the set. If the project was
  * already tagged then it is not added to the set of newProjects.
  *************************************************************************/
-class ProjectsTagger : public Rower {
+class ProjectsTagger : public BatchRower {
 public:
   Set& uSet; // set of collaborator 
   Set& pSet; // set of projects of collaborators
@@ -125,21 +128,30 @@ public:
   ProjectsTagger(Set& uSet, Set& pSet, DataFrame* proj):
     uSet(uSet), pSet(pSet), newProjects(proj) {}
 
+  ProjectsTagger(Set& uSet, Set& pSet, size_t num_projects):
+    uSet(uSet), pSet(pSet), newProjects(num_projects) {}
+
   /** The data frame must have at least two integer columns. The newProject
    * set keeps track of projects that were newly tagged (they will have to
-   * be communicated to other nodes). */
-  bool accept(Row & row) override {
-    int pid = row.get_int(0);
-    int uid = row.get_int(1);
-    if (uSet.test(uid)) 
-      if (!pSet.test(pid)) {
-    	  pSet.set(pid);
-        newProjects.set(pid);
-      }
-    return false;
+   * be communicated to other nodes). pSet is only read, so that clones can
+   * share it, the caller adds newProjects to it once the map is done. Rows
+   * missing either id are skipped. */
+  void accept(RowBatch & batch) override {
+    int* pids = batch.ints(0);
+    int* uids = batch.ints(1);
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      if (batch.is_missing(0, ii) || batch.is_missing(1, ii)) continue;
+      int pid = pids[ii];
+      if (uSet.test(uids[ii]) && !pSet.test(pid)) newProjects.set(pid);
+    }
   }
 
-	void join_delete(Rower* other) { delete other; }
+  BatchRower* clone() override { return new ProjectsTagger(uSet, pSet, newProjects.size()); }
+
+  void join_delete(BatchRower* other) {
+    newProjects.union_(dynamic_cast<ProjectsTagger*>(other)->newProjects);
+    delete other;
+  }
 };
 
 /***************************************************************************
@@ -150,7 +162,7 @@ public:
  * where the pid is the idefntifier of a project and the uids are the
  * identifiers of the author and committer. 
  *************************************************************************/
-class UsersTagger : public Rower {
+class UsersTagger : public BatchRower {
 public:
   Set& pSet;
   Set& uSet;
@@ -159,16 +171,25 @@ public:
   UsersTagger(Set& pSet,Set& uSet, DataFrame* users):
     pSet(pSet), uSet(uSet), newUsers(users->nrows()) { }
 
-  bool accept(Row & row) override {
-    int pid = row.get_int(0);
-    int uid = row.get_int(1);
-    if (pSet.test(pid)) 
-      if(!uSet.test(uid)) {
-				uSet.set(uid);
-				newUsers.set(uid);
-      }
-    return false;
+  UsersTagger(Set& pSet,Set& uSet, size_t num_users):
+    pSet(pSet), uSet(uSet), newUsers(num_users) { }
+
+  /** Like ProjectsTagger, uSet is only read and newUsers added to it after the map, and rows
+    * missing either id are skipped. */
+  void accept(RowBatch & batch) override {
+    int* pids = batch.ints(0);
+    int* uids = batch.ints(1);
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      if (batch.is_missing(0, ii) || batch.is_missing(1, ii)) continue;
+      int uid = uids[ii];
+      if (pSet.test(pids[ii]) && !uSet.test(uid)) newUsers.set(uid);
+    }
   }
 
-	void join_delete(Rower* other) { delete other; }
+  BatchRower* clone() override { return new UsersTagger(pSet, uSet, newUsers.size()); }
+
+  void join_delete(BatchRower* other) {
+    newUsers.union_(dynamic_cast<UsersTagger*>(other)->newUsers);
+    delete other;
+  }
 };
\ No newline at end of file
@@ -12,71 +12,26 @@
  **********************************************************author: pmaj ****/
 class WordCount: public Application {
 public:
-  static const size_t BUFSIZE = 1024;
   Key in;
-  String buf;
-  SIMap all;
   const char* file_;
  
   WordCount(size_t node_index, const char* my_ip, const char* server_ip, const char* file):
-    Application(node_index, my_ip, server_ip), in("data", 0), buf("wc-map-") {
+    Application(node_index, my_ip, server_ip), in("data", 0) {
         file_ = file;
      }
  
-  /** The master nodes reads the input, then all of the nodes count. */
+  /** The master node reads the input and ships the count to the other nodes, every node counting
+   *  the words of the chunks it holds. The other nodes only serve their chunks and rowers. */
   void run_() override {
-    if (node_index_ == 0) {
-      FileReader fr(file_);
-      DataFrame* file_reader = DataFrame::from_rower(&in, &kd_, "S", fr);
-      delete file_reader;
-    }
-    local_count();
-    reduce();
-  }
- 
-  /** Returns a key for given node.  These keys are homed on master node
-   *  which then joins them one by one. */
-  Key* mk_key(size_t idx) {
-    String s(buf);
-    s.concat(idx);
-    Key * k = new Key(&s, 0);
-    return k;
-  }
- 
-  /** Compute word counts on the local node and build a data frame. */
-  void local_count() {
-    DataFrame* words = (kd_.wait_and_get(&in));
-    p("Node ").p(node_index_).pln(": starting local count...");
-    SIMap map;
-    Adder add(map);
-    words->local_map(add);
-    delete words;
-    Summer cnt(map);
-    Key* node_key = mk_key(node_index_);
-    delete DataFrame::from_rower(node_key, &kd_, "SI", cnt);
-    delete node_key;
-  }
- 
-  /** Merge the data frames of all nodes */
-  void reduce() {
     if (node_index_ != 0) return;
-    pln("Node 0: reducing counts...");
+    FileReader fr(file_);
+    DataFrame* words = DataFrame::from_rower(&in, &kd_, "S", fr);
+    pln("Node 0: counting words on every node...");
     SIMap map;
-    Key* own = mk_key(0);
-    merge(kd_.get(own), map);
-    for (size_t i = 1; i < kd_.get_kv()->get_num_other_nodes(); ++i) { // merge other nodes
-      Key* ok = mk_key(i);
-      merge(kd_.wait_and_get(ok), map);
-      delete ok;
-    }
+    Adder add(map);
+    words->ship_map(add);
     p("Different words: ").pln(map.size());
-    delete own;
-  }
- 
-  void merge(DataFrame* df, SIMap& m) {
-    Adder add(m);
-    df->map(add);
-    delete df;
+    delete words;
   }
 }; // WordcountDemo
 
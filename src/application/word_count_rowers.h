@@ -119,12 +119,18 @@ public:
 class Adder : public Rower {
 public:
   SIMap& map_;  // String to Num map;  Num holds an int
+  SIMap* own_map_; // only set on clones, which count into their own map
  
-  Adder(SIMap& map) : map_(map)  {}
+  Adder(SIMap& map) : map_(map), own_map_(nullptr)  {}
+
+  Adder(SIMap* own_map) : map_(*own_map), own_map_(own_map) {}
+
+  ~Adder() { delete own_map_; }
  
+  /** Missing words are not counted. */
   bool accept(Row& r) override {
     String* word = r.get_string(0);
-    assert(word != nullptr);
+    if (word == nullptr) return false;
     Num* num = map_.get(word);
     if (num) {
         num->value++;
@@ -135,5 +141,63 @@ public:
     return false;
   }
 
-  void join_delete(Rower* other) { delete other; }
-};
\ No newline at end of file
+  Rower* clone() override { return new Adder(new SIMap()); }
+
+  const char* registered_name() override { return "Adder"; }
+
+  /** Rebuilds a shipped Adder, which counts into its own map. */
+  static Rower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    SIMap* map = new SIMap();
+    size_t num_words = deserializer.deserialize_size_t();
+    for (size_t ii = 0; ii < num_words; ii++) {
+      String word(deserializer);
+      Num count(deserializer.deserialize_size_t());
+      map->put(&word, &count);
+    }
+    return new Adder(map);
+  }
+
+  size_t serial_len() {
+    StringArray* words = map_.key_set();
+    size_t len = sizeof(size_t); // number of words
+    for (size_t ii = 0; ii < words->length(); ii++)
+      len += words->get(ii)->serial_len() + sizeof(size_t);
+    delete words;
+    return len;
+  }
+
+  /** Serializes the counts: the number of words, then every word followed by its count. */
+  char* serialize() {
+    Serializer serializer(serial_len());
+    StringArray* words = map_.key_set();
+    serializer.serialize_size_t(words->length());
+    for (size_t ii = 0; ii < words->length(); ii++) {
+      serializer.serialize_object(words->get(ii));
+      serializer.serialize_size_t(map_.get(words->get(ii))->value);
+    }
+    delete words;
+    return serializer.get_serial();
+  }
+
+  /** Adds the counts of the clone into this map. */
+  void join_delete(Rower* other) {
+    Adder* adder = dynamic_cast<Adder*>(other);
+    StringArray* words = adder->map_.key_set();
+    for (size_t ii = 0; ii < words->length(); ii++) {
+      String* word = words->get(ii);
+      size_t count = adder->map_.get(word)->value;
+      Num* num = map_.get(word);
+      if (num) {
+        num->value += count;
+      } else {
+        Num n(count);
+        map_.put(word, &n);
+      }
+    }
+    delete words;
+    delete other;
+  }
+};
+
+bool adder_registered_ = (rower_registry().add("Adder",
+  static_cast<RowerFactory>(Adder::deserialize)), true);
@@ -0,0 +1,113 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "kernels.h"
+#include "rower.h"
+#include "rower_registry.h"
+
+/*******************************************************************************
+ *  AggregateRower::
+ *  Aggregates one numeric column of the batches it is given with the kernels of
+ *  kernels.h. Clones start from an empty partial and are combined on join, so
+ *  the rower can be mapped in parallel and shipped to other nodes.
+ */
+class AggregateRower : public BatchRower {
+ public:
+  size_t col_;
+  Aggregate aggregate_;
+
+  AggregateRower(size_t col, Aggregate& aggregate) : aggregate_(aggregate) { col_ = col; }
+
+  AggregateRower(Deserializer& deserializer) : aggregate_(deserializer) {
+    col_ = deserializer.deserialize_size_t();
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new AggregateRower(deserializer);
+  }
+
+  void accept(RowBatch& batch) {
+    aggregate_.add_chunk(batch.chunks_[col_], batch.col_type(col_));
+  }
+
+  BatchRower* clone() {
+    Aggregate* empty = aggregate_.clone();
+    AggregateRower* rower = new AggregateRower(col_, *empty);
+    delete empty;
+    return rower;
+  }
+
+  void join_delete(BatchRower* other) {
+    aggregate_.combine(dynamic_cast<AggregateRower*>(other)->aggregate_);
+    delete other;
+  }
+
+  const char* registered_name() { return "AggregateRower"; }
+
+  size_t serial_len() { return aggregate_.serial_len() + sizeof(size_t); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(&aggregate_);
+    serializer.serialize_size_t(col_);
+    return serializer.get_serial();
+  }
+};
+
+// Registered when the program starts, as any node may be asked to run one
+bool aggregate_rower_registered_ = (rower_registry().add("AggregateRower",
+  static_cast<BatchRowerFactory>(AggregateRower::deserialize)), true);
+
+/*******************************************************************************
+ *  CountEqualRower::
+ *  Counts the strings of an 'S' column equal to a value, on the codes of the
+ *  dictionary encoded chunks, see count_equal_strings.
+ */
+class CountEqualRower : public BatchRower {
+ public:
+  size_t col_;
+  String* value_; // owned
+  size_t count_;
+
+  CountEqualRower(size_t col, String* value) {
+    col_ = col;
+    value_ = value->clone();
+    count_ = 0;
+  }
+
+  CountEqualRower(Deserializer& deserializer) {
+    col_ = deserializer.deserialize_size_t();
+    value_ = new String(deserializer);
+    count_ = deserializer.deserialize_size_t();
+  }
+
+  ~CountEqualRower() { delete value_; }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new CountEqualRower(deserializer);
+  }
+
+  void accept(RowBatch& batch) { count_ += count_equal_strings(batch.strings(col_), value_); }
+
+  BatchRower* clone() { return new CountEqualRower(col_, value_); }
+
+  void join_delete(BatchRower* other) {
+    count_ += dynamic_cast<CountEqualRower*>(other)->count_;
+    delete other;
+  }
+
+  const char* registered_name() { return "CountEqualRower"; }
+
+  size_t serial_len() { return sizeof(size_t) + value_->serial_len() + sizeof(size_t); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_size_t(col_);
+    serializer.serialize_object(value_);
+    serializer.serialize_size_t(count_);
+    return serializer.get_serial();
+  }
+};
+
+bool count_equal_rower_registered_ = (rower_registry().add("CountEqualRower",
+  static_cast<BatchRowerFactory>(CountEqualRower::deserialize)), true);
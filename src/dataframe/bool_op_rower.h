@@ -0,0 +1,130 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <algorithm>
+
+#include "../kv_store/key_array.h"
+#include "../kv_store/kv_store.h"
+#include "column.h"
+#include "kernels.h"
+#include "rower.h"
+#include "rower_registry.h"
+#include "zone_map.h"
+
+/*******************************************************************************
+ *  BoolOpRower::
+ *  Computes a op b between two 'B' columns of the batches it is given, a word at
+ *  a time with bool_op. Every result chunk is stored on the node that computed
+ *  it and recorded with the first row it covers, so the chunks of all the clones
+ *  line up with the rows of the frame once sorted, see DataFrame::bool_op_.
+ */
+class BoolOpRower : public BatchRower {
+ public:
+  String* name_; // owned, key of the result frame
+  size_t a_;
+  BoolOp op_;
+  size_t b_;
+  KV_Store* kv_; // not owned, store of the node the rower runs on
+  KeyArray* keys_; // owned, chunks written by this rower and the ones joined into it
+  IntArray* starts_; // owned, first row of every chunk
+  ZoneMaps* zones_; // owned, statistics of every chunk
+
+  BoolOpRower(String* name, size_t a, BoolOp op, size_t b, KV_Store* kv) {
+    name_ = name->clone();
+    a_ = a;
+    op_ = op;
+    b_ = b;
+    kv_ = kv;
+    keys_ = new KeyArray(1);
+    starts_ = new IntArray(1);
+    zones_ = new ZoneMaps();
+  }
+
+  BoolOpRower(Deserializer& deserializer, KV_Store* kv) {
+    name_ = new String(deserializer);
+    a_ = deserializer.deserialize_size_t();
+    op_ = static_cast<BoolOp>(deserializer.deserialize_int());
+    b_ = deserializer.deserialize_size_t();
+    kv_ = kv;
+    keys_ = new KeyArray(deserializer);
+    starts_ = new IntArray(deserializer);
+    zones_ = new ZoneMaps(deserializer);
+  }
+
+  ~BoolOpRower() {
+    delete name_;
+    delete keys_;
+    delete starts_;
+    delete zones_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new BoolOpRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    BoolArray* result = bool_op(batch.bools(a_), op_, batch.bools(b_));
+    String key_name(*name_);
+    key_name.concat("_0_");
+    key_name.concat(batch.start());
+    Key key(&key_name, kv_->get_node_index());
+    kv_->put(&key, result);
+    keys_->push(&key);
+    starts_->push(batch.start());
+    zones_->push(ZoneMap::of(result, 'B'));
+    delete result;
+  }
+
+  BatchRower* clone() { return new BoolOpRower(name_, a_, op_, b_, kv_); }
+
+  void join_delete(BatchRower* other) {
+    BoolOpRower* bool_op_rower = dynamic_cast<BoolOpRower*>(other);
+    for (size_t ii = 0; ii < bool_op_rower->keys_->length(); ii++) {
+      keys_->push(bool_op_rower->keys_->get(ii));
+      starts_->push(bool_op_rower->starts_->get(ii));
+      zones_->push(bool_op_rower->zones_->get(ii));
+    }
+    delete other;
+  }
+
+  /** Appends the chunks written to the column in row order. */
+  void add_chunks_to(Column* column) {
+    size_t num_chunks = keys_->length();
+    size_t* order = new size_t[max(num_chunks, 1)];
+    for (size_t ii = 0; ii < num_chunks; ii++) order[ii] = ii;
+    std::sort(order, order + num_chunks,
+      [this](size_t x, size_t y) { return starts_->get(x) < starts_->get(y); });
+    for (size_t ii = 0; ii < num_chunks; ii++) {
+      assert((size_t)starts_->get(order[ii]) == column->size());
+      ZoneMap zone = zones_->get(order[ii]);
+      column->push_back_key(keys_->get(order[ii]), zone.count_ + zone.nulls_, zone);
+    }
+    delete[] order;
+  }
+
+  const char* registered_name() { return "BoolOpRower"; }
+
+  size_t serial_len() {
+    return name_->serial_len()
+      + sizeof(size_t) + sizeof(int) + sizeof(size_t)
+      + keys_->serial_len()
+      + starts_->serial_len()
+      + zones_->serial_len();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(name_);
+    serializer.serialize_size_t(a_);
+    serializer.serialize_int(static_cast<int>(op_));
+    serializer.serialize_size_t(b_);
+    serializer.serialize_object(keys_);
+    serializer.serialize_object(starts_);
+    serializer.serialize_object(zones_);
+    return serializer.get_serial();
+  }
+};
+
+// Registered when the program starts, as any node may be asked to run one
+bool bool_op_rower_registered_ = (rower_registry().add("BoolOpRower",
+  static_cast<BatchRowerFactory>(BoolOpRower::deserialize)), true);
@@ -0,0 +1,118 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "../helpers/array.h"
+
+/**
+ * A deserialized chunk held by a ChunkCache, along with the bookkeeping needed for LRU eviction.
+ */
+class CachedChunk : public Object {
+  public:
+  size_t chunk_index_;
+  Array* chunk_; // owned
+  size_t bytes_;
+  size_t last_used_;
+
+  CachedChunk(size_t chunk_index, Array* chunk, size_t bytes, size_t last_used) {
+    chunk_index_ = chunk_index;
+    chunk_ = chunk;
+    bytes_ = bytes;
+    last_used_ = last_used;
+  }
+
+  ~CachedChunk() { delete chunk_; }
+};
+
+/**
+ * ChunkCache::
+ * Least recently used cache of the chunks of a single Column, bounded by a byte budget. The size
+ * of a chunk is taken to be its serial length. A chunk bigger than the whole budget is still
+ * cached, but on its own.
+ * Authors: Kaylin Devchand & Cristian Stransky
+ */
+class ChunkCache : public Object {
+  public:
+  Array entries_; // CachedChunk*, owned
+  size_t budget_;
+  size_t bytes_used_;
+  size_t tick_;
+  size_t hits_;
+  size_t misses_;
+  size_t evictions_;
+
+  ChunkCache(size_t budget) : entries_('O', 4) {
+    budget_ = budget;
+    bytes_used_ = 0;
+    tick_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+  }
+
+  CachedChunk* get_entry_(size_t ii) { return static_cast<CachedChunk*>(entries_.get(ii).o); }
+
+  /** Returns the cached chunk, or nullptr on a miss. The chunk is still owned by the cache. */
+  Array* get(size_t chunk_index) {
+    tick_++;
+    for (size_t ii = 0; ii < entries_.length(); ii++) {
+      CachedChunk* entry = get_entry_(ii);
+      if (entry->chunk_index_ == chunk_index) {
+        entry->last_used_ = tick_;
+        hits_++;
+        return entry->chunk_;
+      }
+    }
+    misses_++;
+    return nullptr;
+  }
+
+  /** Checks for a chunk without counting a hit or a miss nor touching its recency. */
+  bool contains(size_t chunk_index) {
+    for (size_t ii = 0; ii < entries_.length(); ii++)
+      if (get_entry_(ii)->chunk_index_ == chunk_index) return true;
+    return false;
+  }
+
+  void evict_lru_() {
+    size_t lru = 0;
+    for (size_t ii = 1; ii < entries_.length(); ii++)
+      if (get_entry_(ii)->last_used_ < get_entry_(lru)->last_used_) lru = ii;
+    CachedChunk* entry = static_cast<CachedChunk*>(entries_.remove(lru).o);
+    bytes_used_ -= entry->bytes_;
+    evictions_++;
+    delete entry;
+  }
+
+  /** Takes ownership of the chunk, evicting the least recently used chunks to stay in budget. */
+  void put(size_t chunk_index, Array* chunk) {
+    size_t bytes = chunk->serial_len();
+    while (entries_.length() > 0 && bytes_used_ + bytes > budget_)
+      evict_lru_();
+    entries_.push(object_to_payload(new CachedChunk(chunk_index, chunk, bytes, ++tick_)));
+    bytes_used_ += bytes;
+  }
+
+  /** Changes the budget, evicting chunks right away if the cache is now over it. */
+  void set_budget(size_t budget) {
+    budget_ = budget;
+    while (entries_.length() > 0 && bytes_used_ > budget_)
+      evict_lru_();
+  }
+
+  void clear() {
+    entries_.clear();
+    bytes_used_ = 0;
+  }
+
+  size_t get_budget() { return budget_; }
+
+  size_t bytes_used() { return bytes_used_; }
+
+  size_t num_chunks() { return entries_.length(); }
+
+  size_t hits() { return hits_; }
+
+  size_t misses() { return misses_; }
+
+  size_t evictions() { return evictions_; }
+};
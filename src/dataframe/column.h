@@ -2,22 +2,43 @@
 
 #include "../helpers/array.h"
 #include "../kv_store/kv_store.h"
+#include "chunk_cache.h"
+#include "read_ahead.h"
+#include "kernels.h"
+#include "zone_map.h"
 #include "../kv_store/key_array.h"
 
-// Number of elements each array in the array of arrays in Column have
-// TODO: Now we know a 10GB is our average file size, we should mess with ELEMENT_ARRAY_SIZE until
-// we get a number that's optimal. Jan does say 100 is too small though.
+// Number of rows of the blocks rows are handled in when no chunk size applies, e.g. the blocks of
+// a spilled sort run
 #ifdef TEST
 const int ELEMENT_ARRAY_SIZE = 100; 
 #else
 const int ELEMENT_ARRAY_SIZE = 10000; 
 #endif
 
+// Chunks built by a DataFrameBuilder hold about DEFAULT_CHUNK_BYTES, and at most MAX_CHUNK_ROWS
+// rows, whatever the types of their columns. See chunk_rows_for.
+#ifdef TEST
+const size_t DEFAULT_CHUNK_BYTES = 64 * 1024;
+const size_t MAX_CHUNK_ROWS = ELEMENT_ARRAY_SIZE;
+#else
+const size_t DEFAULT_CHUNK_BYTES = 2 * 1024 * 1024;
+const size_t MAX_CHUNK_ROWS = 1024 * 1024;
+#endif
+// Bytes a string is assumed to take before any is seen, its characters and the String holding them
+const size_t STRING_BYTES_ESTIMATE = 32;
+
 const int DEFAULT_INT_VALUE = 0;
 const double DEFAULT_DOUBLE_VALUE = 0;
 const bool DEFAULT_BOOL_VALUE = 0;
 String DEFAULT_STRING_VALUE("");
 const int NUM_THREADS = 4;
+// Default byte budgets of the chunk caches of every Column, in whole default chunks so a chunk
+// always fits. Remote chunks cost a round trip to fetch again, so they get more room than local
+// chunks, which only need to be deserialized: the chunk being read, the one before it and those
+// read ahead of it.
+const size_t DEFAULT_LOCAL_CACHE_BYTES = 2 * DEFAULT_CHUNK_BYTES;
+const size_t DEFAULT_REMOTE_CACHE_BYTES = (DEFAULT_READ_AHEAD + 2) * DEFAULT_CHUNK_BYTES;
 
 class KD_Store;
 class ColumnArray;
@@ -35,27 +56,52 @@ class Column : public Object {
 
   char type_;
   size_t size_;
+  size_t chunk_size_; // rows of every chunk but the last, which has at most as many, 0 if uneven
   KV_Store* kv_; // not owned by Column, simply used for kv methods
   KeyArray* keys_; // owned
-  Array* cache_;
+  IntArray* starts_; // owned, index of the first element of every chunk
+  ZoneMaps* zones_; // owned, statistics of every chunk
+  ChunkCache* local_cache_; // owned, chunks homed on this node
+  ChunkCache* remote_cache_; // owned, chunks homed on other nodes
+  Array* cache_; // not owned, the chunk of the last access, lives in one of the caches
   size_t cache_index_;
+  ReadAhead* read_ahead_; // owned
 
-  Column(char type, KV_Store* kv, size_t size, KeyArray* keys) {
+  Column(char type, KV_Store* kv, size_t size, KeyArray* keys, IntArray* starts,
+      ZoneMaps* zones) {
     type_ = type;
     size_ = size;
+    chunk_size_ = 0;
     kv_ = kv;
     keys_ = keys ? keys->clone() : nullptr;
+    starts_ = starts ? starts->clone() : nullptr;
+    zones_ = zones ? zones->clone() : nullptr;
+    build_caches_();
+  }
+
+  void build_caches_() {
+    local_cache_ = new ChunkCache(DEFAULT_LOCAL_CACHE_BYTES);
+    remote_cache_ = new ChunkCache(DEFAULT_REMOTE_CACHE_BYTES);
     cache_ = nullptr;
     cache_index_ = 0;
+    read_ahead_ = new ReadAhead(DEFAULT_READ_AHEAD);
   }
 
-  Column(char type, KV_Store* kv) : Column(type, kv, 0, nullptr) { 
+  Column(char type, KV_Store* kv) : Column(type, kv, 0, nullptr, nullptr, nullptr) { 
       keys_ = new KeyArray(1);  
+      starts_ = new IntArray(1);
+      zones_ = new ZoneMaps();
   }
 
-  Column(Column& other) : Column(other.type_, other.kv_, other.size_, other.keys_) { }
+  Column(Column& other) 
+    : Column(other.type_, other.kv_, other.size_, other.keys_, other.starts_, other.zones_) {
+    chunk_size_ = other.chunk_size_;
+  }
   
-  Column(Column& other, KV_Store* kv) : Column(other.type_, kv, other.size_, other.keys_) { }
+  Column(Column& other, KV_Store* kv) 
+    : Column(other.type_, kv, other.size_, other.keys_, other.starts_, other.zones_) {
+    chunk_size_ = other.chunk_size_;
+  }
 
   Column(char type) : Column(type, nullptr) {  }
 
@@ -63,14 +109,21 @@ class Column : public Object {
     kv_ = kv_store;
     type_ = deserializer.deserialize_char();
     size_ = deserializer.deserialize_size_t(); 
+    chunk_size_ = deserializer.deserialize_size_t();
     keys_ = new KeyArray(deserializer);
-    cache_ = nullptr;
-    cache_index_ = 0;
+    starts_ = new IntArray(deserializer);
+    zones_ = new ZoneMaps(deserializer);
+    build_caches_();
   }
 
   ~Column() {
+    // Joins any fetch still in flight
+    delete read_ahead_;
     delete keys_;
-    delete cache_;
+    delete starts_;
+    delete zones_;
+    delete local_cache_;
+    delete remote_cache_;
   }
 
   Column* clone() { return new Column(*this); }
@@ -78,45 +131,220 @@ class Column : public Object {
   /** Type appropriate push_back methods. Calling the wrong method is
     * undefined behavior. **/
   void push_back(Array* val, Key* key) {
-    keys_->push(key);
     kv_->put(key, val); 
-    size_ += val->length();
+    push_back_key(key, val->length(), ZoneMap::of(val, type_));
   }
 
-  Payload get_element_(size_t idx) {
+  /** Appends a chunk already stored under the key, e.g. by another node, with its statistics. */
+  void push_back_key(Key* key, size_t length, ZoneMap zone) {
+    if (num_chunks() == 0) chunk_size_ = length;
+    else if (chunk_length(num_chunks() - 1) != chunk_size_ || length > chunk_size_) chunk_size_ = 0;
+    keys_->push(key);
+    starts_->push(size_);
+    zones_->push(zone);
+    size_ += length;
+  }
+
+  /** Appends a chunk nothing is known about, no predicate skips it. */
+  void push_back_key(Key* key, size_t length) {
+    push_back_key(key, length, ZoneMap::unknown(length));
+  }
+
+  /** Appends every chunk of the other column of the same type, without copying their data. */
+  void append_chunks(Column* other) {
+    assert(other->type_ == type_);
+    for (size_t ii = 0; ii < other->num_chunks(); ii++)
+      push_back_key(other->keys_->get(ii), other->chunk_length(ii), other->get_zone(ii));
+  }
+
+  /** Statistics of the chunk_index-th chunk. */
+  ZoneMap get_zone(size_t chunk_index) { return zones_->get(chunk_index); }
+
+  /** Returns the chunk at chunk_index, fetching it from the KV_Store if it is not cached. The chunk
+    * stays owned by the Column and may be evicted by a later access. */
+  Array* get_chunk(size_t chunk_index) {
+    assert(chunk_index < keys_->length());
+    if (cache_ != nullptr && cache_index_ == chunk_index) return cache_;
+
+    Key* k = keys_->get(chunk_index);
+    bool is_local = is_chunk_local(chunk_index);
+    ChunkCache* cache = is_local ? local_cache_ : remote_cache_;
+    cache_ = cache->get(chunk_index);
+    if (cache_ == nullptr) {
+      cache_ = read_ahead_->take(chunk_index);
+      if (cache_ == nullptr) {
+        if (!is_local) read_ahead_->record_stall();
+        cache_ = kv_->get_array(k, type_);
+      }
+      cache->put(chunk_index, cache_);
+    }
+    cache_index_ = chunk_index;
+    read_ahead_->advance(chunk_index, keys_, kv_, type_, remote_cache_);
+    return cache_;
+  }
+
+  /** Fetches the chunk straight from the KV_Store, bypassing the caches, so it can be called from
+    * several threads at once. The caller owns the returned chunk. */
+  Array* fetch_chunk(size_t chunk_index) {
+    return kv_->get_array(keys_->get(chunk_index), type_);
+  }
+
+  /** Index of the chunk holding the element at idx. Chunks can have any length, e.g. the ones
+    * of a filtered frame, so unless they all have chunk_size_ rows the chunk of the last access is
+    * checked before searching them. */
+  size_t chunk_of_(size_t idx) {
     assert(idx < size_);
-    size_t index = idx % ELEMENT_ARRAY_SIZE;
-    size_t array_index = idx / ELEMENT_ARRAY_SIZE;
-
-    if (cache_ == nullptr || cache_index_ != array_index) {
-      delete cache_;
-      Key* k = keys_->get(array_index);
-      cache_ = kv_->get_array(k, type_);
-      cache_index_ = array_index;
+    if (chunk_size_ > 0) return idx / chunk_size_;
+    if (cache_ != nullptr && idx >= chunk_start(cache_index_) 
+      && idx - chunk_start(cache_index_) < chunk_length(cache_index_)) return cache_index_;
+    size_t lo = 0;
+    size_t hi = num_chunks();
+    while (hi - lo > 1) {
+      size_t mid = (lo + hi) / 2;
+      if (chunk_start(mid) <= idx) lo = mid;
+      else hi = mid;
     }
-    return cache_->get(index);
+    return lo;
+  }
+
+  /** Returns the chunk holding the element at idx, and sets offset to the index of the element
+    * within it. */
+  Array* get_chunk_(size_t idx, size_t& offset) {
+    size_t chunk_index = chunk_of_(idx);
+    offset = idx - chunk_start(chunk_index);
+    return get_chunk(chunk_index);
+  }
+
+  size_t num_chunks() { return keys_->length(); }
+
+  /** Rows of every chunk but the last, 0 if the chunks have uneven lengths. */
+  size_t chunk_size() { return chunk_size_; }
+
+  /** Index of the first element of the chunk. */
+  size_t chunk_start(size_t chunk_index) { return starts_->get(chunk_index); }
+
+  size_t chunk_length(size_t chunk_index) {
+    assert(chunk_index < keys_->length());
+    size_t end = chunk_index + 1 < num_chunks() ? chunk_start(chunk_index + 1) : size_;
+    return end - chunk_start(chunk_index);
+  }
+
+  size_t get_chunk_home_node(size_t chunk_index) { return keys_->get(chunk_index)->get_node_index(); }
+
+  /** Whether this node holds a copy of the chunk, its home node or a replica of it. Those are read
+    * from the local store. */
+  bool is_chunk_local(size_t chunk_index) {
+    return keys_->get(chunk_index)->is_on(kv_->get_node_index(), kv_->get_num_other_nodes());
+  }
+
+  /** Sets the byte budgets of the chunk caches, chunks over budget are evicted right away. */
+  void set_cache_budget(size_t local_bytes, size_t remote_bytes) {
+    local_cache_->set_budget(local_bytes);
+    remote_cache_->set_budget(remote_bytes);
+    cache_ = nullptr;
+  }
+
+  /** Sets how many remote chunks are fetched ahead of a sequential scan, 0 turns it off. */
+  void set_read_ahead(size_t depth) { read_ahead_->set_depth(depth); }
+
+  ReadAhead* get_read_ahead() { return read_ahead_; }
+
+  ChunkCache* get_local_cache() { return local_cache_; }
+
+  ChunkCache* get_remote_cache() { return remote_cache_; }
+
+  Payload get_element_(size_t idx) {
+    size_t offset;
+    Array* chunk = get_chunk_(idx, offset);
+    return chunk->get(offset);
   }
 
   int get_int(size_t idx) {
     assert(type_ == 'I');
-    return get_element_(idx).i;
+    size_t offset;
+    IntArray* chunk = static_cast<IntArray*>(get_chunk_(idx, offset));
+    return chunk->get(offset);
   }
 
   bool get_bool(size_t idx) {
     assert(type_ == 'B');
-    return get_element_(idx).b;
+    size_t offset;
+    BoolArray* chunk = static_cast<BoolArray*>(get_chunk_(idx, offset));
+    return chunk->get(offset);
   }
 
   double get_double(size_t idx) {
     assert(type_ == 'D');
-    return get_element_(idx).d;
+    size_t offset;
+    DoubleArray* chunk = static_cast<DoubleArray*>(get_chunk_(idx, offset));
+    return chunk->get(offset);
   }
 
+  /** The string at idx, owned by its chunk, e.g. a view into the blob of a BlobStringArray. It is
+    * only valid until the chunk is evicted, clone it to keep it longer. */
   String* get_string(size_t idx) {
     assert(type_ == 'S');
-    return static_cast<String*>(get_element_(idx).o);
+    size_t offset;
+    StringArray* chunk = static_cast<StringArray*>(get_chunk_(idx, offset));
+    return chunk->get(offset);
+  }
+
+  bool is_missing(size_t idx) {
+    size_t offset;
+    return get_chunk_(idx, offset)->is_missing(offset);
+  }
+
+  /** Number of missing elements, from the zone maps of the chunks. */
+  size_t num_missing() {
+    size_t count = 0;
+    for (size_t ii = 0; ii < num_chunks(); ii++) count += get_zone(ii).nulls_;
+    return count;
   }
  
+  /** Aggregates the whole column with the SIMD kernels, a chunk at a time on this thread. Remote
+    * chunks are fetched, DataFrame::aggregate runs on their home nodes instead. */
+  double aggregate(Aggregate& aggregate) {
+    for (size_t ii = 0; ii < num_chunks(); ii++) aggregate.add_chunk(get_chunk(ii), type_);
+    return aggregate.result();
+  }
+
+  double aggregate_(AggOp op) {
+    Aggregate aggregate(op);
+    return this->aggregate(aggregate);
+  }
+
+  double sum() { return aggregate_(AggOp::Sum); }
+
+  double min() { return aggregate_(AggOp::Min); }
+
+  double max() { return aggregate_(AggOp::Max); }
+
+  size_t count() { return aggregate_(AggOp::Count); }
+
+  double mean() { return aggregate_(AggOp::Mean); }
+
+  size_t count_if(CmpOp op, double value) {
+    Aggregate aggregate(AggOp::CountIf, op, value);
+    return this->aggregate(aggregate);
+  }
+
+  size_t count_true() {
+    assert(type_ == 'B');
+    size_t count = 0;
+    for (size_t ii = 0; ii < num_chunks(); ii++)
+      count += ::count_true(static_cast<BoolArray*>(get_chunk(ii)));
+    return count;
+  }
+
+  /** Number of strings equal to value, see count_equal_strings. */
+  size_t count_equal(String* value) {
+    assert(type_ == 'S');
+    size_t count = 0;
+    for (size_t ii = 0; ii < num_chunks(); ii++)
+      count += count_equal_strings(static_cast<StringArray*>(get_chunk(ii)), value);
+    return count;
+  }
+
   /** Returns the number of elements in the column. */
   size_t size() {
     return size_;
@@ -128,14 +356,16 @@ class Column : public Object {
   }
 
   size_t get_home_node(size_t idx) {
-    size_t array_index = idx / ELEMENT_ARRAY_SIZE;
-    return keys_->get(array_index)->get_node_index();
+    return keys_->get(chunk_of_(idx))->get_node_index();
   }
 
   size_t serial_len() {
     return sizeof(char) // type_
       + sizeof(size_t) // size_
-      + keys_->serial_len();
+      + sizeof(size_t) // chunk_size_
+      + keys_->serial_len()
+      + starts_->serial_len()
+      + zones_->serial_len();
   }
 
   char* serialize() {
@@ -143,7 +373,10 @@ class Column : public Object {
     Serializer serializer(serial_size);
     serializer.serialize_char(type_);
     serializer.serialize_size_t(size_);
+    serializer.serialize_size_t(chunk_size_);
     serializer.serialize_object(keys_);
+    serializer.serialize_object(starts_);
+    serializer.serialize_object(zones_);
     return serializer.get_serial();
   }
 };
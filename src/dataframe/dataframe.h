@@ -8,6 +8,9 @@
 #include "../helpers/array.h"
 #include "column_array.h"
 #include "rower.h"
+#include "rower_registry.h"
+#include "aggregate_rower.h"
+#include "shipped_rower.h"
 #include "row.h"
 #include "schema.h"
 
@@ -16,6 +19,20 @@
 #include <cstring>
 #include <thread>
 
+// How DataFrame::join moves rows: Broadcast sends the smaller frame to every node holding chunks
+// of the larger one, Partitioned hashes both frames on their keys so matching rows meet on one
+// node, and Auto broadcasts whenever the smaller frame has at most BROADCAST_JOIN_MAX_ROWS rows.
+enum class JoinStrategy { Auto, Broadcast, Partitioned };
+const size_t BROADCAST_JOIN_MAX_ROWS = ELEMENT_ARRAY_SIZE * 100;
+
+// DataFrame::sort keeps at most SORT_MEMORY_ROWS rows in memory per thread before spilling a sorted
+// run to disk, and samples about SORT_SAMPLES_PER_NODE keys per node to split the rows by range.
+const size_t SORT_MEMORY_ROWS = ELEMENT_ARRAY_SIZE * 100;
+const size_t SORT_SAMPLES_PER_NODE = 100;
+
+class GroupAggregates;
+class Splitters;
+
 /****************************************************************************
  * DataFrame::
  *
@@ -37,7 +54,7 @@ class DataFrame : public Object {
     size_t num_cols = schema.width();
     // It's possible to make a schema with 0 columns, so we want to make sure we have atleast an 
     // array size of 1, or else our doubling in size arthimetic won't work correctly
-    size_t col_size = max(num_cols, 1);
+    size_t col_size = ::max(num_cols, 1);
     this->cols_ = new ColumnArray(col_size);
     
     for (size_t ii = 0; ii < num_cols; ii++) {
@@ -104,6 +121,22 @@ class DataFrame : public Object {
   static DataFrame* from_array(Key* key, KD_Store* kd, size_t num, String** array);
   static DataFrame* from_file(Key* key, KD_Store* kd, char* file_name);
   static DataFrame* from_rower(Key* key, KD_Store* kd, const char* schema, Rower& rower);
+  DataFrame* filter(Key* key, KD_Store* kd, Rower& r);
+  DataFrame* filter(Key* key, KD_Store* kd, Rower& r, size_t col, CmpOp op, double value);
+  DataFrame* filter(Key* key, KD_Store* kd, size_t col, String* value);
+  DataFrame* filter_(Key* key, KD_Store* kd, Rower& r, IntArray* chunks);
+  static DataFrame* join(DataFrame* left, DataFrame* right, size_t left_col, size_t right_col,
+    Key* out_key, KD_Store* kd, JoinStrategy strategy = JoinStrategy::Auto);
+  DataFrame* partition_(String* name, size_t col, size_t num_parts,
+    Splitters* splitters = nullptr);
+  DataFrame* group_by(Key* out_key, KD_Store* kd, IntArray& key_cols, 
+    GroupAggregates& aggregates);
+  DataFrame* sort(Key* out_key, KD_Store* kd, IntArray& by_cols, bool ascending,
+    size_t max_rows_in_memory = SORT_MEMORY_ROWS);
+  DataFrame* bool_op_(Key* key, KD_Store* kd, size_t a, BoolOp op, size_t b);
+  DataFrame* bools_and(Key* key, KD_Store* kd, size_t a, size_t b);
+  DataFrame* bools_or(Key* key, KD_Store* kd, size_t a, size_t b);
+  DataFrame* bools_not(Key* key, KD_Store* kd, size_t col);
  
   /** Returns the dataframe's schema. Modifying the schema after a dataframe
     * has been created in undefined. */
@@ -112,6 +145,24 @@ class DataFrame : public Object {
   /** Gets a specific Column inside of the DataFrame. */
   Column* get_column(size_t col) { return this->cols_->get(col); }
  
+  /** Sets the byte budgets of the local and remote chunk caches of every column. */
+  void set_cache_budget(size_t local_bytes, size_t remote_bytes) {
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      cols_->get(ii)->set_cache_budget(local_bytes, remote_bytes);
+  }
+
+  /** Sets how many remote chunks each column fetches ahead of a sequential scan. */
+  void set_read_ahead(size_t depth) {
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      cols_->get(ii)->set_read_ahead(depth);
+  }
+
+  /** Read-ahead stats are per scan, map and local_map start a new one. */
+  void reset_read_ahead_stats_() {
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      cols_->get(ii)->get_read_ahead()->reset_stats();
+  }
+
   /** Return the value at the given column and row. Accessing rows or
    *  columns out of bounds, or request the wrong type is undefined.*/
   int get_int(size_t col, size_t row) { return this->cols_->get(col)->get_int(row); }
@@ -124,9 +175,16 @@ class DataFrame : public Object {
   // cache String pointer, so String address CAN change later), clone if needed longer
   String* get_string(size_t col, size_t row) { return cols_->get(col)->get_string(row); }
 
+  /** Whether the field is missing, the getters then return the default of its type, or nullptr
+    * for a string. */
+  bool is_missing(size_t col, size_t row) { return cols_->get(col)->is_missing(row); }
+
+  /** Number of missing fields of the column, known without reading its chunks. */
+  size_t num_missing(size_t col) { return cols_->get(col)->num_missing(); }
+
   /** Set the fields of the given row object with values from the columns at
     * the given offset.  If the row is not form the same schema as the
-    * dataframe, results are undefined.
+    * dataframe, results are undefined. Only the columns the row is projected on are read.
     */
   void fill_row(size_t idx, Row& row) {
     assert(idx < this->schema_.length());
@@ -136,6 +194,11 @@ class DataFrame : public Object {
       char row_type = row.col_type(ii);
       char schema_type = this->schema_.col_type(ii);
       assert(row_type == schema_type);
+      if (!row.is_projected(ii)) continue;
+      if (is_missing(ii, idx)) {
+        row.set_missing(ii);
+        continue;
+      }
       switch (row_type) {
         case 'I': row.set(ii, get_int(ii, idx)); break;
         case 'D': row.set(ii, get_double(ii, idx)); break;
@@ -149,10 +212,18 @@ class DataFrame : public Object {
  
   size_t ncols() { return this->schema_.width(); }
  
-  /** Visit rows in order */
-  void map(Rower& r) {
+  /** Visit rows in order. The rows borrow the strings of the chunks, which only live until the
+    * next row, clone them to keep them longer. */
+  void map(Rower& r) { map_(r, nullptr); }
+
+  /** Visit rows in order, only reading the given columns. The rower may not read any other. */
+  void map(Rower& r, IntArray& cols) { map_(r, &cols); }
+
+  void map_(Rower& r, IntArray* cols) {
+    reset_read_ahead_stats_();
     size_t num_rows = this->schema_.length();
-    Row* row = new Row(this->schema_);
+    Row* row = new Row(this->schema_, true);
+    if (cols != nullptr) row->project(*cols);
     for (size_t ii = 0; ii < num_rows; ii++) {
       this->fill_row(ii, *row);
       r.accept(*row);
@@ -160,14 +231,492 @@ class DataFrame : public Object {
     delete row;
   }
 
-  void local_map(Rower& r) {
-    size_t num_rows = this->schema_.length();
-    Row* row = new Row(this->schema_);
-    for (size_t ii = 0; ii < num_rows; ii++) {
-      if (kv_->get_node_index() != cols_->get(0)->get_home_node(ii)) continue;
-      this->fill_row(ii, *row);
-      r.accept(*row);
+  /** Visit the rows homed on this node in order, only going through the local chunks. */
+  void local_map(Rower& r) { local_map_(r, nullptr); }
+
+  void local_map(Rower& r, IntArray& cols) { local_map_(r, &cols); }
+
+  void local_map_(Rower& r, IntArray* cols) {
+    reset_read_ahead_stats_();
+    IntArray* chunk_indexes = local_chunks();
+    for (size_t ii = 0; ii < chunk_indexes->length(); ii++)
+      map_chunk_(chunk_indexes->get(ii), r, cols);
+    delete chunk_indexes;
+  }
+
+  /** Visit the rows of the chunk_index-th chunk in order. */
+  void map_chunk(size_t chunk_index, Rower& r) { map_chunk_(chunk_index, r, nullptr); }
+
+  void map_chunk_(size_t chunk_index, Rower& r, IntArray* cols) {
+    if (ncols() == 0) return;
+    Array** chunks = new Array*[ncols()];
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      chunks[ii] = is_projected_(cols, ii) ? cols_->get(ii)->get_chunk(chunk_index) : nullptr;
+    Row row(this->schema_, true);
+    if (cols != nullptr) row.project(*cols);
+    for (size_t ii = 0; ii < chunk_length(chunk_index); ii++) {
+      fill_row_from_chunks_(chunks, ii, row);
+      r.accept(row);
     }
-    delete row;
+    delete[] chunks;
+  }
+
+  size_t num_chunks() { return ncols() == 0 ? 0 : cols_->get(0)->num_chunks(); }
+
+  /** Index of the first row of the chunk_index-th chunk. */
+  size_t chunk_start(size_t chunk_index) { return cols_->get(0)->chunk_start(chunk_index); }
+
+  /** Number of rows in the chunk_index-th chunk. */
+  size_t chunk_length(size_t chunk_index) { return cols_->get(0)->chunk_length(chunk_index); }
+
+  size_t chunk_home_node(size_t chunk_index) {
+    return cols_->get(0)->get_chunk_home_node(chunk_index);
+  }
+
+  /** Appends the rows of another frame with the same schema by referencing its chunks, which stay
+    * on the nodes they are homed on. */
+  void append_chunks(DataFrame& other) {
+    assert(schema_.types_->equals(other.get_schema().types_));
+    for (size_t ii = 0; ii < ncols(); ii++)
+      cols_->get(ii)->append_chunks(other.get_column(ii));
+    schema_.add_rows(other.nrows());
+  }
+
+  /** Indexes of the chunks homed on this node in increasing order, owned by the caller. Chunk ii
+    * covers rows [chunk_start(ii), chunk_start(ii) + chunk_length(ii)) of every column. */
+  IntArray* local_chunks() { return chunks_homed_on(kv_->get_node_index()); }
+
+  /** Indexes of the chunks homed on the given node in increasing order, owned by the caller. */
+  IntArray* chunks_homed_on(size_t node_index) {
+    IntArray* chunks = new IntArray(::max(num_chunks(), 1));
+    for (size_t ii = 0; ii < num_chunks(); ii++)
+      if (chunk_home_node(ii) == node_index) chunks->push(ii);
+    return chunks;
+  }
+
+  /** Whether column col is part of the projection, nullptr projecting every column. */
+  bool is_projected_(IntArray* cols, size_t col) {
+    return cols == nullptr || cols->index_of(col) != -1;
+  }
+
+  /** Points the batch at the chunk_index-th chunk of every projected column. */
+  void fill_batch_(size_t chunk_index, RowBatch& batch, IntArray* cols) {
+    for (size_t ii = 0; ii < cols_->length(); ii++) {
+      Array* chunk = is_projected_(cols, ii) ? cols_->get(ii)->get_chunk(chunk_index) : nullptr;
+      batch.set_chunk(ii, chunk);
+    }
+    Column* first = cols_->get(0);
+    batch.set_range(first->chunk_start(chunk_index), first->chunk_length(chunk_index));
+  }
+
+  /** Visit the rows in order, one chunk at a time. */
+  void map(BatchRower& r) { map_(r, nullptr); }
+
+  /** Visit the rows in order, one chunk of the given columns at a time. The batches hold no other
+    * column. */
+  void map(BatchRower& r, IntArray& cols) { map_(r, &cols); }
+
+  void map_(BatchRower& r, IntArray* cols) {
+    reset_read_ahead_stats_();
+    if (ncols() == 0) return;
+    RowBatch batch(this->schema_);
+    for (size_t ii = 0; ii < cols_->get(0)->num_chunks(); ii++) {
+      fill_batch_(ii, batch, cols);
+      r.accept(batch);
+    }
+  }
+
+  /** Visit the chunks homed on this node, in order. */
+  void local_map(BatchRower& r) { local_map_(r, nullptr); }
+
+  void local_map(BatchRower& r, IntArray& cols) { local_map_(r, &cols); }
+
+  void local_map_(BatchRower& r, IntArray* cols) {
+    reset_read_ahead_stats_();
+    if (ncols() == 0) return;
+    RowBatch batch(this->schema_);
+    IntArray* chunk_indexes = local_chunks();
+    for (size_t ii = 0; ii < chunk_indexes->length(); ii++) {
+      fill_batch_(chunk_indexes->get(ii), batch, cols);
+      r.accept(batch);
+    }
+    delete chunk_indexes;
+  }
+
+  /** Indexes of all the chunks of the frame. */
+  IntArray* all_chunks_() {
+    IntArray* chunks = new IntArray(::max(num_chunks(), 1));
+    for (size_t ii = 0; ii < num_chunks(); ii++) chunks->push(ii);
+    return chunks;
+  }
+
+  /** Fetches the chunk_index-th chunk of every projected column for a pmap thread, which then
+    * owns them. The chunks of the other columns are nullptr. */
+  void fetch_chunks_(size_t chunk_index, Array** chunks, IntArray* cols) {
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      chunks[ii] = is_projected_(cols, ii) ? cols_->get(ii)->fetch_chunk(chunk_index) : nullptr;
+  }
+
+  void delete_chunks_(Array** chunks) {
+    for (size_t ii = 0; ii < cols_->length(); ii++) delete chunks[ii];
+  }
+
+  /** Sets the fields of the row with element idx of every chunk, skipping missing chunks. */
+  void fill_row_from_chunks_(Array** chunks, size_t idx, Row& row) {
+    for (size_t ii = 0; ii < cols_->length(); ii++)
+      if (chunks[ii] != nullptr) row.set_from_chunk(ii, chunks[ii], idx);
+  }
+
+  /** Body of a pmap thread, visits the rows of chunks [from, to) of the list in order. */
+  void map_chunks_(Rower* r, IntArray* chunk_indexes, size_t from, size_t to, IntArray* cols) {
+    Array** chunks = new Array*[::max(ncols(), 1)];
+    Row row(this->schema_, true);
+    if (cols != nullptr) row.project(*cols);
+    Column* first = cols_->get(0);
+    for (size_t ii = from; ii < to; ii++) {
+      size_t chunk_index = chunk_indexes->get(ii);
+      fetch_chunks_(chunk_index, chunks, cols);
+      for (size_t jj = 0; jj < first->chunk_length(chunk_index); jj++) {
+        fill_row_from_chunks_(chunks, jj, row);
+        r->accept(row);
+      }
+      delete_chunks_(chunks);
+    }
+    delete[] chunks;
+  }
+
+  /** Body of a pmap thread, visits chunks [from, to) of the list in order. */
+  void map_batches_(BatchRower* r, IntArray* chunk_indexes, size_t from, size_t to,
+      IntArray* cols) {
+    Array** chunks = new Array*[::max(ncols(), 1)];
+    RowBatch batch(this->schema_);
+    Column* first = cols_->get(0);
+    for (size_t ii = from; ii < to; ii++) {
+      size_t chunk_index = chunk_indexes->get(ii);
+      fetch_chunks_(chunk_index, chunks, cols);
+      for (size_t jj = 0; jj < cols_->length(); jj++) batch.set_chunk(jj, chunks[jj]);
+      batch.set_range(first->chunk_start(chunk_index), first->chunk_length(chunk_index));
+      r->accept(batch);
+      delete_chunks_(chunks);
+    }
+    delete[] chunks;
+  }
+
+  /** Number of threads for a pmap over num_chunks chunks, at least one. */
+  size_t pmap_threads_(size_t num_threads, size_t num_chunks) {
+    return ::max(::min(num_threads, num_chunks), 1);
+  }
+
+  /** Splits the chunks into contiguous runs, one per thread. Thread 0 runs the given rower and
+    * every other thread a clone of it. The clones are joined into r in thread order, so the
+    * result does not depend on scheduling. Only the columns in cols are read, all of them when
+    * it is nullptr. */
+  void pmap_(Rower& r, IntArray* chunk_indexes, size_t num_threads, IntArray* cols) {
+    if (ncols() == 0) return;
+    size_t num_chunks = chunk_indexes->length();
+    size_t threads_count = pmap_threads_(num_threads, num_chunks);
+    Rower** rowers = new Rower*[threads_count];
+    std::thread* threads = new std::thread[threads_count];
+    for (size_t ii = 0; ii < threads_count; ii++) {
+      rowers[ii] = ii == 0 ? &r : r.clone();
+      threads[ii] = std::thread(&DataFrame::map_chunks_, this, rowers[ii], chunk_indexes, 
+        num_chunks * ii / threads_count, num_chunks * (ii + 1) / threads_count, cols);
+    }
+    for (size_t ii = 0; ii < threads_count; ii++) threads[ii].join();
+    for (size_t ii = 1; ii < threads_count; ii++) r.join_delete(rowers[ii]);
+    delete[] threads;
+    delete[] rowers;
+  }
+
+  void pmap_(BatchRower& r, IntArray* chunk_indexes, size_t num_threads, IntArray* cols) {
+    if (ncols() == 0) return;
+    size_t num_chunks = chunk_indexes->length();
+    size_t threads_count = pmap_threads_(num_threads, num_chunks);
+    BatchRower** rowers = new BatchRower*[threads_count];
+    std::thread* threads = new std::thread[threads_count];
+    for (size_t ii = 0; ii < threads_count; ii++) {
+      rowers[ii] = ii == 0 ? &r : r.clone();
+      threads[ii] = std::thread(&DataFrame::map_batches_, this, rowers[ii], chunk_indexes, 
+        num_chunks * ii / threads_count, num_chunks * (ii + 1) / threads_count, cols);
+    }
+    for (size_t ii = 0; ii < threads_count; ii++) threads[ii].join();
+    for (size_t ii = 1; ii < threads_count; ii++) r.join_delete(rowers[ii]);
+    delete[] threads;
+    delete[] rowers;
+  }
+
+  /** Visit all the rows on num_threads threads, see pmap_ for how the rower is split. */
+  void pmap(Rower& r, size_t num_threads) { pmap_all_(r, num_threads, nullptr); }
+
+  void pmap(Rower& r) { pmap(r, NUM_THREADS); }
+
+  /** Same as pmap(Rower&, size_t), only reading the given columns. */
+  void pmap(Rower& r, IntArray& cols, size_t num_threads) { pmap_all_(r, num_threads, &cols); }
+
+  void pmap(Rower& r, IntArray& cols) { pmap(r, cols, NUM_THREADS); }
+
+  void pmap(BatchRower& r, size_t num_threads) { pmap_all_(r, num_threads, nullptr); }
+
+  void pmap(BatchRower& r) { pmap(r, NUM_THREADS); }
+
+  void pmap(BatchRower& r, IntArray& cols, size_t num_threads) {
+    pmap_all_(r, num_threads, &cols);
+  }
+
+  void pmap(BatchRower& r, IntArray& cols) { pmap(r, cols, NUM_THREADS); }
+
+  template <class R>
+  void pmap_all_(R& r, size_t num_threads, IntArray* cols) {
+    IntArray* chunk_indexes = all_chunks_();
+    pmap_(r, chunk_indexes, num_threads, cols);
+    delete chunk_indexes;
+  }
+
+  /** Visit the rows homed on this node on num_threads threads. */
+  void local_pmap(Rower& r, size_t num_threads) { local_pmap_(r, num_threads, nullptr); }
+
+  void local_pmap(Rower& r) { local_pmap(r, NUM_THREADS); }
+
+  void local_pmap(Rower& r, IntArray& cols, size_t num_threads) {
+    local_pmap_(r, num_threads, &cols);
+  }
+
+  void local_pmap(Rower& r, IntArray& cols) { local_pmap(r, cols, NUM_THREADS); }
+
+  void local_pmap(BatchRower& r, size_t num_threads) { local_pmap_(r, num_threads, nullptr); }
+
+  void local_pmap(BatchRower& r) { local_pmap(r, NUM_THREADS); }
+
+  void local_pmap(BatchRower& r, IntArray& cols, size_t num_threads) {
+    local_pmap_(r, num_threads, &cols);
+  }
+
+  void local_pmap(BatchRower& r, IntArray& cols) { local_pmap(r, cols, NUM_THREADS); }
+
+  template <class R>
+  void local_pmap_(R& r, size_t num_threads, IntArray* cols) {
+    IntArray* chunk_indexes = local_chunks();
+    pmap_(r, chunk_indexes, num_threads, cols);
+    delete chunk_indexes;
+  }
+
+  /** The node a shipped map visits the chunk on: this one if it holds a copy of it, replicas
+    * included, its home node otherwise. */
+  size_t visiting_node_(size_t chunk_index) {
+    if (cols_->get(0)->is_chunk_local(chunk_index)) return kv_->get_node_index();
+    return chunk_home_node(chunk_index);
+  }
+
+  /** The other nodes visiting some of the chunks, see visiting_node_, owned by the caller. */
+  IntArray* ship_nodes_(IntArray* chunks) {
+    IntArray* nodes = new IntArray(1);
+    for (size_t ii = 0; ii < chunks->length(); ii++) {
+      size_t node = visiting_node_(chunks->get(ii));
+      if (node != kv_->get_node_index() && nodes->index_of(node) == -1) nodes->push(node);
+    }
+    return nodes;
+  }
+
+  /** Ships a fresh clone of the registered rower to every other node visiting some of the chunks,
+    * which then runs it over those. The caller takes the rowers coming back from the returned
+    * ShippedRowers. */
+  Array* ship_(const char* name, Object* fresh, IntArray* chunks) {
+    IntArray* nodes = ship_nodes_(chunks);
+    Array* shipped = new Array('O', ::max(nodes->length(), 1));
+    if (nodes->length() == 0) {
+      delete nodes;
+      return shipped;
+    }
+
+    String rower_name(name);
+    Serializer rower(fresh->serial_len());
+    rower.serialize_object(fresh);
+    Serializer df(serial_len());
+    df.serialize_object(this);
+    for (size_t ii = 0; ii < nodes->length(); ii++) {
+      shipped->push(object_to_payload(new ShippedRower(kv_, nodes->get(ii),
+        visited_on_(chunks, nodes->get(ii)), &rower_name, &rower, &df)));
+    }
+    delete nodes;
+    return shipped;
+  }
+
+  /** The chunks of the list the given node visits, see visiting_node_, owned by the caller. */
+  IntArray* visited_on_(IntArray* chunks, size_t node_index) {
+    IntArray* visited = new IntArray(::max(chunks->length(), 1));
+    for (size_t ii = 0; ii < chunks->length(); ii++)
+      if (visiting_node_(chunks->get(ii)) == node_index) visited->push(chunks->get(ii));
+    return visited;
+  }
+
+  /** Runs the rower on the home node of every chunk, or on this node when it holds a replica of
+    * it, so that only rowers travel over the network instead of chunks. The rower has to be
+    * registered in the rower_registry() and clonable: every other node runs a clone of it over the
+    * chunks it holds while this node visits the local ones, each node with pmap, and the clones
+    * sent back are then joined into r in node order. Rows are not visited in order, which suits
+    * aggregations such as counting words. */
+  void ship_map(Rower& r) {
+    IntArray* chunks = all_chunks_();
+    ship_map_(r, chunks);
+    delete chunks;
+  }
+
+  /** Same as ship_map(Rower&), for a rower visiting the rows a batch at a time. */
+  void ship_map(BatchRower& r) {
+    IntArray* chunks = all_chunks_();
+    ship_map_(r, chunks);
+    delete chunks;
+  }
+
+  /** Ships the rower over the given chunks only, in increasing order. */
+  void ship_map_(Rower& r, IntArray* chunks) {
+    if (ncols() == 0) return;
+    RowerFactory factory = rower_registry().get(r.registered_name());
+    assert(factory);
+    Rower* fresh = r.clone();
+    Array* shipped = ship_(r.registered_name(), fresh, chunks);
+    delete fresh;
+    IntArray* local = visited_on_(chunks, kv_->get_node_index());
+    pmap_(r, local, NUM_THREADS, nullptr);
+    delete local;
+    join_shipped_(r, factory, shipped);
+  }
+
+  void ship_map_(BatchRower& r, IntArray* chunks) {
+    if (ncols() == 0) return;
+    BatchRowerFactory factory = rower_registry().get_batch(r.registered_name());
+    assert(factory);
+    BatchRower* fresh = r.clone();
+    Array* shipped = ship_(r.registered_name(), fresh, chunks);
+    delete fresh;
+    IntArray* local = visited_on_(chunks, kv_->get_node_index());
+    pmap_(r, local, NUM_THREADS, nullptr);
+    delete local;
+    join_shipped_(r, factory, shipped);
+  }
+
+  /** Joins the rowers coming back from the other nodes into r in node order. */
+  template <class R, class F>
+  void join_shipped_(R& r, F factory, Array* shipped) {
+    for (size_t ii = 0; ii < shipped->length(); ii++) {
+      ShippedRower* shipped_rower = static_cast<ShippedRower*>(shipped->get(ii).o);
+      char* result = shipped_rower->take();
+      Deserializer deserializer(result);
+      r.join_delete(factory(deserializer, kv_));
+      delete[] result;
+    }
+    delete shipped;
+  }
+
+  /** Aggregates an I, D or B column over the whole frame, every node aggregating the chunks it
+    * holds with the SIMD kernels. */
+  double aggregate(size_t col, Aggregate& aggregate) {
+    AggregateRower rower(col, aggregate);
+    ship_map(rower);
+    return rower.aggregate_.result();
+  }
+
+  double aggregate_(size_t col, AggOp op) {
+    Aggregate aggregate(op);
+    return this->aggregate(col, aggregate);
+  }
+
+  double sum(size_t col) { return aggregate_(col, AggOp::Sum); }
+
+  double min(size_t col) { return aggregate_(col, AggOp::Min); }
+
+  double max(size_t col) { return aggregate_(col, AggOp::Max); }
+
+  size_t count(size_t col) { return aggregate_(col, AggOp::Count); }
+
+  double mean(size_t col) { return aggregate_(col, AggOp::Mean); }
+
+  /** Number of true elements of a 'B' column, a popcount per word of its chunks. */
+  size_t count_true(size_t col) {
+    assert(schema_.col_type(col) == 'B');
+    return aggregate_(col, AggOp::Sum);
+  }
+
+  /** Number of elements of the column for which element op value holds. The chunks whose zone
+    * map shows that all or none of their elements match are counted without being read. */
+  size_t count_if(size_t col, CmpOp op, double value) {
+    size_t count = 0;
+    IntArray* chunks = new IntArray(::max(num_chunks(), 1));
+    Column* column = cols_->get(col);
+    for (size_t ii = 0; ii < num_chunks(); ii++) {
+      ZoneMap zone = column->get_zone(ii);
+      bool known = zone.count_ + zone.nulls_ == chunk_length(ii);
+      if (known && zone.all_match(op, value)) count += zone.count_;
+      else if (zone.may_match(op, value)) chunks->push(ii);
+    }
+    Aggregate aggregate(AggOp::CountIf, op, value);
+    AggregateRower rower(col, aggregate);
+    ship_map_(rower, chunks);
+    delete chunks;
+    return count + rower.aggregate_.result();
+  }
+
+  /** Statistics of the chunk_index-th chunk of the column, see ZoneMap. */
+  ZoneMap chunk_zone(size_t col, size_t chunk_index) {
+    return cols_->get(col)->get_zone(chunk_index);
+  }
+
+  /** Indexes of the chunks that may hold an element of the column for which element op value
+    * holds, in increasing order and owned by the caller. The others are ruled out by their zone
+    * map without being fetched. */
+  IntArray* chunks_where(size_t col, CmpOp op, double value) {
+    IntArray* chunks = new IntArray(::max(num_chunks(), 1));
+    Column* column = cols_->get(col);
+    for (size_t ii = 0; ii < num_chunks(); ii++)
+      if (column->get_zone(ii).may_match(op, value)) chunks->push(ii);
+    return chunks;
+  }
+
+  /** Visit in order the rows of the chunks that may hold a row for which element op value holds
+    * in the column. The rower still has to test the predicate, only the chunks whose zone map
+    * rules it out are skipped. */
+  void map_where(Rower& r, size_t col, CmpOp op, double value) {
+    reset_read_ahead_stats_();
+    IntArray* chunks = chunks_where(col, op, value);
+    for (size_t ii = 0; ii < chunks->length(); ii++) map_chunk(chunks->get(ii), r);
+    delete chunks;
+  }
+
+  /** Number of strings of an 'S' column equal to value, counted on the home node of every chunk
+    * and on the codes of the dictionary encoded ones. */
+  size_t count_equal(size_t col, String* value) {
+    CountEqualRower rower(col, value);
+    ship_map(rower);
+    return rower.count_;
   }
 };
+
+/** Runs a rower shipped by DataFrame::ship_map over the chunks it was sent for, which are all
+  * homed on this node, and returns the serialized rower to send back. */
+Serializer* run_shipped_rower(KV_Store* kv, ShipRower* message) {
+  char* df_serial = message->get_df()->get_serial();
+  Deserializer df_deserializer(df_serial);
+  DataFrame df(df_deserializer, kv);
+  char* rower_serial = message->get_rower()->get_serial();
+  Deserializer rower_deserializer(rower_serial);
+  const char* name = message->get_rower_name()->c_str();
+  Object* rower;
+  if (RowerFactory factory = rower_registry().get(name)) {
+    Rower* row_rower = factory(rower_deserializer, kv);
+    df.pmap_(*row_rower, message->get_chunks(), NUM_THREADS, nullptr);
+    rower = row_rower;
+  } else {
+    BatchRowerFactory batch_factory = rower_registry().get_batch(name);
+    assert(batch_factory);
+    BatchRower* batch_rower = batch_factory(rower_deserializer, kv);
+    df.pmap_(*batch_rower, message->get_chunks(), NUM_THREADS, nullptr);
+    rower = batch_rower;
+  }
+  Serializer* result = new Serializer(rower->serial_len());
+  result->serialize_object(rower);
+
+  delete rower;
+  delete[] rower_serial;
+  delete[] df_serial;
+  return result;
+}
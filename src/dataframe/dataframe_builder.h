@@ -1,7 +1,91 @@
 // AUTHORS: Kayling Devchand & Cristian Stransky
 #pragma once
 
+#include <thread>
+
 #include "dataframe.h"
+#include "fields.h"
+#include "placement.h"
+
+// Chunks a DataFrameBuilder stores in the background unless changed, 0 stores them on the thread
+// adding the rows
+const size_t DEFAULT_FLUSH_DEPTH = 2;
+// Every remote chunk in flight holds a connection to its home node, as with read-ahead
+const size_t MAX_FLUSH_DEPTH = 4;
+
+/** Rows of a chunk of a frame of the given schema holding about target_bytes, strings counted as
+ *  STRING_BYTES_ESTIMATE bytes and bools as the bit they are packed in. Between 1 and
+ *  MAX_CHUNK_ROWS. */
+size_t chunk_rows_for(Schema& schema, size_t target_bytes) {
+	size_t row_bits = 0;
+	for (size_t ii = 0; ii < schema.width(); ii++) {
+		switch (schema.col_type(ii)) {
+			case 'I': row_bits += sizeof(int) * 8; break;
+			case 'D': row_bits += sizeof(double) * 8; break;
+			case 'B': row_bits += 1; break;
+			case 'S': row_bits += STRING_BYTES_ESTIMATE * 8; break;
+		}
+	}
+	size_t rows = target_bytes * 8 / ::max(row_bits, 1);
+	return ::min(::max(rows, 1), MAX_CHUNK_ROWS);
+}
+
+/** Dictionary encodes a chunk of strings if every string repeats at least twice on average and
+ *  that makes it smaller, and copies it into a blob otherwise, so it is read back without
+ *  allocating every string. The blob is only sized until the dictionary lost to it. */
+StringArray* encode_strings_(StringArray* strings) {
+	DictStringArray* dict = DictStringArray::encode(*strings, strings->length() / 2);
+	if (dict != nullptr && dict->serial_len() < BlobStringArray::serial_len_of(*strings)) return dict;
+	delete dict;
+	return new BlobStringArray(*strings);
+}
+
+/**
+ * The chunks of a range of rows of a frame, one per column, being encoded and stored in the
+ * KV_Store on a background thread while the builder fills the next ones.
+ */
+class PendingFlush : public Object {
+	public:
+	KV_Store* kv_; // not owned
+	Schema schema_;
+	Array** chunks_; // owned
+	Key** keys_; // owned
+	std::thread thread_;
+
+	/** Takes ownership of the chunks and keys, and stores them on this thread unless background. */
+	PendingFlush(KV_Store* kv, Schema& schema, Array** chunks, Key** keys, bool background)
+			: schema_(schema) {
+		kv_ = kv;
+		chunks_ = chunks;
+		keys_ = keys;
+		if (background) thread_ = std::thread(&PendingFlush::store_, this);
+		else store_();
+	}
+
+	/** Waits for the chunks to be stored. */
+	~PendingFlush() {
+		if (thread_.joinable()) thread_.join();
+		delete[] chunks_;
+		delete[] keys_;
+	}
+
+	void store_() {
+		for (size_t ii = 0; ii < schema_.width(); ii++) {
+			Array* chunk = chunks_[ii];
+			StringArray* encoded = nullptr;
+			if (schema_.col_type(ii) == 'S') encoded = encode_strings_(static_cast<StringArray*>(chunk));
+			if (schema_.col_type(ii) == 'I') {
+				IntArray* ints = static_cast<IntArray*>(chunk);
+				IntStats_ stats(ints->ints_, ints->length());
+				ints->set_encoding(stats.cheapest_encoding(), stats);
+			}
+			kv_->put(keys_[ii], encoded ? encoded : chunk);
+			delete encoded;
+			delete chunk;
+			delete keys_[ii];
+		}
+	}
+};
 
 // IMPORTANT: You must retreive and delete the local df_ DataFrame, or else this will not valgrind
 // correctly.
@@ -10,39 +94,181 @@ class DataFrameBuilder {
     String* name_;
     DataFrame* df_; // not owned
     ObjectArray buffers_;
+	size_t* starts_; // owned, first row of every buffer not cut into a chunk yet
+	size_t chunk_rows_; // most rows of a chunk
+	size_t chunk_bytes_; // chunks of strings are cut once they hold that many bytes, 0 if never
+	size_t buffered_bytes_; // of the rows buffered
+	size_t counted_rows_; // rows buffered in every column, which the schema counts already
 	size_t num_nodes_;
 	size_t num_chunks_;
+	Placement* placement_; // owned
+	DataFrameBuilder** parts_; // owned, builder of every node if placing rows, nullptr until used
+	Array flushes_; // PendingFlush*, owned, oldest first
+	size_t flush_depth_;
+	size_t replicas_; // nodes holding a copy of every chunk
 
 	void build_dataframe_builder_(Schema& schema, String* name, KV_Store* kv) {
 		name_ = name->clone();
         df_ = new DataFrame(schema, kv);
+		starts_ = new size_t[::max(schema.width(), 1)];
 		num_nodes_ = kv->get_num_other_nodes();
 		num_chunks_ = 0;
+		placement_ = new RoundRobinPlacement();
+		parts_ = nullptr;
+		replicas_ = 1;
+		buffered_bytes_ = 0;
+		counted_rows_ = 0;
+		set_chunk_bytes(DEFAULT_CHUNK_BYTES);
+		set_flush_depth(DEFAULT_FLUSH_DEPTH);
+	}
 
+	/** Replaces the buffers with empty ones able to hold a chunk without growing. */
+	void new_buffers_() {
+		Schema& schema = df_->get_schema();
+		buffers_.clear();
         for (size_t ii = 0; ii < schema.width(); ii++) {
 			Array* array;
             switch(schema.col_type(ii)) {
-                case 'I': array = new IntArray(); break;
-                case 'D': array = new DoubleArray(); break;
-                case 'B': array = new BoolArray(); break;
-                case 'S': array = new StringArray(); break;
+                case 'I': array = new IntArray(chunk_rows_); break;
+                case 'D': array = new DoubleArray(chunk_rows_); break;
+                case 'B': array = new BoolArray(chunk_rows_); break;
+                case 'S': array = new StringArray(chunk_rows_); break;
             }
 			buffers_.push(array);
 			delete array;
+			starts_[ii] = 0;
         }
 	}
 
-	DataFrameBuilder(const char* types, String* name, KV_Store* kv) : buffers_(strlen(types)) {
+	DataFrameBuilder(const char* types, String* name, KV_Store* kv)
+			: buffers_(strlen(types)), flushes_('O', MAX_FLUSH_DEPTH) {
 		Schema schema(types);
 		build_dataframe_builder_(schema, name, kv);
 
 	}
-    DataFrameBuilder(Schema& schema, String* name, KV_Store* kv) : buffers_(schema.width()) {
+    DataFrameBuilder(Schema& schema, String* name, KV_Store* kv)
+			: buffers_(schema.width()), flushes_('O', MAX_FLUSH_DEPTH) {
 		build_dataframe_builder_(schema, name, kv);
     }
 
 	~DataFrameBuilder() {
+		wait_flushes_(0);
+		delete_parts_();
+		delete placement_;
 		delete name_;
+		delete[] starts_;
+	}
+
+	/** Sizes the chunks to hold about the given number of bytes, see chunk_rows_for. Chunks of
+	 *  strings longer than estimated are cut as soon as their rows take that many bytes, so they
+	 *  have fewer rows. Must be called before any row is added. */
+	void set_chunk_bytes(size_t bytes) {
+		assert(df_->nrows() == 0 && buffered_rows_() == 0 && parts_ == nullptr);
+		chunk_rows_ = chunk_rows_for(df_->get_schema(), bytes);
+		chunk_bytes_ = bytes;
+		new_buffers_();
+	}
+
+	/** Gives every chunk but the last exactly the given number of rows, whatever their bytes, e.g.
+	 *  so the number of chunks of a frame is known ahead. Must be called before any row is added. */
+	void set_chunk_rows(size_t rows) {
+		assert(rows > 0 && df_->nrows() == 0 && buffered_rows_() == 0 && parts_ == nullptr);
+		chunk_rows_ = rows;
+		chunk_bytes_ = 0;
+		new_buffers_();
+	}
+
+	size_t get_chunk_rows() { return chunk_rows_; }
+
+	/** Stores up to depth full chunks in the background while rows are added, so encoding them and
+	 *  sending them to their home nodes overlaps with building the next ones. Adding a row waits
+	 *  for the oldest chunk once depth are in flight, and done() waits for all of them. */
+	void set_flush_depth(size_t depth) { flush_depth_ = min(depth, MAX_FLUSH_DEPTH); }
+
+	size_t get_flush_depth() { return flush_depth_; }
+
+	/** Waits until at most the given number of chunks are still being stored. */
+	void wait_flushes_(size_t most) {
+		while (flushes_.length() > most) delete static_cast<PendingFlush*>(flushes_.remove(0).o);
+	}
+
+	size_t buffered_rows_() { return buffers_.length() > 0 ? buffered_(0) : 0; }
+
+	Array* buffer_(size_t col) { return static_cast<Array*>(buffers_.get(col)); }
+
+	/** Rows of the column buffered and not cut into a chunk yet. */
+	size_t buffered_(size_t col) { return buffer_(col)->length() - starts_[col]; }
+
+	/** Rows every column holds, counting in the schema those it did not count yet. */
+	size_t count_rows_() {
+		size_t rows = buffered_rows_();
+		for (size_t ii = 1; ii < buffers_.length(); ii++) rows = ::min(rows, buffered_(ii));
+		if (rows > counted_rows_) df_->get_schema().add_rows(rows - counted_rows_);
+		counted_rows_ = rows;
+		return rows;
+	}
+
+	/** Homes the chunks built from now on as the placement picks instead of spreading them round
+	 *  robin, see Placement. The placement is cloned. A placement of rows keeps a chunk being
+	 *  built per node, so must be set before any row is added, and rows are then only added
+	 *  whole: columns cannot be appended one at a time. */
+	void set_placement(Placement& placement) {
+		assert(!placement.by_row() || (df_->nrows() == 0 && buffered_rows_() == 0));
+		delete placement_;
+		placement_ = placement.clone();
+	}
+
+	/** Copies every chunk built from now on to the replicas - 1 nodes following its home node too,
+	 *  up to every node, e.g. BROADCAST_REPLICAS for a small frame every node scans. Columns read a
+	 *  chunk from this node if it holds a copy, and spread the fetches of the others over them. */
+	void set_replication(size_t replicas) {
+		assert(replicas > 0 && parts_ == nullptr);
+		replicas_ = ::min(replicas, num_nodes_);
+	}
+
+	size_t get_replication() { return replicas_; }
+
+	/** Homes every chunk built from now on on the given node. */
+	void pin_to_node(size_t node_index) {
+		PinnedPlacement pinned(node_index);
+		set_placement(pinned);
+	}
+
+	/** The builders of the rows of every node, created on the first row with the settings of this
+	 *  one and named after it and this node, so that nodes building the same frame do not write
+	 *  over each other's parts. */
+	DataFrameBuilder** parts_on_() {
+		if (parts_ != nullptr) return parts_;
+		parts_ = new DataFrameBuilder*[num_nodes_];
+		for (size_t ii = 0; ii < num_nodes_; ii++) {
+			String part_name(*name_);
+			part_name.concat("_n");
+			part_name.concat(df_->kv_->get_node_index());
+			part_name.concat("_p");
+			part_name.concat(ii);
+			parts_[ii] = new DataFrameBuilder(df_->get_schema(), &part_name, df_->kv_);
+			if (chunk_bytes_ > 0) parts_[ii]->set_chunk_bytes(chunk_bytes_);
+			else parts_[ii]->set_chunk_rows(chunk_rows_);
+			parts_[ii]->set_flush_depth(flush_depth_);
+			parts_[ii]->set_replication(replicas_);
+			parts_[ii]->pin_to_node(ii);
+		}
+		return parts_;
+	}
+
+	void delete_parts_() {
+		for (size_t ii = 0; ii < num_nodes_ && parts_ != nullptr; ii++) {
+			delete parts_[ii]->df_;
+			delete parts_[ii];
+		}
+		delete[] parts_;
+		parts_ = nullptr;
+	}
+
+	/** Numbers the chunks built from now on from first_chunk, so that nodes writing consecutive
+	 *  ranges of rows of one frame give its chunks the keys a single builder would. */
+	void start_at_chunk(size_t first_chunk) {
+		num_chunks_ = first_chunk;
 	}
 
 	Key* generate_key_(size_t column_index) {
@@ -52,47 +278,223 @@ class DataFrameBuilder {
 		key_name.concat('_');
 		key_name.concat(num_chunks_);
 
-		size_t home_index = num_chunks_ % num_nodes_;
-		Key* new_key = new Key(&key_name, home_index);
+		size_t local_node = df_->kv_->get_node_index();
+		size_t home_index = static_cast<ChunkPlacement*>(placement_)->node_of_chunk(num_chunks_,
+			num_nodes_, local_node);
+		Key* new_key = new Key(&key_name, home_index, replicas_);
 		return new_key;    
   	}
 
-	void add_to_column_() {
-		for (size_t ii = 0; ii < buffers_.length(); ii++) {
-			Array* array = static_cast<Array*>(buffers_.get(ii));
-			if (array->length() > 0) {
-				Key* key = generate_key_(ii);
-				df_->get_column(ii)->push_back(array, key);
-				delete key;
-				array->clear();
+	/** Appends the first rows of every buffer to the columns as the next chunk, and hands them
+	 *  over to be stored, see set_flush_depth. Rows a column was appended past them stay buffered
+	 *  for the chunk after, in the same buffer, which is only replaced once they all were cut. */
+	void add_to_column_(size_t rows) {
+		Schema& schema = df_->get_schema();
+		size_t width = buffers_.length();
+		Array** chunks = new Array*[::max(width, 1)];
+		Key** keys = new Key*[::max(width, 1)];
+		for (size_t ii = 0; ii < width && rows > 0; ii++) {
+			Array* array = buffer_(ii);
+			assert(buffered_(ii) >= rows);
+			char type = schema.col_type(ii);
+			if (starts_[ii] == 0 && array->length() == rows) {
+				chunks[ii] = array;
+			} else {
+				chunks[ii] = new_field_array_(type, rows);
+				push_fields_(chunks[ii], array, type, starts_[ii], starts_[ii] + rows);
+				starts_[ii] += rows;
+			}
+			if (chunks[ii] == array || starts_[ii] == array->length()) {
+				if (chunks[ii] != array) delete array;
+				buffers_.Array::replace(ii, object_to_payload(new_field_array_(type, chunk_rows_)));
+				starts_[ii] = 0;
 			}
+			keys[ii] = generate_key_(ii);
+			df_->get_column(ii)->push_back_key(keys[ii], rows, ZoneMap::of(chunks[ii], type));
 		}
+		if (rows > 0) {
+			wait_flushes_(flush_depth_ > 0 ? flush_depth_ - 1 : 0);
+			PendingFlush* flush = new PendingFlush(df_->kv_, schema, chunks, keys, flush_depth_ > 0);
+			if (flush_depth_ > 0) flushes_.push(object_to_payload(flush));
+			else delete flush;
+		} else {
+			delete[] chunks;
+			delete[] keys;
+		}
+		counted_rows_ -= rows;
+		buffered_bytes_ = 0;
 		num_chunks_++;
 	}
 
+	/** Stores chunks as long as every column holds the rows or the bytes of one. */
+	void cut_chunks_() {
+		size_t rows = count_rows_();
+		while (rows >= chunk_rows_ || (rows > 0 && chunk_bytes_ > 0 && buffered_bytes_ >= chunk_bytes_)) {
+			add_to_column_(::min(rows, chunk_rows_));
+			rows = count_rows_();
+		}
+	}
+
+	/** Rows of the next piece of n values appended to the column: up to the end of the chunk being
+	 *  built, or all of them if the column is ahead of the others and already holds its rows. */
+	size_t piece_(size_t col, size_t n) {
+		size_t length = buffered_(col);
+		return length < chunk_rows_ ? ::min(n, chunk_rows_ - length) : n;
+	}
+
+	/** Bulk appends of n values to a column, a chunk is stored as soon as every column holds its
+	 *  rows. Appending every column in turn a chunk of rows at a time, or appending to a frame of
+	 *  a single column, thus keeps a single chunk buffered. The strings are copied, nullptr being a
+	 *  missing one. Rows may not be added while the columns hold different numbers of rows. */
+	void append_column_range(size_t col, const int* vals, size_t n) {
+		assert(df_->get_schema().col_type(col) == 'I' && !placement_->by_row());
+		for (size_t done = 0; done < n;) {
+			size_t piece = piece_(col, n - done);
+			static_cast<IntArray*>(buffer_(col))->push_range(vals + done, piece);
+			buffered_bytes_ += piece * sizeof(int);
+			done += piece;
+			cut_chunks_();
+		}
+	}
+
+	void append_column_range(size_t col, const double* vals, size_t n) {
+		assert(df_->get_schema().col_type(col) == 'D' && !placement_->by_row());
+		for (size_t done = 0; done < n;) {
+			size_t piece = piece_(col, n - done);
+			static_cast<DoubleArray*>(buffer_(col))->push_range(vals + done, piece);
+			buffered_bytes_ += piece * sizeof(double);
+			done += piece;
+			cut_chunks_();
+		}
+	}
+
+	void append_column_range(size_t col, const bool* vals, size_t n) {
+		assert(df_->get_schema().col_type(col) == 'B' && !placement_->by_row());
+		for (size_t done = 0; done < n;) {
+			size_t piece = piece_(col, n - done);
+			static_cast<BoolArray*>(buffer_(col))->push_range(vals + done, piece);
+			done += piece;
+			cut_chunks_();
+		}
+	}
+
+	// A piece of strings also ends once the chunk being built holds its bytes
+	void append_column_range(size_t col, String** vals, size_t n) {
+		assert(df_->get_schema().col_type(col) == 'S' && !placement_->by_row());
+		for (size_t done = 0; done < n;) {
+			StringArray* strings = static_cast<StringArray*>(buffer_(col));
+			bool ahead = buffered_(col) >= chunk_rows_;
+			size_t end = done + piece_(col, n - done);
+			while (done < end) {
+				strings->push(vals[done]);
+				buffered_bytes_ += sizeof(String) + (vals[done] ? vals[done]->size() : 0);
+				done++;
+				if (!ahead && chunk_bytes_ > 0 && buffered_bytes_ >= chunk_bytes_) break;
+			}
+			cut_chunks_();
+		}
+	}
+
+	/** Appends every row of the batch, e.g. a chunk of a frame of the same schema, a column at a
+	 *  time with the same bulk copies, or a row at a time if rows are placed. */
+	void append_batch(RowBatch& batch) {
+		assert(batch.width() == buffers_.length() && counted_rows_ == buffered_rows_());
+		if (placement_->by_row()) {
+			Row row(df_->get_schema(), true);
+			for (size_t ii = 0; ii < batch.length(); ii++) {
+				batch.fill_row(ii, row);
+				add_row(row);
+			}
+			return;
+		}
+		Schema& schema = df_->get_schema();
+		for (size_t done = 0; done < batch.length();) {
+			size_t piece = piece_(0, batch.length() - done);
+			for (size_t ii = 0; ii < buffers_.length(); ii++) {
+				char type = schema.col_type(ii);
+				Array* chunk = batch.chunks_[ii];
+				assert(chunk != nullptr);
+				push_fields_(buffer_(ii), chunk, type, done, done + piece);
+				switch (type) {
+					case 'I': buffered_bytes_ += piece * sizeof(int); break;
+					case 'D': buffered_bytes_ += piece * sizeof(double); break;
+					case 'S':
+						for (size_t jj = done; jj < done + piece; jj++) {
+							String* str = static_cast<StringArray*>(chunk)->get(jj);
+							buffered_bytes_ += sizeof(String) + (str ? str->size() : 0);
+						}
+						break;
+				}
+			}
+			done += piece;
+			cut_chunks_();
+		}
+	}
+
 	bool is_buffer_full_() {
-		size_t buffer_length = static_cast<Array*>(buffers_.get(0))->length();
-		if (buffer_length > ELEMENT_ARRAY_SIZE)
-			assert(0);
-		return buffer_length == ELEMENT_ARRAY_SIZE;
+		size_t buffer_length = buffered_rows_();
+		assert(buffer_length <= chunk_rows_);
+		return buffer_length == chunk_rows_ || (chunk_bytes_ > 0 && buffered_bytes_ >= chunk_bytes_);
 	}
 	
-	void add_row(Row& row) {
+	/** Adds a copy of the row. */
+	void add_row(Row& row) { add_row_(row, false); }
+
+	/** Adds the row, taking its strings instead of copying them. Its string fields are then missing,
+	 *  so it has to be set again before being added again. Only a row owning its strings can be
+	 *  moved, see Row::take_string. */
+	void move_row(Row& row) { add_row_(row, true); }
+
+	void add_row_(Row& row, bool move) {
+		if (placement_->by_row()) {
+			size_t node = static_cast<RowPlacement*>(placement_)->node_of_row(row, num_nodes_);
+			parts_on_()[node]->add_row_(row, move);
+			return;
+		}
+		assert(counted_rows_ == buffered_rows_());
 		for (size_t ii = 0; ii < buffers_.length(); ii++) {
+			bool missing = row.is_missing(ii);
 			switch(row.col_type(ii)) {
-                case 'I': static_cast<IntArray*>(buffers_.get(ii))->push(row.get_int(ii)); break;
-                case 'D': static_cast<DoubleArray*>(buffers_.get(ii))->push(row.get_double(ii)); break;
+                case 'I':
+					static_cast<IntArray*>(buffers_.get(ii))->push(row.get_int(ii));
+					buffered_bytes_ += sizeof(int);
+					break;
+                case 'D':
+					static_cast<DoubleArray*>(buffers_.get(ii))->push(row.get_double(ii));
+					buffered_bytes_ += sizeof(double);
+					break;
                 case 'B': static_cast<BoolArray*>(buffers_.get(ii))->push(row.get_bool(ii)); break;
-                case 'S': static_cast<StringArray*>(buffers_.get(ii))->push(row.get_string(ii)); break;
+                case 'S': {
+					StringArray* strings = static_cast<StringArray*>(buffers_.get(ii));
+					String* str = move ? row.take_string(ii) : row.get_string(ii);
+					buffered_bytes_ += sizeof(String) + (str ? str->size() : 0);
+					if (move) strings->push_owned(str);
+					else strings->push(str);
+					break;
+				}
             }
+			if (missing) {
+				Array* buffer = static_cast<Array*>(buffers_.get(ii));
+				buffer->set_missing(buffer->length() - 1);
+			}
 		}
-		if (is_buffer_full_()) 
-			add_to_column_();
 		df_->get_schema().add_row();
+		counted_rows_++;
+		if (is_buffer_full_())
+			add_to_column_(counted_rows_);
 	}	
 
+	/** Returns the frame, whose rows are those of every node in node order if rows are placed. */
 	DataFrame* done() {
-		add_to_column_();
+		for (size_t ii = 0; ii < num_nodes_ && parts_ != nullptr; ii++) {
+			DataFrame* part = parts_[ii]->done();
+			df_->append_chunks(*part);
+		}
+		delete_parts_();
+		size_t rows = count_rows_();
+		for (size_t ii = 0; ii < buffers_.length(); ii++) assert(buffered_(ii) == rows);
+		add_to_column_(rows);
+		wait_flushes_(0);
 		return df_;
 	}
 
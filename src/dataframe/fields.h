@@ -0,0 +1,204 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <math.h>
+#include <string.h>
+
+#include "../helpers/array.h"
+#include "row.h"
+#include "schema.h"
+
+/*
+ * Helpers reading and writing single elements of the chunks of a column, given its type, shared by
+ * the operators that move rows between frames.
+ */
+
+/** Whether the idx-th element of a chunk is missing. */
+bool is_null_field_(Array* chunk, size_t idx) { return chunk->is_missing(idx); }
+
+/** Mixes every bit of the hash into the low ones, which pick partitions, and the high ones, which
+  * pick slots of hash tables. */
+uint64_t mix_hash_(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/** Bits a double key hashes on: -0.0 hashes as 0.0 and every NaN the same, as doubles_equal_
+  * holds them equal. */
+uint64_t double_bits_(double val) {
+  if (val == 0) val = 0.0;
+  if (isnan(val)) val = NAN;
+  uint64_t bits;
+  memcpy(&bits, &val, sizeof(double));
+  return bits;
+}
+
+/** Whether two doubles are the same key, == except that NaNs are equal to each other. */
+bool doubles_equal_(double a, double b) { return a == b || (isnan(a) && isnan(b)); }
+
+/** Hash of the idx-th element of a chunk of the given type, the same on every node. Missing
+  * elements all hash the same. */
+uint64_t field_hash_(Array* chunk, char type, size_t idx) {
+  if (chunk->is_missing(idx)) return mix_hash_(UINT64_MAX);
+  uint64_t hash = 0;
+  switch (type) {
+    case 'I': hash = (uint64_t)(int64_t)static_cast<IntArray*>(chunk)->get(idx); break;
+    case 'D': hash = double_bits_(static_cast<DoubleArray*>(chunk)->get(idx)); break;
+    case 'B': hash = static_cast<BoolArray*>(chunk)->get(idx); break;
+    case 'S': hash = static_cast<StringArray*>(chunk)->get(idx)->hash(); break;
+  }
+  return mix_hash_(hash);
+}
+
+/** Hash of a field of the row, the same as field_hash_ of an element equal to it. */
+uint64_t row_field_hash_(Row& row, size_t col) {
+  if (row.is_missing(col)) return mix_hash_(UINT64_MAX);
+  uint64_t hash = 0;
+  switch (row.col_type(col)) {
+    case 'I': hash = (uint64_t)(int64_t)row.get_int(col); break;
+    case 'D': hash = double_bits_(row.get_double(col)); break;
+    case 'B': hash = row.get_bool(col); break;
+    case 'S': hash = row.get_string(col)->hash(); break;
+  }
+  return mix_hash_(hash);
+}
+
+/** Whether the elements of two chunks of the given type are equal, missing elements only being
+  * equal to each other. */
+bool fields_equal_(Array* a, size_t a_idx, Array* b, char type, size_t b_idx) {
+  if (a->is_missing(a_idx) || b->is_missing(b_idx))
+    return a->is_missing(a_idx) && b->is_missing(b_idx);
+  switch (type) {
+    case 'I': return static_cast<IntArray*>(a)->get(a_idx) == static_cast<IntArray*>(b)->get(b_idx);
+    case 'D':
+      return doubles_equal_(static_cast<DoubleArray*>(a)->get(a_idx),
+        static_cast<DoubleArray*>(b)->get(b_idx));
+    case 'B':
+      return static_cast<BoolArray*>(a)->get(a_idx) == static_cast<BoolArray*>(b)->get(b_idx);
+    case 'S': {
+      String* a_val = static_cast<StringArray*>(a)->get(a_idx);
+      return a_val->equals(static_cast<StringArray*>(b)->get(b_idx));
+    }
+  }
+  assert(0);
+}
+
+/** Sets fields [first_col, first_col + schema.width()) of the row with element idx of the chunks
+  * of a frame of the given schema. */
+void set_fields_(Row& row, size_t first_col, Schema& schema, Array** chunks, size_t idx) {
+  for (size_t ii = 0; ii < schema.width(); ii++)
+    row.set_from_chunk(first_col + ii, chunks[ii], idx);
+}
+
+/** Orders the elements of two chunks of the given type: negative if the first comes first,
+  * positive if it comes last and 0 if they are equal. Strings compare byte by byte, and missing
+  * elements come before all others. */
+int compare_fields_(Array* a, size_t a_idx, Array* b, char type, size_t b_idx) {
+  if (a->is_missing(a_idx) || b->is_missing(b_idx))
+    return (int)b->is_missing(b_idx) - (int)a->is_missing(a_idx);
+  switch (type) {
+    case 'I': {
+      int a_val = static_cast<IntArray*>(a)->get(a_idx);
+      int b_val = static_cast<IntArray*>(b)->get(b_idx);
+      return (a_val > b_val) - (a_val < b_val);
+    }
+    case 'D': {
+      double a_val = static_cast<DoubleArray*>(a)->get(a_idx);
+      double b_val = static_cast<DoubleArray*>(b)->get(b_idx);
+      return (a_val > b_val) - (a_val < b_val);
+    }
+    case 'B':
+      return static_cast<BoolArray*>(a)->get(a_idx) - static_cast<BoolArray*>(b)->get(b_idx);
+    case 'S': {
+      String* a_val = static_cast<StringArray*>(a)->get(a_idx);
+      return strcmp(a_val->c_str(), static_cast<StringArray*>(b)->get(b_idx)->c_str());
+    }
+  }
+  assert(0);
+}
+
+/** Orders a field of the row and the idx-th element of a chunk of its type as compare_fields_
+  * orders two elements. */
+int compare_row_field_(Row& row, size_t col, Array* chunk, size_t idx) {
+  if (row.is_missing(col) || chunk->is_missing(idx))
+    return (int)chunk->is_missing(idx) - (int)row.is_missing(col);
+  switch (row.col_type(col)) {
+    case 'I': {
+      int val = static_cast<IntArray*>(chunk)->get(idx);
+      return (row.get_int(col) > val) - (row.get_int(col) < val);
+    }
+    case 'D': {
+      double val = static_cast<DoubleArray*>(chunk)->get(idx);
+      return (row.get_double(col) > val) - (row.get_double(col) < val);
+    }
+    case 'B': return row.get_bool(col) - static_cast<BoolArray*>(chunk)->get(idx);
+    case 'S': {
+      String* val = static_cast<StringArray*>(chunk)->get(idx);
+      return strcmp(row.get_string(col)->c_str(), val->c_str());
+    }
+  }
+  assert(0);
+}
+
+/** The idx-th element of a chunk of an 'I', 'D' or 'B' column, bools count as 0 and 1. */
+double field_as_double_(Array* chunk, char type, size_t idx) {
+  switch (type) {
+    case 'I': return static_cast<IntArray*>(chunk)->get(idx);
+    case 'D': return static_cast<DoubleArray*>(chunk)->get(idx);
+    case 'B': return static_cast<BoolArray*>(chunk)->get(idx);
+  }
+  assert(0); // only numeric columns can be aggregated
+}
+
+/** Pushes the idx-th element of a chunk of the given type onto an array of the same type, missing
+  * if it is. */
+void push_field_(Array* to, Array* from, char type, size_t idx) {
+  switch (type) {
+    case 'I': static_cast<IntArray*>(to)->push(static_cast<IntArray*>(from)->get(idx)); break;
+    case 'D': static_cast<DoubleArray*>(to)->push(static_cast<DoubleArray*>(from)->get(idx)); break;
+    case 'B': static_cast<BoolArray*>(to)->push(static_cast<BoolArray*>(from)->get(idx)); break;
+    case 'S': static_cast<StringArray*>(to)->push(static_cast<StringArray*>(from)->get(idx)); break;
+  }
+  if (from->is_missing(idx)) to->set_missing(to->length() - 1);
+}
+
+/** Pushes elements [start, end) of the from chunk onto to, the ints and doubles with a single
+  * copy. */
+void push_fields_(Array* to, Array* from, char type, size_t start, size_t end) {
+  size_t first = to->length();
+  switch (type) {
+    case 'I':
+      static_cast<IntArray*>(to)->push_range(static_cast<IntArray*>(from)->ints_ + start,
+        end - start);
+      break;
+    case 'D':
+      static_cast<DoubleArray*>(to)->push_range(static_cast<DoubleArray*>(from)->doubles_ + start,
+        end - start);
+      break;
+    case 'B':
+      for (size_t ii = start; ii < end; ii++)
+        static_cast<BoolArray*>(to)->push(static_cast<BoolArray*>(from)->get(ii));
+      break;
+    case 'S':
+      for (size_t ii = start; ii < end; ii++)
+        static_cast<StringArray*>(to)->push(static_cast<StringArray*>(from)->get(ii));
+      break;
+  }
+  for (size_t ii = start; ii < end && from->num_missing() > 0; ii++)
+    if (from->is_missing(ii)) to->set_missing(first + ii - start);
+}
+
+/** An empty array for elements of the given column type. */
+Array* new_field_array_(char type, size_t size) {
+  switch (type) {
+    case 'I': return new IntArray(size);
+    case 'D': return new DoubleArray(size);
+    case 'B': return new BoolArray(size);
+    case 'S': return new StringArray(size);
+  }
+  assert(0);
+}
@@ -0,0 +1,178 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "kernels.h"
+#include "partial_frame.h"
+#include "rower_registry.h"
+
+/*******************************************************************************
+ *  FilterRower::
+ *  Keeps the rows of the batches it is given accepted by a registered predicate
+ *  Rower, writing them to a PartialFrame homed on the node it runs on so the
+ *  kept rows never leave it. Every clone writes its own chunks and the partial
+ *  frames are appended in join order, see DataFrame::filter.
+ */
+class FilterRower : public BatchRower {
+ public:
+  Rower* predicate_; // owned
+  PartialFrame* kept_; // owned
+  Row* row_; // owned, borrows the strings of the batch
+
+  /** The predicate is cloned. */
+  FilterRower(String* name, Schema& schema, Rower& predicate, KV_Store* kv) {
+    predicate_ = predicate.clone();
+    kept_ = new PartialFrame(name, schema, kv, kv->get_node_index());
+    row_ = new Row(schema, true);
+  }
+
+  FilterRower(Deserializer& deserializer, KV_Store* kv) {
+    String predicate_name(deserializer);
+    RowerFactory factory = rower_registry().get(predicate_name.c_str());
+    assert(factory);
+    size_t predicate_len = deserializer.deserialize_size_t();
+    char* predicate_serial = new char[::max(predicate_len, 1)];
+    deserializer.deserialize_bytes(predicate_serial, predicate_len);
+    Deserializer predicate_deserializer(predicate_serial);
+    predicate_ = factory(predicate_deserializer, kv);
+    delete[] predicate_serial;
+    kept_ = new PartialFrame(deserializer, kv, kv->get_node_index());
+    row_ = new Row(kept_->schema_, true);
+  }
+
+  ~FilterRower() {
+    delete predicate_;
+    delete kept_;
+    delete row_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new FilterRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      batch.fill_row(ii, *row_);
+      if (predicate_->accept(*row_)) kept_->add_row(*row_);
+    }
+  }
+
+  BatchRower* clone() {
+    return new FilterRower(kept_->name_, kept_->schema_, *predicate_, kept_->kv_);
+  }
+
+  void join_delete(BatchRower* other) {
+    kept_->join(*dynamic_cast<FilterRower*>(other)->kept_);
+    delete other;
+  }
+
+  /** Returns the frame of the kept rows, owned by the caller. */
+  DataFrame* take() { return kept_->take(); }
+
+  const char* registered_name() { return "FilterRower"; }
+
+  size_t serial_len() {
+    String predicate_name(predicate_->registered_name());
+    return predicate_name.serial_len()
+      + sizeof(size_t) + predicate_->serial_len()
+      + kept_->serial_len();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    String predicate_name(predicate_->registered_name());
+    serializer.serialize_object(&predicate_name);
+    size_t predicate_len = predicate_->serial_len();
+    char* predicate_serial = predicate_->serialize();
+    serializer.serialize_size_t(predicate_len);
+    serializer.serialize_bytes(predicate_serial, predicate_len);
+    delete[] predicate_serial;
+    serializer.serialize_object(kept_);
+    return serializer.get_serial();
+  }
+};
+
+// Registered when the program starts, as any node may be asked to run one
+bool filter_rower_registered_ = (rower_registry().add("FilterRower",
+  static_cast<BatchRowerFactory>(FilterRower::deserialize)), true);
+
+/*******************************************************************************
+ *  EqualStringsFilterRower::
+ *  Keeps the rows of the batches whose 'S' column equals a value, picking them
+ *  with equal_strings_rows so dictionary encoded chunks are filtered on their
+ *  codes and skipped when their dictionary lacks the value. The kept rows are
+ *  written as FilterRower writes them, see DataFrame::filter.
+ */
+class EqualStringsFilterRower : public BatchRower {
+ public:
+  size_t col_;
+  String* value_; // owned
+  PartialFrame* kept_; // owned
+  Row* row_; // owned, borrows the strings of the batch
+  IntArray* rows_; // owned, rows of the current batch to keep
+
+  EqualStringsFilterRower(String* name, Schema& schema, size_t col, String* value, KV_Store* kv) {
+    assert(schema.col_type(col) == 'S');
+    col_ = col;
+    value_ = value->clone();
+    kept_ = new PartialFrame(name, schema, kv, kv->get_node_index());
+    row_ = new Row(schema, true);
+    rows_ = new IntArray(1);
+  }
+
+  EqualStringsFilterRower(Deserializer& deserializer, KV_Store* kv) {
+    col_ = deserializer.deserialize_size_t();
+    value_ = new String(deserializer);
+    kept_ = new PartialFrame(deserializer, kv, kv->get_node_index());
+    row_ = new Row(kept_->schema_, true);
+    rows_ = new IntArray(1);
+  }
+
+  ~EqualStringsFilterRower() {
+    delete value_;
+    delete kept_;
+    delete row_;
+    delete rows_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new EqualStringsFilterRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    rows_->clear();
+    equal_strings_rows(batch.strings(col_), value_, rows_);
+    for (size_t ii = 0; ii < rows_->length(); ii++) {
+      batch.fill_row(rows_->get(ii), *row_);
+      kept_->add_row(*row_);
+    }
+  }
+
+  BatchRower* clone() {
+    return new EqualStringsFilterRower(kept_->name_, kept_->schema_, col_, value_, kept_->kv_);
+  }
+
+  void join_delete(BatchRower* other) {
+    kept_->join(*dynamic_cast<EqualStringsFilterRower*>(other)->kept_);
+    delete other;
+  }
+
+  /** Returns the frame of the kept rows, owned by the caller. */
+  DataFrame* take() { return kept_->take(); }
+
+  const char* registered_name() { return "EqualStringsFilterRower"; }
+
+  size_t serial_len() {
+    return sizeof(size_t) + value_->serial_len() + kept_->serial_len();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_size_t(col_);
+    serializer.serialize_object(value_);
+    serializer.serialize_object(kept_);
+    return serializer.get_serial();
+  }
+};
+
+bool equal_strings_filter_rower_registered_ = (rower_registry().add("EqualStringsFilterRower",
+  static_cast<BatchRowerFactory>(EqualStringsFilterRower::deserialize)), true);
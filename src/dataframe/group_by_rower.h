@@ -0,0 +1,452 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "fields.h"
+#include "partial_frame.h"
+#include "rower_registry.h"
+
+/*******************************************************************************
+ *  GroupAggregates::
+ *  The aggregates a group by computes, each an AggOp over a column of the
+ *  frame. Count counts the rows of a group whatever the column, the others read
+ *  an 'I', 'D' or 'B' column. CountIf is not supported.
+ */
+class GroupAggregates : public Object {
+ public:
+  IntArray* ops_; // owned
+  IntArray* cols_; // owned
+
+  GroupAggregates() {
+    ops_ = new IntArray(1);
+    cols_ = new IntArray(1);
+  }
+
+  GroupAggregates(GroupAggregates& other) {
+    ops_ = other.ops_->clone();
+    cols_ = other.cols_->clone();
+  }
+
+  GroupAggregates(Deserializer& deserializer) {
+    ops_ = new IntArray(deserializer);
+    cols_ = new IntArray(deserializer);
+  }
+
+  ~GroupAggregates() {
+    delete ops_;
+    delete cols_;
+  }
+
+  GroupAggregates* clone() { return new GroupAggregates(*this); }
+
+  void add(AggOp op, size_t col) {
+    assert(op != AggOp::CountIf);
+    ops_->push(static_cast<int>(op));
+    cols_->push(col);
+  }
+
+  size_t length() { return ops_->length(); }
+
+  AggOp op(size_t idx) { return static_cast<AggOp>(ops_->get(idx)); }
+
+  size_t col(size_t idx) { return cols_->get(idx); }
+
+  /** Type of the column holding the results of the idx-th aggregate. */
+  char result_type(size_t idx) { return op(idx) == AggOp::Count ? 'I' : 'D'; }
+
+  size_t serial_len() { return ops_->serial_len() + cols_->serial_len(); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(ops_);
+    serializer.serialize_object(cols_);
+    return serializer.get_serial();
+  }
+};
+
+// Doubles of partial state per aggregate of a group, see GroupTable::state_
+const size_t GROUP_STATE_WIDTH = 4;
+
+/*******************************************************************************
+ *  GroupTable::
+ *  Open addressing hash table from the keys of groups to the partial state of
+ *  their aggregates: the number of rows of the group and, per aggregate, the
+ *  sum, min, max and number of its values, missing values left out. Groups are
+ *  numbered in insertion order and their keys kept in one array per key column.
+ *  Missing keys form a group of their own.
+ */
+class GroupTable : public Object {
+ public:
+  Schema keys_; // types of the key columns
+  size_t num_aggs_;
+  Array** key_arrays_; // owned, key of group g at element g of every array
+  IntArray* counts_; // owned
+  DoubleArray* states_; // owned, sum, min, max and count of aggregate a of group g, see state_
+  int* slots_; // owned, group of every slot, -1 if none
+  size_t mask_;
+  size_t num_lookups_; // calls to find_or_add so far
+
+  GroupTable(Schema& keys, size_t num_aggs) : keys_(keys) {
+    num_aggs_ = num_aggs;
+    key_arrays_ = new Array*[::max(keys_.width(), 1)];
+    for (size_t ii = 0; ii < keys_.width(); ii++)
+      key_arrays_[ii] = new_field_array_(keys_.col_type(ii), 1);
+    counts_ = new IntArray(1);
+    states_ = new DoubleArray(1);
+    mask_ = 15;
+    slots_ = new int[mask_ + 1];
+    for (size_t ii = 0; ii <= mask_; ii++) slots_[ii] = -1;
+    num_lookups_ = 0;
+  }
+
+  ~GroupTable() {
+    for (size_t ii = 0; ii < keys_.width(); ii++) delete key_arrays_[ii];
+    delete[] key_arrays_;
+    delete counts_;
+    delete states_;
+    delete[] slots_;
+  }
+
+  size_t num_groups() { return counts_->length(); }
+
+  /** Hash of the keys at element idx of the key chunks, one per key column. */
+  uint64_t hash(Array** key_chunks, size_t idx) {
+    uint64_t hash = 0;
+    for (size_t ii = 0; ii < keys_.width(); ii++)
+      hash = mix_hash_(hash + field_hash_(key_chunks[ii], keys_.col_type(ii), idx));
+    return hash;
+  }
+
+  bool matches_(size_t group, Array** key_chunks, size_t idx) {
+    for (size_t ii = 0; ii < keys_.width(); ii++)
+      if (!fields_equal_(key_arrays_[ii], group, key_chunks[ii], keys_.col_type(ii), idx))
+        return false;
+    return true;
+  }
+
+  /** Doubles the slots once they are half full. */
+  void grow_() {
+    delete[] slots_;
+    mask_ = mask_ * 2 + 1;
+    slots_ = new int[mask_ + 1];
+    for (size_t ii = 0; ii <= mask_; ii++) slots_[ii] = -1;
+    for (size_t group = 0; group < num_groups(); group++) {
+      size_t slot = (hash(key_arrays_, group) >> 32) & mask_;
+      while (slots_[slot] != -1) slot = (slot + 1) & mask_;
+      slots_[slot] = group;
+    }
+  }
+
+  /** The group of the keys at element idx of the key chunks, added with no row if new. */
+  size_t find_or_add(Array** key_chunks, size_t idx) {
+    num_lookups_++;
+    size_t slot = (hash(key_chunks, idx) >> 32) & mask_;
+    while (slots_[slot] != -1) {
+      if (matches_(slots_[slot], key_chunks, idx)) return slots_[slot];
+      slot = (slot + 1) & mask_;
+    }
+    size_t group = num_groups();
+    for (size_t ii = 0; ii < keys_.width(); ii++)
+      push_field_(key_arrays_[ii], key_chunks[ii], keys_.col_type(ii), idx);
+    counts_->push(0);
+    for (size_t ii = 0; ii < num_aggs_; ii++) {
+      states_->push(0);
+      states_->push(INFINITY);
+      states_->push(-INFINITY);
+      states_->push(0);
+    }
+    slots_[slot] = group;
+    if (num_groups() * 2 > mask_ + 1) grow_();
+    return group;
+  }
+
+  /** The sum, min, max and number of values of the aggregate of the group. */
+  double* state_(size_t group, size_t agg) {
+    return states_->doubles_ + (group * num_aggs_ + agg) * GROUP_STATE_WIDTH;
+  }
+
+  void add_rows(size_t group, size_t count) { counts_->ints_[group] += count; }
+
+  /** Adds a value, or the partial state of other values, to an aggregate of the group. */
+  void add_value(size_t group, size_t agg, double sum, double min, double max, double count) {
+    double* state = state_(group, agg);
+    state[0] += sum;
+    state[1] = std::min(state[1], min);
+    state[2] = std::max(state[2], max);
+    state[3] += count;
+  }
+
+  /** Adds the groups of the other table to those of this one. */
+  void combine(GroupTable& other) {
+    for (size_t group = 0; group < other.num_groups(); group++) {
+      size_t into = find_or_add(other.key_arrays_, group);
+      add_rows(into, other.counts_->get(group));
+      for (size_t ii = 0; ii < num_aggs_; ii++) {
+        double* state = other.state_(group, ii);
+        add_value(into, ii, state[0], state[1], state[2], state[3]);
+      }
+    }
+  }
+
+  /** Sets the fields of the row with the keys of the group, its row count and the state of every
+    * aggregate, the layout of the partial frames of DataFrame::group_by. */
+  void fill_partial_row(size_t group, Row& row) {
+    set_fields_(row, 0, keys_, key_arrays_, group);
+    row.set(keys_.width(), counts_->get(group));
+    for (size_t ii = 0; ii < num_aggs_ * GROUP_STATE_WIDTH; ii++)
+      row.set(keys_.width() + 1 + ii, state_(group, 0)[ii]);
+  }
+
+  /** Sets the fields of the row with the keys of the group and the result of every aggregate,
+    * missing for the aggregates other than Count over no value. */
+  void fill_result_row(size_t group, Row& row, GroupAggregates& aggregates) {
+    set_fields_(row, 0, keys_, key_arrays_, group);
+    int count = counts_->get(group);
+    for (size_t ii = 0; ii < num_aggs_; ii++) {
+      double* state = state_(group, ii);
+      size_t col = keys_.width() + ii;
+      if (aggregates.op(ii) != AggOp::Count && state[3] == 0) {
+        row.set_missing(col);
+        continue;
+      }
+      switch (aggregates.op(ii)) {
+        case AggOp::Count: row.set(col, count); break;
+        case AggOp::Sum: row.set(col, state[0]); break;
+        case AggOp::Min: row.set(col, state[1]); break;
+        case AggOp::Max: row.set(col, state[2]); break;
+        case AggOp::Mean: row.set(col, state[0] / state[3]); break;
+        default: assert(0);
+      }
+    }
+  }
+};
+
+/*******************************************************************************
+ *  GroupByRower::
+ *  Aggregates the rows of the batches it is given by group with a GroupTable
+ *  per thread, the tables of the clones being combined on join. A single string
+ *  key whose chunk is dictionary encoded is grouped on its codes, each distinct
+ *  string looked up once per batch. When the rower
+ *  leaves the node, its groups are written out as partial rows to num_parts
+ *  partial frames by the hash of their keys, partition p homed on node p. The
+ *  final rower then reads those partials, already grouped by node, and writes
+ *  the result of every group to a frame homed on the node it runs on. See
+ *  DataFrame::group_by.
+ */
+class GroupByRower : public BatchRower {
+ public:
+  String* name_; // owned, prefix of the names of the parts
+  IntArray* key_cols_; // owned, columns of the batches holding the keys
+  GroupAggregates* aggregates_; // owned
+  bool final_; // whether the batches hold partial rows
+  size_t num_parts_;
+  Schema out_schema_;
+  KV_Store* kv_; // not owned, store of the node the rower runs on
+  GroupTable* table_; // owned
+  PartialFrame** parts_; // owned
+  Row* row_; // owned, row of the frames written, borrows the strings of the keys
+  Array** key_chunks_; // owned array, chunks of the keys of the current batch
+
+  /** Reading the partials, the key columns are the first ones and there is a single part. */
+  GroupByRower(String* name, Schema& schema, IntArray& key_cols, GroupAggregates& aggregates,
+      bool final, size_t num_parts, KV_Store* kv) {
+    name_ = name->clone();
+    key_cols_ = key_cols.clone();
+    aggregates_ = aggregates.clone();
+    final_ = final;
+    num_parts_ = num_parts;
+    for (size_t ii = 0; ii < key_cols_->length(); ii++)
+      out_schema_.add_column(schema.col_type(key_cols_->get(ii)));
+    for (size_t ii = 0; ii < aggregates_->length() && final_; ii++)
+      out_schema_.add_column(aggregates_->result_type(ii));
+    if (!final_) {
+      out_schema_.add_column('I');
+      for (size_t ii = 0; ii < aggregates_->length() * GROUP_STATE_WIDTH; ii++)
+        out_schema_.add_column('D');
+    }
+    kv_ = kv;
+    init_(nullptr);
+  }
+
+  GroupByRower(GroupByRower& from) : out_schema_(from.out_schema_) {
+    name_ = from.name_->clone();
+    key_cols_ = from.key_cols_->clone();
+    aggregates_ = from.aggregates_->clone();
+    final_ = from.final_;
+    num_parts_ = from.num_parts_;
+    kv_ = from.kv_;
+    init_(nullptr);
+  }
+
+  GroupByRower(Deserializer& deserializer, KV_Store* kv) : out_schema_(deserializer) {
+    name_ = new String(deserializer);
+    key_cols_ = new IntArray(deserializer);
+    aggregates_ = new GroupAggregates(deserializer);
+    final_ = deserializer.deserialize_bool();
+    num_parts_ = deserializer.deserialize_size_t();
+    kv_ = kv;
+    init_(&deserializer);
+  }
+
+  /** Creates the table and the parts, reading the parts from the deserializer if any. */
+  void init_(Deserializer* deserializer) {
+    Schema keys;
+    for (size_t ii = 0; ii < key_cols_->length(); ii++) keys.add_column(out_schema_.col_type(ii));
+    table_ = new GroupTable(keys, aggregates_->length());
+    parts_ = new PartialFrame*[num_parts_];
+    for (size_t ii = 0; ii < num_parts_; ii++) {
+      size_t home = final_ ? kv_->get_node_index() : ii;
+      if (deserializer != nullptr) {
+        parts_[ii] = new PartialFrame(*deserializer, kv_, home);
+        continue;
+      }
+      String part_name(*name_);
+      if (!final_) {
+        part_name.concat('_');
+        part_name.concat(ii);
+      }
+      parts_[ii] = new PartialFrame(&part_name, out_schema_, kv_, home);
+    }
+    row_ = new Row(out_schema_, true);
+    key_chunks_ = new Array*[::max(key_cols_->length(), 1)];
+  }
+
+  ~GroupByRower() {
+    delete name_;
+    delete key_cols_;
+    delete aggregates_;
+    delete table_;
+    for (size_t ii = 0; ii < num_parts_; ii++) delete parts_[ii];
+    delete[] parts_;
+    delete row_;
+    delete[] key_chunks_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new GroupByRower(deserializer, kv);
+  }
+
+  /** The strings of the key if it is a single string column whose chunk in the batch is
+    * dictionary encoded, nullptr otherwise. */
+  DictStringArray* dict_keys_(RowBatch& batch) {
+    if (key_cols_->length() != 1 || batch.col_type(key_cols_->get(0)) != 'S') return nullptr;
+    return batch.dict_strings(key_cols_->get(0));
+  }
+
+  /** The group of the idx-th row of a batch whose key is dictionary encoded. Every code is looked
+    * up in the table once per batch, on its first row, and its group kept at code_groups[code + 1],
+    * the missing keys at code_groups[0]. */
+  size_t dict_group_(DictStringArray* dict, int* code_groups, size_t idx) {
+    int code = dict->codes()[idx];
+    if (code_groups[code + 1] == -1) {
+      if (code == -1) {
+        code_groups[0] = table_->find_or_add(key_chunks_, idx);
+      } else {
+        Array* entries = dict->dictionary();
+        code_groups[code + 1] = table_->find_or_add(&entries, code);
+      }
+    }
+    return code_groups[code + 1];
+  }
+
+  void accept(RowBatch& batch) {
+    size_t num_keys = key_cols_->length();
+    for (size_t ii = 0; ii < num_keys; ii++) key_chunks_[ii] = batch.chunks_[key_cols_->get(ii)];
+    DictStringArray* dict = dict_keys_(batch);
+    int* code_groups = nullptr;
+    if (dict != nullptr) {
+      size_t num_codes = dict->dictionary()->length() + 1;
+      code_groups = new int[num_codes];
+      for (size_t ii = 0; ii < num_codes; ii++) code_groups[ii] = -1;
+    }
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      size_t group = dict == nullptr ? table_->find_or_add(key_chunks_, ii)
+        : dict_group_(dict, code_groups, ii);
+      if (final_) {
+        table_->add_rows(group, batch.ints(num_keys)[ii]);
+        for (size_t jj = 0; jj < aggregates_->length(); jj++) {
+          size_t col = num_keys + 1 + jj * GROUP_STATE_WIDTH;
+          table_->add_value(group, jj, batch.doubles(col)[ii], batch.doubles(col + 1)[ii],
+            batch.doubles(col + 2)[ii], batch.doubles(col + 3)[ii]);
+        }
+        continue;
+      }
+      table_->add_rows(group, 1);
+      for (size_t jj = 0; jj < aggregates_->length(); jj++) {
+        if (aggregates_->op(jj) == AggOp::Count) continue;
+        size_t col = aggregates_->col(jj);
+        if (batch.is_missing(col, ii)) continue;
+        double val = field_as_double_(batch.chunks_[col], batch.col_type(col), ii);
+        table_->add_value(group, jj, val, val, val, 1);
+      }
+    }
+    delete[] code_groups;
+  }
+
+  /** Writes the groups of the table to the parts and empties it. */
+  void flush_() {
+    for (size_t group = 0; group < table_->num_groups(); group++) {
+      if (final_) {
+        table_->fill_result_row(group, *row_, *aggregates_);
+        parts_[0]->add_row(*row_);
+      } else {
+        table_->fill_partial_row(group, *row_);
+        parts_[table_->hash(table_->key_arrays_, group) % num_parts_]->add_row(*row_);
+      }
+    }
+    Schema keys(table_->keys_);
+    delete table_;
+    table_ = new GroupTable(keys, aggregates_->length());
+  }
+
+  BatchRower* clone() { return new GroupByRower(*this); }
+
+  void join_delete(BatchRower* other) {
+    GroupByRower* group_by_rower = dynamic_cast<GroupByRower*>(other);
+    table_->combine(*group_by_rower->table_);
+    for (size_t ii = 0; ii < num_parts_; ii++) parts_[ii]->join(*group_by_rower->parts_[ii]);
+    delete other;
+  }
+
+  /** Writes out the groups left in the table and returns the frame of every part appended in
+    * part order, owned by the caller. */
+  DataFrame* take() {
+    flush_();
+    DataFrame* result = parts_[0]->take();
+    for (size_t ii = 1; ii < num_parts_; ii++) {
+      DataFrame* part = parts_[ii]->take();
+      result->append_chunks(*part);
+      delete part;
+    }
+    return result;
+  }
+
+  const char* registered_name() { return "GroupByRower"; }
+
+  // The groups are written out from the node the rower leaves, only the parts are sent
+  size_t serial_len() {
+    flush_();
+    size_t len = out_schema_.serial_len()
+      + name_->serial_len()
+      + key_cols_->serial_len()
+      + aggregates_->serial_len()
+      + sizeof(bool)
+      + sizeof(size_t);
+    for (size_t ii = 0; ii < num_parts_; ii++) len += parts_[ii]->serial_len();
+    return len;
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(&out_schema_);
+    serializer.serialize_object(name_);
+    serializer.serialize_object(key_cols_);
+    serializer.serialize_object(aggregates_);
+    serializer.serialize_bool(final_);
+    serializer.serialize_size_t(num_parts_);
+    for (size_t ii = 0; ii < num_parts_; ii++) serializer.serialize_object(parts_[ii]);
+    return serializer.get_serial();
+  }
+};
+
+bool group_by_rower_registered_ = (rower_registry().add("GroupByRower",
+  static_cast<BatchRowerFactory>(GroupByRower::deserialize)), true);
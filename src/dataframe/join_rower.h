@@ -0,0 +1,260 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <mutex>
+
+#include "partition_rower.h"
+
+/*******************************************************************************
+ *  JoinTable::
+ *  Hash table over the key column of the build side of a join, chained through
+ *  arrays of entries. It is built on first use from every chunk of the build
+ *  frame when broadcast, from the chunks homed on this node otherwise, and then
+ *  probed concurrently by every clone of the JoinRower on the node. The chunks
+ *  of a broadcast table are fetched once by the node driving the join and sent
+ *  along with the rower, see JoinRower::serialize.
+ */
+class JoinTable : public Object {
+ public:
+  DataFrame* build_; // owned
+  size_t col_;
+  bool broadcast_;
+  KV_Store* kv_; // not owned
+  std::once_flag built_;
+  bool fetched_; // whether chunks_ holds the chunks of the table
+  size_t num_chunks_;
+  Array** chunks_; // owned, column jj of the ii-th chunk of the table at ii * width + jj
+  int* heads_; // owned, first entry of every slot, -1 if none
+  size_t mask_;
+  IntArray* next_; // owned, next entry of the same slot, -1 if none
+  IntArray* entry_chunks_; // owned
+  IntArray* entry_offsets_; // owned
+
+  /** Takes ownership of the build frame. */
+  JoinTable(DataFrame* build, size_t col, bool broadcast, KV_Store* kv) {
+    build_ = build;
+    col_ = col;
+    broadcast_ = broadcast;
+    kv_ = kv;
+    fetched_ = false;
+    num_chunks_ = 0;
+    chunks_ = nullptr;
+    heads_ = nullptr;
+    mask_ = 0;
+    next_ = new IntArray(1);
+    entry_chunks_ = new IntArray(1);
+    entry_offsets_ = new IntArray(1);
+  }
+
+  ~JoinTable() {
+    for (size_t ii = 0; ii < num_chunks_ * width(); ii++) delete chunks_[ii];
+    delete[] chunks_;
+    delete[] heads_;
+    delete next_;
+    delete entry_chunks_;
+    delete entry_offsets_;
+    delete build_;
+  }
+
+  size_t width() { return build_->ncols(); }
+
+  char key_type() { return build_->get_schema().col_type(col_); }
+
+  /** Builds the table unless another thread already has. */
+  void build() { std::call_once(built_, &JoinTable::build_table_, this); }
+
+  /** Fetches the chunks of the table unless they already were, or were read with the rower. */
+  void fetch() {
+    if (fetched_) return;
+    IntArray* chunk_indexes = broadcast_ ? build_->all_chunks_() : build_->local_chunks();
+    num_chunks_ = chunk_indexes->length();
+    chunks_ = new Array*[::max(num_chunks_ * width(), 1)];
+    for (size_t ii = 0; ii < num_chunks_; ii++)
+      build_->fetch_chunks_(chunk_indexes->get(ii), chunks_ + ii * width(), nullptr);
+    fetched_ = true;
+    delete chunk_indexes;
+  }
+
+  /** Reads chunks serialized by serialize_chunks_ instead of fetching them. */
+  void read_chunks_(Deserializer& deserializer) {
+    num_chunks_ = deserializer.deserialize_size_t();
+    chunks_ = new Array*[::max(num_chunks_ * width(), 1)];
+    for (size_t ii = 0; ii < num_chunks_ * width(); ii++)
+      chunks_[ii] = deserialize_array(deserializer, build_->get_schema().col_type(ii % width()));
+    fetched_ = true;
+  }
+
+  size_t chunks_serial_len_() {
+    size_t len = sizeof(size_t);
+    for (size_t ii = 0; ii < num_chunks_ * width(); ii++) len += chunks_[ii]->serial_len();
+    return len;
+  }
+
+  void serialize_chunks_(Serializer& serializer) {
+    serializer.serialize_size_t(num_chunks_);
+    for (size_t ii = 0; ii < num_chunks_ * width(); ii++) serializer.serialize_object(chunks_[ii]);
+  }
+
+  void build_table_() {
+    fetch();
+    size_t rows = 0;
+    for (size_t ii = 0; ii < num_chunks_; ii++) rows += chunks_[ii * width()]->length();
+    size_t slots = 1;
+    while (slots < rows * 2) slots *= 2;
+    mask_ = slots - 1;
+    heads_ = new int[slots];
+    for (size_t ii = 0; ii < slots; ii++) heads_[ii] = -1;
+
+    char type = key_type();
+    for (size_t ii = 0; ii < num_chunks_; ii++) {
+      Array* keys = chunks_[ii * width() + col_];
+      for (size_t jj = 0; jj < keys->length(); jj++) {
+        if (is_null_field_(keys, jj)) continue;
+        size_t slot = (field_hash_(keys, type, jj) >> 32) & mask_;
+        next_->push(heads_[slot]);
+        heads_[slot] = entry_chunks_->length();
+        entry_chunks_->push(ii);
+        entry_offsets_->push(jj);
+      }
+    }
+  }
+
+  /** First entry of the table whose key may equal the given one, -1 if none. */
+  int first(uint64_t hash) { return heads_[(hash >> 32) & mask_]; }
+
+  int next(int entry) { return next_->get(entry); }
+
+  /** Whether the key of the entry equals the idx-th key of the chunk. */
+  bool matches(int entry, Array* keys, size_t idx) {
+    return fields_equal_(chunks_[entry_chunks_->get(entry) * width() + col_],
+      entry_offsets_->get(entry), keys, key_type(), idx);
+  }
+
+  /** Sets fields [first_col, first_col + width()) of the row with those of the entry. */
+  void fill_row(int entry, Row& row, size_t first_col) {
+    set_fields_(row, first_col, build_->get_schema(), chunks_ + entry_chunks_->get(entry) * width(),
+      entry_offsets_->get(entry));
+  }
+};
+
+/*******************************************************************************
+ *  JoinRower::
+ *  Probes a JoinTable with the keys of the batches it is given and writes every
+ *  matching pair of rows to a PartialFrame homed on the node it runs on. The
+ *  joined rows hold the columns of the left frame then those of the right one,
+ *  whichever side the table was built from. A broadcast rower fetches the
+ *  build frame when made and carries its chunks, so the nodes it is shipped to
+ *  never wait on other nodes while running it. See DataFrame::join.
+ */
+class JoinRower : public BatchRower {
+ public:
+  size_t probe_col_;
+  bool build_is_left_;
+  JoinTable* table_; // owned if owns_table_, shared with the clones
+  bool owns_table_;
+  PartialFrame* joined_; // owned
+  Row* row_; // owned, borrows the strings of the batch and the table
+
+  /** The build frame is copied, and fetched right away when broadcast. */
+  JoinRower(String* name, Schema& schema, size_t probe_col, DataFrame& build, size_t build_col,
+      bool build_is_left, bool broadcast, KV_Store* kv) {
+    probe_col_ = probe_col;
+    build_is_left_ = build_is_left;
+    DataFrame* build_copy = new DataFrame(build.get_schema(), kv, build.cols_);
+    table_ = new JoinTable(build_copy, build_col, broadcast, kv);
+    if (broadcast) table_->fetch();
+    owns_table_ = true;
+    joined_ = new PartialFrame(name, schema, kv, kv->get_node_index());
+    row_ = new Row(schema, true);
+  }
+
+  /** A clone probing the same table. */
+  JoinRower(JoinRower& from) {
+    probe_col_ = from.probe_col_;
+    build_is_left_ = from.build_is_left_;
+    table_ = from.table_;
+    owns_table_ = false;
+    KV_Store* kv = from.joined_->kv_;
+    joined_ = new PartialFrame(from.joined_->name_, from.joined_->schema_, kv,
+      kv->get_node_index());
+    row_ = new Row(joined_->schema_, true);
+  }
+
+  JoinRower(Deserializer& deserializer, KV_Store* kv) {
+    probe_col_ = deserializer.deserialize_size_t();
+    build_is_left_ = deserializer.deserialize_bool();
+    size_t build_col = deserializer.deserialize_size_t();
+    bool broadcast = deserializer.deserialize_bool();
+    table_ = new JoinTable(new DataFrame(deserializer, kv), build_col, broadcast, kv);
+    if (broadcast) table_->read_chunks_(deserializer);
+    owns_table_ = true;
+    joined_ = new PartialFrame(deserializer, kv, kv->get_node_index());
+    row_ = new Row(joined_->schema_, true);
+  }
+
+  ~JoinRower() {
+    if (owns_table_) delete table_;
+    delete joined_;
+    delete row_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new JoinRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    table_->build();
+    Array* keys = batch.chunks_[probe_col_];
+    char type = batch.col_type(probe_col_);
+    size_t probe_first = build_is_left_ ? table_->width() : 0;
+    size_t build_first = build_is_left_ ? 0 : batch.width();
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      if (is_null_field_(keys, ii)) continue;
+      bool probe_set = false;
+      for (int entry = table_->first(field_hash_(keys, type, ii)); entry != -1;
+          entry = table_->next(entry)) {
+        if (!table_->matches(entry, keys, ii)) continue;
+        if (!probe_set) set_fields_(*row_, probe_first, batch.schema_, batch.chunks_, ii);
+        probe_set = true;
+        table_->fill_row(entry, *row_, build_first);
+        joined_->add_row(*row_);
+      }
+    }
+  }
+
+  BatchRower* clone() { return new JoinRower(*this); }
+
+  void join_delete(BatchRower* other) {
+    joined_->join(*dynamic_cast<JoinRower*>(other)->joined_);
+    delete other;
+  }
+
+  /** Returns the frame of the joined rows, owned by the caller. */
+  DataFrame* take() { return joined_->take(); }
+
+  const char* registered_name() { return "JoinRower"; }
+
+  // The table itself is not sent, every node builds its own, from the chunks sent along when
+  // broadcast
+  size_t serial_len() {
+    return sizeof(size_t) + sizeof(bool) + sizeof(size_t) + sizeof(bool)
+      + table_->build_->serial_len()
+      + (table_->broadcast_ ? table_->chunks_serial_len_() : 0)
+      + joined_->serial_len();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_size_t(probe_col_);
+    serializer.serialize_bool(build_is_left_);
+    serializer.serialize_size_t(table_->col_);
+    serializer.serialize_bool(table_->broadcast_);
+    serializer.serialize_object(table_->build_);
+    if (table_->broadcast_) table_->serialize_chunks_(serializer);
+    serializer.serialize_object(joined_);
+    return serializer.get_serial();
+  }
+};
+
+bool join_rower_registered_ = (rower_registry().add("JoinRower",
+  static_cast<BatchRowerFactory>(JoinRower::deserialize)), true);
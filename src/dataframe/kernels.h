@@ -0,0 +1,701 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+
+#include "../helpers/array.h"
+#include "../helpers/serial.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+/**
+ * Aggregation kernels over the memory of dense chunks. Every kernel comes in an AVX2, an SSE4.1
+ * and a scalar version, the widest one the CPU supports is picked at run time so that the build
+ * does not need any -m flag.
+ */
+
+// Comparison of a count_if predicate, element op value
+enum class CmpOp { Lt, Le, Gt, Ge, Eq, Ne };
+
+// Bitwise operation between bool columns, Not only reads its first operand
+enum class BoolOp { And, Or, Not };
+
+// Instruction sets the kernels can use, in increasing order
+enum class SimdLevel { Scalar, Sse41, Avx2 };
+
+SimdLevel detect_simd_level_() {
+#ifdef KERNELS_X86
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+  if (__builtin_cpu_supports("sse4.1")) return SimdLevel::Sse41;
+#endif
+  return SimdLevel::Scalar;
+}
+
+SimdLevel& simd_level_() {
+  static SimdLevel level = detect_simd_level_();
+  return level;
+}
+
+/** The instruction set the kernels currently use. */
+SimdLevel simd_level() { return simd_level_(); }
+
+/** Restricts the kernels to the given instruction set, used to check the narrower versions
+  * against each other. A level the CPU does not support falls back to the widest one it does. */
+void set_simd_level(SimdLevel level) {
+  SimdLevel detected = detect_simd_level_();
+  simd_level_() = level < detected ? level : detected;
+}
+
+bool compare(double val, CmpOp op, double value) {
+  switch (op) {
+    case CmpOp::Lt: return val < value;
+    case CmpOp::Le: return val <= value;
+    case CmpOp::Gt: return val > value;
+    case CmpOp::Ge: return val >= value;
+    case CmpOp::Eq: return val == value;
+    case CmpOp::Ne: return val != value;
+  }
+  assert(0);
+}
+
+/******************************** Scalar ********************************/
+
+long sum_ints_scalar_(const int* vals, size_t n) {
+  long sum = 0;
+  for (size_t ii = 0; ii < n; ii++) sum += vals[ii];
+  return sum;
+}
+
+double sum_doubles_scalar_(const double* vals, size_t n) {
+  double sum = 0;
+  for (size_t ii = 0; ii < n; ii++) sum += vals[ii];
+  return sum;
+}
+
+int min_ints_scalar_(const int* vals, size_t n) {
+  int result = vals[0];
+  for (size_t ii = 1; ii < n; ii++) if (vals[ii] < result) result = vals[ii];
+  return result;
+}
+
+int max_ints_scalar_(const int* vals, size_t n) {
+  int result = vals[0];
+  for (size_t ii = 1; ii < n; ii++) if (vals[ii] > result) result = vals[ii];
+  return result;
+}
+
+double min_doubles_scalar_(const double* vals, size_t n) {
+  double result = vals[0];
+  for (size_t ii = 1; ii < n; ii++) if (vals[ii] < result) result = vals[ii];
+  return result;
+}
+
+double max_doubles_scalar_(const double* vals, size_t n) {
+  double result = vals[0];
+  for (size_t ii = 1; ii < n; ii++) if (vals[ii] > result) result = vals[ii];
+  return result;
+}
+
+size_t count_if_ints_scalar_(const int* vals, size_t n, CmpOp op, double value) {
+  size_t count = 0;
+  for (size_t ii = 0; ii < n; ii++) count += compare(vals[ii], op, value);
+  return count;
+}
+
+size_t count_if_doubles_scalar_(const double* vals, size_t n, CmpOp op, double value) {
+  size_t count = 0;
+  for (size_t ii = 0; ii < n; ii++) count += compare(vals[ii], op, value);
+  return count;
+}
+
+uint64_t bool_op_word_(uint64_t a, BoolOp op, uint64_t b) {
+  switch (op) {
+    case BoolOp::And: return a & b;
+    case BoolOp::Or: return a | b;
+    case BoolOp::Not: return ~a;
+  }
+  assert(0);
+}
+
+void bool_op_words_scalar_(const uint64_t* a, BoolOp op, const uint64_t* b, uint64_t* out,
+    size_t n) {
+  for (size_t ii = 0; ii < n; ii++) out[ii] = bool_op_word_(a[ii], op, b[ii]);
+}
+
+#ifdef KERNELS_X86
+
+/******************************** SSE4.1 ********************************/
+
+__attribute__((target("sse4.1")))
+__m128d compare_sse_(__m128d vals, CmpOp op, __m128d value) {
+  switch (op) {
+    case CmpOp::Lt: return _mm_cmplt_pd(vals, value);
+    case CmpOp::Le: return _mm_cmple_pd(vals, value);
+    case CmpOp::Gt: return _mm_cmpgt_pd(vals, value);
+    case CmpOp::Ge: return _mm_cmpge_pd(vals, value);
+    case CmpOp::Eq: return _mm_cmpeq_pd(vals, value);
+    case CmpOp::Ne: return _mm_cmpneq_pd(vals, value);
+  }
+  assert(0);
+}
+
+__attribute__((target("sse4.1")))
+long sum_ints_sse_(const int* vals, size_t n) {
+  __m128i acc = _mm_setzero_si128(); // 2 x int64
+  size_t ii = 0;
+  for (; ii + 4 <= n; ii += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(vals + ii));
+    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+  }
+  long lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  return lanes[0] + lanes[1] + sum_ints_scalar_(vals + ii, n - ii);
+}
+
+__attribute__((target("sse4.1")))
+double sum_doubles_sse_(const double* vals, size_t n) {
+  __m128d acc = _mm_setzero_pd();
+  size_t ii = 0;
+  for (; ii + 2 <= n; ii += 2) acc = _mm_add_pd(acc, _mm_loadu_pd(vals + ii));
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  return lanes[0] + lanes[1] + sum_doubles_scalar_(vals + ii, n - ii);
+}
+
+__attribute__((target("sse4.1")))
+int min_ints_sse_(const int* vals, size_t n) {
+  if (n < 4) return min_ints_scalar_(vals, n);
+  __m128i acc = _mm_loadu_si128((const __m128i*)vals);
+  size_t ii = 4;
+  for (; ii + 4 <= n; ii += 4) acc = _mm_min_epi32(acc, _mm_loadu_si128((const __m128i*)(vals + ii)));
+  int lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  int result = min_ints_scalar_(lanes, 4);
+  return ii < n ? std::min(result, min_ints_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("sse4.1")))
+int max_ints_sse_(const int* vals, size_t n) {
+  if (n < 4) return max_ints_scalar_(vals, n);
+  __m128i acc = _mm_loadu_si128((const __m128i*)vals);
+  size_t ii = 4;
+  for (; ii + 4 <= n; ii += 4) acc = _mm_max_epi32(acc, _mm_loadu_si128((const __m128i*)(vals + ii)));
+  int lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  int result = max_ints_scalar_(lanes, 4);
+  return ii < n ? std::max(result, max_ints_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("sse4.1")))
+double min_doubles_sse_(const double* vals, size_t n) {
+  if (n < 2) return min_doubles_scalar_(vals, n);
+  __m128d acc = _mm_loadu_pd(vals);
+  size_t ii = 2;
+  for (; ii + 2 <= n; ii += 2) acc = _mm_min_pd(acc, _mm_loadu_pd(vals + ii));
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  double result = min_doubles_scalar_(lanes, 2);
+  return ii < n ? std::min(result, vals[ii]) : result;
+}
+
+__attribute__((target("sse4.1")))
+double max_doubles_sse_(const double* vals, size_t n) {
+  if (n < 2) return max_doubles_scalar_(vals, n);
+  __m128d acc = _mm_loadu_pd(vals);
+  size_t ii = 2;
+  for (; ii + 2 <= n; ii += 2) acc = _mm_max_pd(acc, _mm_loadu_pd(vals + ii));
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  double result = max_doubles_scalar_(lanes, 2);
+  return ii < n ? std::max(result, vals[ii]) : result;
+}
+
+__attribute__((target("sse4.1")))
+size_t count_if_ints_sse_(const int* vals, size_t n, CmpOp op, double value) {
+  __m128d bound = _mm_set1_pd(value);
+  size_t count = 0;
+  size_t ii = 0;
+  for (; ii + 2 <= n; ii += 2) {
+    __m128d v = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(vals + ii)));
+    count += __builtin_popcount(_mm_movemask_pd(compare_sse_(v, op, bound)));
+  }
+  return count + count_if_ints_scalar_(vals + ii, n - ii, op, value);
+}
+
+__attribute__((target("sse4.1")))
+size_t count_if_doubles_sse_(const double* vals, size_t n, CmpOp op, double value) {
+  __m128d bound = _mm_set1_pd(value);
+  size_t count = 0;
+  size_t ii = 0;
+  for (; ii + 2 <= n; ii += 2)
+    count += __builtin_popcount(_mm_movemask_pd(compare_sse_(_mm_loadu_pd(vals + ii), op, bound)));
+  return count + count_if_doubles_scalar_(vals + ii, n - ii, op, value);
+}
+
+__attribute__((target("sse4.1")))
+void bool_op_words_sse_(const uint64_t* a, BoolOp op, const uint64_t* b, uint64_t* out,
+    size_t n) {
+  __m128i ones = _mm_set1_epi32(-1);
+  size_t ii = 0;
+  for (; ii + 2 <= n; ii += 2) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + ii));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + ii));
+    __m128i result;
+    switch (op) {
+      case BoolOp::And: result = _mm_and_si128(va, vb); break;
+      case BoolOp::Or: result = _mm_or_si128(va, vb); break;
+      case BoolOp::Not: result = _mm_xor_si128(va, ones); break;
+    }
+    _mm_storeu_si128((__m128i*)(out + ii), result);
+  }
+  bool_op_words_scalar_(a + ii, op, b + ii, out + ii, n - ii);
+}
+
+/********************************* AVX2 *********************************/
+
+__attribute__((target("avx2")))
+__m256d compare_avx_(__m256d vals, CmpOp op, __m256d value) {
+  switch (op) {
+    case CmpOp::Lt: return _mm256_cmp_pd(vals, value, _CMP_LT_OQ);
+    case CmpOp::Le: return _mm256_cmp_pd(vals, value, _CMP_LE_OQ);
+    case CmpOp::Gt: return _mm256_cmp_pd(vals, value, _CMP_GT_OQ);
+    case CmpOp::Ge: return _mm256_cmp_pd(vals, value, _CMP_GE_OQ);
+    case CmpOp::Eq: return _mm256_cmp_pd(vals, value, _CMP_EQ_OQ);
+    case CmpOp::Ne: return _mm256_cmp_pd(vals, value, _CMP_NEQ_UQ);
+  }
+  assert(0);
+}
+
+__attribute__((target("avx2")))
+long sum_ints_avx_(const int* vals, size_t n) {
+  __m256i acc = _mm256_setzero_si256(); // 4 x int64
+  size_t ii = 0;
+  for (; ii + 8 <= n; ii += 8) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(vals + ii));
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  long lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_ints_scalar_(vals + ii, n - ii);
+}
+
+__attribute__((target("avx2")))
+double sum_doubles_avx_(const double* vals, size_t n) {
+  __m256d acc = _mm256_setzero_pd();
+  size_t ii = 0;
+  for (; ii + 4 <= n; ii += 4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(vals + ii));
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_doubles_scalar_(vals + ii, n - ii);
+}
+
+__attribute__((target("avx2")))
+int min_ints_avx_(const int* vals, size_t n) {
+  if (n < 8) return min_ints_scalar_(vals, n);
+  __m256i acc = _mm256_loadu_si256((const __m256i*)vals);
+  size_t ii = 8;
+  for (; ii + 8 <= n; ii += 8)
+    acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i*)(vals + ii)));
+  int lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  int result = min_ints_scalar_(lanes, 8);
+  return ii < n ? std::min(result, min_ints_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("avx2")))
+int max_ints_avx_(const int* vals, size_t n) {
+  if (n < 8) return max_ints_scalar_(vals, n);
+  __m256i acc = _mm256_loadu_si256((const __m256i*)vals);
+  size_t ii = 8;
+  for (; ii + 8 <= n; ii += 8)
+    acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i*)(vals + ii)));
+  int lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  int result = max_ints_scalar_(lanes, 8);
+  return ii < n ? std::max(result, max_ints_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("avx2")))
+double min_doubles_avx_(const double* vals, size_t n) {
+  if (n < 4) return min_doubles_scalar_(vals, n);
+  __m256d acc = _mm256_loadu_pd(vals);
+  size_t ii = 4;
+  for (; ii + 4 <= n; ii += 4) acc = _mm256_min_pd(acc, _mm256_loadu_pd(vals + ii));
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  double result = min_doubles_scalar_(lanes, 4);
+  return ii < n ? std::min(result, min_doubles_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("avx2")))
+double max_doubles_avx_(const double* vals, size_t n) {
+  if (n < 4) return max_doubles_scalar_(vals, n);
+  __m256d acc = _mm256_loadu_pd(vals);
+  size_t ii = 4;
+  for (; ii + 4 <= n; ii += 4) acc = _mm256_max_pd(acc, _mm256_loadu_pd(vals + ii));
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  double result = max_doubles_scalar_(lanes, 4);
+  return ii < n ? std::max(result, max_doubles_scalar_(vals + ii, n - ii)) : result;
+}
+
+__attribute__((target("avx2")))
+size_t count_if_ints_avx_(const int* vals, size_t n, CmpOp op, double value) {
+  __m256d bound = _mm256_set1_pd(value);
+  size_t count = 0;
+  size_t ii = 0;
+  for (; ii + 4 <= n; ii += 4) {
+    __m256d v = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(vals + ii)));
+    count += __builtin_popcount(_mm256_movemask_pd(compare_avx_(v, op, bound)));
+  }
+  return count + count_if_ints_scalar_(vals + ii, n - ii, op, value);
+}
+
+__attribute__((target("avx2")))
+size_t count_if_doubles_avx_(const double* vals, size_t n, CmpOp op, double value) {
+  __m256d bound = _mm256_set1_pd(value);
+  size_t count = 0;
+  size_t ii = 0;
+  for (; ii + 4 <= n; ii += 4) {
+    __m256d v = _mm256_loadu_pd(vals + ii);
+    count += __builtin_popcount(_mm256_movemask_pd(compare_avx_(v, op, bound)));
+  }
+  return count + count_if_doubles_scalar_(vals + ii, n - ii, op, value);
+}
+
+__attribute__((target("avx2")))
+void bool_op_words_avx_(const uint64_t* a, BoolOp op, const uint64_t* b, uint64_t* out,
+    size_t n) {
+  __m256i ones = _mm256_set1_epi32(-1);
+  size_t ii = 0;
+  for (; ii + 4 <= n; ii += 4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + ii));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + ii));
+    __m256i result;
+    switch (op) {
+      case BoolOp::And: result = _mm256_and_si256(va, vb); break;
+      case BoolOp::Or: result = _mm256_or_si256(va, vb); break;
+      case BoolOp::Not: result = _mm256_xor_si256(va, ones); break;
+    }
+    _mm256_storeu_si256((__m256i*)(out + ii), result);
+  }
+  bool_op_words_scalar_(a + ii, op, b + ii, out + ii, n - ii);
+}
+
+#endif
+
+/******************************* Dispatch *******************************/
+
+#ifdef KERNELS_X86
+#define DISPATCH_KERNEL_(name, ...) \
+  switch (simd_level()) { \
+    case SimdLevel::Avx2: return name##_avx_(__VA_ARGS__); \
+    case SimdLevel::Sse41: return name##_sse_(__VA_ARGS__); \
+    default: return name##_scalar_(__VA_ARGS__); \
+  }
+#else
+#define DISPATCH_KERNEL_(name, ...) return name##_scalar_(__VA_ARGS__);
+#endif
+
+long sum_ints(const int* vals, size_t n) { DISPATCH_KERNEL_(sum_ints, vals, n) }
+
+double sum_doubles(const double* vals, size_t n) { DISPATCH_KERNEL_(sum_doubles, vals, n) }
+
+/** The min and max kernels need at least one element. */
+int min_ints(const int* vals, size_t n) { assert(n > 0); DISPATCH_KERNEL_(min_ints, vals, n) }
+
+int max_ints(const int* vals, size_t n) { assert(n > 0); DISPATCH_KERNEL_(max_ints, vals, n) }
+
+double min_doubles(const double* vals, size_t n) {
+  assert(n > 0);
+  DISPATCH_KERNEL_(min_doubles, vals, n)
+}
+
+double max_doubles(const double* vals, size_t n) {
+  assert(n > 0);
+  DISPATCH_KERNEL_(max_doubles, vals, n)
+}
+
+size_t count_if_ints(const int* vals, size_t n, CmpOp op, double value) {
+  DISPATCH_KERNEL_(count_if_ints, vals, n, op, value)
+}
+
+size_t count_if_doubles(const double* vals, size_t n, CmpOp op, double value) {
+  DISPATCH_KERNEL_(count_if_doubles, vals, n, op, value)
+}
+
+/** Number of set bits among the first n of a BoolArray's words, whose unused bits are zero. */
+size_t count_bits(const uint64_t* bits, size_t n) {
+  size_t count = 0;
+  for (size_t ii = 0; ii < BoolArray::words_for_(n); ii++) count += __builtin_popcountll(bits[ii]);
+  return count;
+}
+
+/** Number of strings of the chunk equal to value. A dictionary encoded chunk is counted on its
+  * codes, without comparing a single string when value is not in its dictionary, and a blob on its
+  * bytes. */
+size_t count_equal_strings(StringArray* strings, String* value) {
+  DictStringArray* dict = dynamic_cast<DictStringArray*>(strings);
+  if (dict != nullptr) {
+    int code = dict->code_of(value);
+    return code == -1 ? 0 : count_if_ints(dict->codes(), dict->length(), CmpOp::Eq, code);
+  }
+  size_t count = 0;
+  BlobStringArray* blob = dynamic_cast<BlobStringArray*>(strings);
+  if (blob != nullptr) {
+    for (size_t ii = 0; ii < blob->length(); ii++)
+      count += blob->chars_equal(ii, value->c_str(), value->size());
+    return count;
+  }
+  for (size_t ii = 0; ii < strings->length(); ii++) {
+    String* str = strings->get(ii);
+    if (str != nullptr && str->equals(value)) count++;
+  }
+  return count;
+}
+
+/** Pushes the index of every string of the chunk equal to value onto rows, comparing strings as
+  * count_equal_strings does. A dictionary encoded chunk whose dictionary lacks value is skipped
+  * after a single lookup. */
+void equal_strings_rows(StringArray* strings, String* value, IntArray* rows) {
+  DictStringArray* dict = dynamic_cast<DictStringArray*>(strings);
+  if (dict != nullptr) {
+    int code = dict->code_of(value);
+    if (code == -1) return;
+    int* codes = dict->codes();
+    for (size_t ii = 0; ii < dict->length(); ii++)
+      if (codes[ii] == code) rows->push((int)ii);
+    return;
+  }
+  BlobStringArray* blob = dynamic_cast<BlobStringArray*>(strings);
+  if (blob != nullptr) {
+    for (size_t ii = 0; ii < blob->length(); ii++)
+      if (blob->chars_equal(ii, value->c_str(), value->size())) rows->push((int)ii);
+    return;
+  }
+  for (size_t ii = 0; ii < strings->length(); ii++) {
+    String* str = strings->get(ii);
+    if (str != nullptr && str->equals(value)) rows->push((int)ii);
+  }
+}
+
+/** Number of true elements of the chunk, a popcount per word. */
+size_t count_true(BoolArray* bools) { return count_bits(bools->bits_, bools->length()); }
+
+/** out[ii] = a[ii] op b[ii] over n words, b is not read by Not and may be a. */
+void bool_op_words(const uint64_t* a, BoolOp op, const uint64_t* b, uint64_t* out, size_t n) {
+  DISPATCH_KERNEL_(bool_op_words, a, op, b, out, n)
+}
+
+/** Element wise a op b of two chunks of the same length, a word at a time. An element missing
+  * from either chunk is missing from the result, and false like every missing bool. The caller
+  * owns the returned chunk. */
+BoolArray* bool_op(BoolArray* a, BoolOp op, BoolArray* b) {
+  assert(op == BoolOp::Not || a->length() == b->length());
+  size_t n = a->length();
+  BoolArray* result = new BoolArray(max(n, 1));
+  const uint64_t* other = op == BoolOp::Not ? a->bits_ : b->bits_;
+  bool_op_words(a->bits_, op, other, result->bits_, BoolArray::words_for_(n));
+  // The bits past the last element must stay zero
+  if (n % 64 != 0) result->bits_[n / 64] &= ((uint64_t)1 << (n % 64)) - 1;
+  result->count_ = n;
+  if (a->num_missing() > 0 || (op != BoolOp::Not && b->num_missing() > 0)) {
+    for (size_t ii = 0; ii < n; ii++) {
+      if (!a->is_missing(ii) && (op == BoolOp::Not || !b->is_missing(ii))) continue;
+      result->set_missing(ii);
+      result->set_bit_(ii, false);
+    }
+  }
+  return result;
+}
+
+// Aggregations computed over a column
+enum class AggOp { Sum, Min, Max, Count, Mean, CountIf };
+
+/**
+ * Aggregate::
+ * Partial result of an aggregation over some of the chunks of an I, D or B column. The partials
+ * of disjoint sets of chunks combine into the result over all of them, in any order. Bools count
+ * as 0 and 1. The min and max of no element are infinity and -infinity.
+ * Authors: Kaylin Devchand & Cristian Stransky
+ */
+class Aggregate : public Object {
+  public:
+  AggOp op_;
+  CmpOp cmp_; // predicate of CountIf
+  double value_;
+  size_t count_; // elements seen, or matching the predicate for CountIf
+  double sum_;
+  double min_;
+  double max_;
+
+  Aggregate(AggOp op, CmpOp cmp, double value) {
+    op_ = op;
+    cmp_ = cmp;
+    value_ = value;
+    count_ = 0;
+    sum_ = 0;
+    min_ = INFINITY;
+    max_ = -INFINITY;
+  }
+
+  Aggregate(AggOp op) : Aggregate(op, CmpOp::Eq, 0) {}
+
+  Aggregate(Deserializer& deserializer) {
+    op_ = static_cast<AggOp>(deserializer.deserialize_size_t());
+    cmp_ = static_cast<CmpOp>(deserializer.deserialize_size_t());
+    value_ = deserializer.deserialize_double();
+    count_ = deserializer.deserialize_size_t();
+    sum_ = deserializer.deserialize_double();
+    min_ = deserializer.deserialize_double();
+    max_ = deserializer.deserialize_double();
+  }
+
+  /** A partial of the same aggregation over no element. */
+  Aggregate* clone() { return new Aggregate(op_, cmp_, value_); }
+
+  void add_ints_(const int* vals, size_t n) {
+    switch (op_) {
+      case AggOp::Sum: sum_ += sum_ints(vals, n); break;
+      case AggOp::Min: min_ = std::min(min_, (double)min_ints(vals, n)); break;
+      case AggOp::Max: max_ = std::max(max_, (double)max_ints(vals, n)); break;
+      case AggOp::Count: count_ += n; break;
+      case AggOp::Mean: sum_ += sum_ints(vals, n); count_ += n; break;
+      case AggOp::CountIf: count_ += count_if_ints(vals, n, cmp_, value_); break;
+    }
+  }
+
+  void add_doubles_(const double* vals, size_t n) {
+    switch (op_) {
+      case AggOp::Sum: sum_ += sum_doubles(vals, n); break;
+      case AggOp::Min: min_ = std::min(min_, min_doubles(vals, n)); break;
+      case AggOp::Max: max_ = std::max(max_, max_doubles(vals, n)); break;
+      case AggOp::Count: count_ += n; break;
+      case AggOp::Mean: sum_ += sum_doubles(vals, n); count_ += n; break;
+      case AggOp::CountIf: count_ += count_if_doubles(vals, n, cmp_, value_); break;
+    }
+  }
+
+  void add_bools_(BoolArray* bools) {
+    size_t n = bools->length();
+    size_t num_true = count_bits(bools->bits_, n);
+    switch (op_) {
+      case AggOp::Sum: sum_ += num_true; break;
+      case AggOp::Min: min_ = std::min(min_, num_true == n ? 1.0 : 0.0); break;
+      case AggOp::Max: max_ = std::max(max_, num_true > 0 ? 1.0 : 0.0); break;
+      case AggOp::Count: count_ += n; break;
+      case AggOp::Mean: sum_ += num_true; count_ += n; break;
+      case AggOp::CountIf:
+        count_ += (compare(1, cmp_, value_) ? num_true : 0) + (compare(0, cmp_, value_) ? n - num_true : 0);
+        break;
+    }
+  }
+
+  /** Adds a chunk of a column of the given type. Its missing elements, which hold 0 or false, are
+    * left out: they add nothing to a sum and are taken back out of the counts, while the min and
+    * max are taken over every run of elements between them. */
+  void add_chunk(Array* chunk, char type) {
+    if (chunk->length() == 0) return;
+    if (chunk->num_missing() > 0) {
+      add_with_missing_(chunk, type);
+      return;
+    }
+    switch (type) {
+      case 'I': add_ints_(static_cast<IntArray*>(chunk)->ints_, chunk->length()); break;
+      case 'D': add_doubles_(static_cast<DoubleArray*>(chunk)->doubles_, chunk->length()); break;
+      case 'B': add_bools_(static_cast<BoolArray*>(chunk)); break;
+      default: assert(0); // only numeric columns can be aggregated
+    }
+  }
+
+  void add_with_missing_(Array* chunk, char type) {
+    assert(type == 'I' || type == 'D' || type == 'B'); // only numeric columns can be aggregated
+    size_t missing = chunk->num_missing();
+    size_t n = chunk->length();
+    switch (op_) {
+      case AggOp::Sum: add_chunk_(chunk, type, 0, n); break;
+      case AggOp::Count: count_ += n - missing; break;
+      case AggOp::Mean: add_chunk_(chunk, type, 0, n); count_ -= missing; break;
+      case AggOp::CountIf:
+        add_chunk_(chunk, type, 0, n);
+        if (compare(0, cmp_, value_)) count_ -= missing;
+        break;
+      case AggOp::Min:
+      case AggOp::Max:
+        for (size_t start = 0; start < n; start++) {
+          if (chunk->is_missing(start)) continue;
+          size_t end = start + 1;
+          while (end < n && !chunk->is_missing(end)) end++;
+          add_chunk_(chunk, type, start, end);
+          start = end;
+        }
+        break;
+    }
+  }
+
+  /** Adds elements [start, end) of the chunk as if none was missing. */
+  void add_chunk_(Array* chunk, char type, size_t start, size_t end) {
+    switch (type) {
+      case 'I': add_ints_(static_cast<IntArray*>(chunk)->ints_ + start, end - start); break;
+      case 'D':
+        add_doubles_(static_cast<DoubleArray*>(chunk)->doubles_ + start, end - start);
+        break;
+      case 'B': {
+        BoolArray* bools = static_cast<BoolArray*>(chunk);
+        if (start == 0 && end == bools->length()) {
+          add_bools_(bools);
+          break;
+        }
+        BoolArray run(end - start);
+        for (size_t ii = start; ii < end; ii++) run.push(bools->get(ii));
+        add_bools_(&run);
+        break;
+      }
+    }
+  }
+
+  /** Adds the partial of other chunks. */
+  void combine(Aggregate& other) {
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  double result() {
+    switch (op_) {
+      case AggOp::Sum: return sum_;
+      case AggOp::Min: return min_;
+      case AggOp::Max: return max_;
+      case AggOp::Mean: return count_ == 0 ? NAN : sum_ / count_;
+      default: return count_;
+    }
+  }
+
+  size_t serial_len() {
+    return sizeof(size_t) // op_
+      + sizeof(size_t) // cmp_
+      + sizeof(double) // value_
+      + sizeof(size_t) // count_
+      + sizeof(double) * 3; // sum_, min_ and max_
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_size_t(static_cast<size_t>(op_));
+    serializer.serialize_size_t(static_cast<size_t>(cmp_));
+    serializer.serialize_double(value_);
+    serializer.serialize_size_t(count_);
+    serializer.serialize_double(sum_);
+    serializer.serialize_double(min_);
+    serializer.serialize_double(max_);
+    return serializer.get_serial();
+  }
+};
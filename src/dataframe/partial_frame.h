@@ -0,0 +1,119 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <atomic>
+
+#include "dataframe_builder.h"
+
+/** Number of the next builder writing part of a frame in this process. */
+size_t next_frame_part_() {
+  static std::atomic<size_t> next_part(0);
+  return next_part++;
+}
+
+/*******************************************************************************
+ *  PartialFrame::
+ *  The rows one clone of a shipped rower writes towards a frame, through a
+ *  DataFrameBuilder pinned to a given node. Partial frames of the clones are
+ *  appended in join order, so only the keys of their chunks travel back to the
+ *  caller. Used by FilterRower, PartitionRower and JoinRower.
+ */
+class PartialFrame : public Object {
+ public:
+  String* name_; // owned, prefix of the keys of the chunks
+  Schema schema_;
+  KV_Store* kv_; // not owned, store of the node the rows are written from
+  size_t home_node_;
+  DataFrameBuilder* builder_; // owned, created on the first row
+  DataFrame* result_; // owned until taken, rows of finished builders
+
+  PartialFrame(String* name, Schema& schema, KV_Store* kv, size_t home_node) : schema_(schema) {
+    name_ = name->clone();
+    kv_ = kv;
+    home_node_ = home_node;
+    builder_ = nullptr;
+    result_ = nullptr;
+  }
+
+  /** The home node is not part of the serial, it depends on where the frame is deserialized. */
+  PartialFrame(Deserializer& deserializer, KV_Store* kv, size_t home_node)
+      : schema_(deserializer) {
+    name_ = new String(deserializer);
+    kv_ = kv;
+    home_node_ = home_node;
+    builder_ = nullptr;
+    result_ = deserializer.deserialize_bool() ? new DataFrame(deserializer, kv) : nullptr;
+  }
+
+  ~PartialFrame() {
+    delete name_;
+    delete builder_;
+    delete result_;
+  }
+
+  DataFrameBuilder* builder_on_() {
+    if (builder_ == nullptr) {
+      String part_name(*name_);
+      part_name.concat("_n");
+      part_name.concat(kv_->get_node_index());
+      part_name.concat("_p");
+      part_name.concat(next_frame_part_());
+      builder_ = new DataFrameBuilder(schema_, &part_name, kv_);
+      builder_->pin_to_node(home_node_);
+    }
+    return builder_;
+  }
+
+  void add_row(Row& row) { builder_on_()->add_row(row); }
+
+  /** Appends the partial frame after the rows written so far and deletes it. */
+  void append_(DataFrame* part) {
+    if (result_ == nullptr) {
+      result_ = part;
+    } else {
+      result_->append_chunks(*part);
+      delete part;
+    }
+  }
+
+  /** Flushes the rows still buffered by the builder. */
+  void finish_() {
+    if (builder_ == nullptr) return;
+    append_(builder_->done());
+    delete builder_;
+    builder_ = nullptr;
+  }
+
+  /** Appends the rows of the other partial frame after those of this one. */
+  void join(PartialFrame& other) {
+    finish_();
+    other.finish_();
+    if (other.result_ != nullptr) append_(other.take());
+  }
+
+  /** Returns the frame of the rows written, owned by the caller. */
+  DataFrame* take() {
+    finish_();
+    DataFrame* result = result_ ? result_ : new DataFrame(schema_, kv_);
+    result_ = nullptr;
+    return result;
+  }
+
+  // Buffered rows are flushed first, the serial carries the chunk keys of the rows only
+  size_t serial_len() {
+    finish_();
+    return schema_.serial_len()
+      + name_->serial_len()
+      + sizeof(bool)
+      + (result_ ? result_->serial_len() : 0);
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(&schema_);
+    serializer.serialize_object(name_);
+    serializer.serialize_bool(result_ != nullptr);
+    if (result_ != nullptr) serializer.serialize_object(result_);
+    return serializer.get_serial();
+  }
+};
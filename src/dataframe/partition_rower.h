@@ -0,0 +1,122 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "fields.h"
+#include "partial_frame.h"
+#include "rower_registry.h"
+#include "sort_key.h"
+
+/*******************************************************************************
+ *  PartitionRower::
+ *  Splits the rows of the batches it is given into num_parts partial frames by
+ *  the hash of a key column. Partition p is homed on node p, so the rows of two
+ *  frames partitioned the same way with the same number of parts meet on one
+ *  node. Rows with a missing key are dropped. Given Splitters, the rows are
+ *  split by range instead, partition p then holding range p of the sort.
+ */
+class PartitionRower : public BatchRower {
+ public:
+  String* name_; // owned, prefix of the names of the parts
+  size_t col_;
+  size_t num_parts_;
+  Splitters* splitters_; // owned, nullptr to split by hash
+  PartialFrame** parts_; // owned
+  Row* row_; // owned, borrows the strings of the batch
+
+  /** The splitters are cloned. */
+  PartitionRower(String* name, Schema& schema, size_t col, size_t num_parts, KV_Store* kv,
+      Splitters* splitters = nullptr) {
+    name_ = name->clone();
+    col_ = col;
+    num_parts_ = num_parts;
+    splitters_ = splitters ? splitters->clone() : nullptr;
+    parts_ = new PartialFrame*[num_parts_];
+    for (size_t ii = 0; ii < num_parts_; ii++) {
+      String part_name(*name);
+      part_name.concat('_');
+      part_name.concat(ii);
+      parts_[ii] = new PartialFrame(&part_name, schema, kv, ii);
+    }
+    row_ = new Row(schema, true);
+  }
+
+  PartitionRower(Deserializer& deserializer, KV_Store* kv) {
+    name_ = new String(deserializer);
+    col_ = deserializer.deserialize_size_t();
+    num_parts_ = deserializer.deserialize_size_t();
+    splitters_ = deserializer.deserialize_bool() ? new Splitters(deserializer) : nullptr;
+    parts_ = new PartialFrame*[num_parts_];
+    for (size_t ii = 0; ii < num_parts_; ii++) parts_[ii] = new PartialFrame(deserializer, kv, ii);
+    row_ = new Row(parts_[0]->schema_, true);
+  }
+
+  ~PartitionRower() {
+    delete name_;
+    delete splitters_;
+    for (size_t ii = 0; ii < num_parts_; ii++) delete parts_[ii];
+    delete[] parts_;
+    delete row_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new PartitionRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    Array* keys = batch.chunks_[col_];
+    char type = batch.col_type(col_);
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      if (splitters_ == nullptr && is_null_field_(keys, ii)) continue;
+      batch.fill_row(ii, *row_);
+      size_t part = splitters_ ? splitters_->part_of(batch.chunks_, ii)
+        : field_hash_(keys, type, ii) % num_parts_;
+      parts_[part]->add_row(*row_);
+    }
+  }
+
+  BatchRower* clone() {
+    return new PartitionRower(name_, parts_[0]->schema_, col_, num_parts_, parts_[0]->kv_,
+      splitters_);
+  }
+
+  void join_delete(BatchRower* other) {
+    PartitionRower* partition_rower = dynamic_cast<PartitionRower*>(other);
+    for (size_t ii = 0; ii < num_parts_; ii++) parts_[ii]->join(*partition_rower->parts_[ii]);
+    delete other;
+  }
+
+  /** Returns the frame of every partition appended in partition order, owned by the caller. Its
+    * chunks are homed on the node of their partition. */
+  DataFrame* take() {
+    DataFrame* result = parts_[0]->take();
+    for (size_t ii = 1; ii < num_parts_; ii++) {
+      DataFrame* part = parts_[ii]->take();
+      result->append_chunks(*part);
+      delete part;
+    }
+    return result;
+  }
+
+  const char* registered_name() { return "PartitionRower"; }
+
+  size_t serial_len() {
+    size_t len = name_->serial_len() + sizeof(size_t) + sizeof(size_t) + sizeof(bool)
+      + (splitters_ ? splitters_->serial_len() : 0);
+    for (size_t ii = 0; ii < num_parts_; ii++) len += parts_[ii]->serial_len();
+    return len;
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(name_);
+    serializer.serialize_size_t(col_);
+    serializer.serialize_size_t(num_parts_);
+    serializer.serialize_bool(splitters_ != nullptr);
+    if (splitters_ != nullptr) serializer.serialize_object(splitters_);
+    for (size_t ii = 0; ii < num_parts_; ii++) serializer.serialize_object(parts_[ii]);
+    return serializer.get_serial();
+  }
+};
+
+bool partition_rower_registered_ = (rower_registry().add("PartitionRower",
+  static_cast<BatchRowerFactory>(PartitionRower::deserialize)), true);
@@ -0,0 +1,146 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "fields.h"
+
+/*******************************************************************************
+ *  Placement::
+ *  Picks the home nodes of the chunks a DataFrameBuilder builds. Chunk
+ *  placements home every chunk as a whole given its index, row placements
+ *  send every row to the node its fields pick, the builder then building the
+ *  chunks of every node apart. Every placement is one or the other, see
+ *  ChunkPlacement and RowPlacement, and DataFrameBuilder::set_placement.
+ */
+class Placement : public Object {
+ public:
+  /** Whether rows are placed one at a time, see RowPlacement, or chunks, see ChunkPlacement. */
+  virtual bool by_row() = 0;
+
+  virtual Placement* clone() = 0;
+};
+
+/** A placement of whole chunks. */
+class ChunkPlacement : public Placement {
+ public:
+  bool by_row() { return false; }
+
+  /** Home node of the chunk_index-th chunk of a frame built on local_node, out of num_nodes. */
+  virtual size_t node_of_chunk(size_t chunk_index, size_t num_nodes, size_t local_node) = 0;
+};
+
+/** A placement of every row on its own. */
+class RowPlacement : public Placement {
+ public:
+  bool by_row() { return true; }
+
+  /** Home node of the chunk the row is added to, out of num_nodes. */
+  virtual size_t node_of_row(Row& row, size_t num_nodes) = 0;
+};
+
+/** Spreads the chunks over every node in turn, the default. */
+class RoundRobinPlacement : public ChunkPlacement {
+ public:
+  size_t node_of_chunk(size_t chunk_index, size_t num_nodes, size_t local_node) {
+    return chunk_index % num_nodes;
+  }
+
+  Placement* clone() { return new RoundRobinPlacement(); }
+};
+
+/** Homes every chunk on the node that builds it, e.g. to keep the rows a node produces there. */
+class LocalPlacement : public ChunkPlacement {
+ public:
+  size_t node_of_chunk(size_t chunk_index, size_t num_nodes, size_t local_node) {
+    return local_node;
+  }
+
+  Placement* clone() { return new LocalPlacement(); }
+};
+
+/** Homes every chunk on the given node. */
+class PinnedPlacement : public ChunkPlacement {
+ public:
+  size_t node_;
+
+  PinnedPlacement(size_t node) { node_ = node; }
+
+  size_t node_of_chunk(size_t chunk_index, size_t num_nodes, size_t local_node) { return node_; }
+
+  Placement* clone() { return new PinnedPlacement(node_); }
+};
+
+/** Spreads the chunks over the nodes in proportion to their capacities, one per node. Every
+  * cycle of as many chunks as the capacities add up to homes capacity p of them on node p. */
+class WeightedPlacement : public ChunkPlacement {
+ public:
+  IntArray* capacities_; // owned
+
+  /** The capacities are copied. */
+  WeightedPlacement(IntArray& capacities) {
+    capacities_ = capacities.clone();
+    for (size_t ii = 0; ii < capacities_->length(); ii++) assert(capacities_->get(ii) >= 0);
+    assert(total_() > 0);
+  }
+
+  ~WeightedPlacement() { delete capacities_; }
+
+  size_t total_() {
+    size_t total = 0;
+    for (size_t ii = 0; ii < capacities_->length(); ii++) total += capacities_->get(ii);
+    return total;
+  }
+
+  size_t node_of_chunk(size_t chunk_index, size_t num_nodes, size_t local_node) {
+    assert(capacities_->length() == num_nodes);
+    size_t position = chunk_index % total_();
+    size_t node = 0;
+    while (position >= (size_t)capacities_->get(node)) position -= capacities_->get(node++);
+    return node;
+  }
+
+  Placement* clone() { return new WeightedPlacement(*capacities_); }
+};
+
+/** Homes every row on the node its value in a column hashes to, as PartitionRower does, so frames
+  * placed on columns of equal values are co-partitioned and join or group on them locally. */
+class HashPlacement : public RowPlacement {
+ public:
+  size_t col_;
+
+  HashPlacement(size_t col) { col_ = col; }
+
+  size_t node_of_row(Row& row, size_t num_nodes) { return row_field_hash_(row, col_) % num_nodes; }
+
+  Placement* clone() { return new HashPlacement(col_); }
+};
+
+/** Homes every row by the range its value in a column falls in: node p holds the values after
+  * bound p - 1 and up to bound p, the last node those after every bound. Missing values come
+  * first. */
+class RangePlacement : public RowPlacement {
+ public:
+  size_t col_;
+  Array* bounds_; // owned, ascending, of the type of the column
+
+  /** The bounds are copied. */
+  RangePlacement(size_t col, Array& bounds) {
+    col_ = col;
+    bounds_ = bounds.clone();
+  }
+
+  ~RangePlacement() { delete bounds_; }
+
+  size_t node_of_row(Row& row, size_t num_nodes) {
+    assert(bounds_->length() < num_nodes);
+    size_t low = 0;
+    size_t high = bounds_->length();
+    while (low < high) {
+      size_t mid = (low + high) / 2;
+      if (compare_row_field_(row, col_, bounds_, mid) > 0) low = mid + 1;
+      else high = mid;
+    }
+    return low;
+  }
+
+  Placement* clone() { return new RangePlacement(col_, *bounds_); }
+};
@@ -0,0 +1,166 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "../helpers/array.h"
+#include "../kv_store/kv_store.h"
+#include "../kv_store/key_array.h"
+#include "chunk_cache.h"
+
+// Read-ahead depth of every Column unless changed, 0 turns read-ahead off
+const size_t DEFAULT_READ_AHEAD = 2;
+// Every chunk in flight holds a connection to its home node, which only accepts MAX_CLIENTS
+const size_t MAX_READ_AHEAD = 4;
+
+/**
+ * A chunk being fetched from its home node on a background thread.
+ */
+class PendingChunk : public Object {
+  public:
+  size_t chunk_index_;
+  Array* chunk_; // owned until taken, written by thread_
+  std::atomic<bool> done_;
+  std::thread thread_;
+
+  PendingChunk(size_t chunk_index, KV_Store* kv, Key* key, char type) {
+    chunk_index_ = chunk_index;
+    chunk_ = nullptr;
+    done_ = false;
+    thread_ = std::thread(&PendingChunk::fetch_, this, kv, key->clone(), type);
+  }
+
+  ~PendingChunk() {
+    if (thread_.joinable()) thread_.join();
+    delete chunk_;
+  }
+
+  void fetch_(KV_Store* kv, Key* key, char type) {
+    chunk_ = kv->get_array(key, type);
+    delete key;
+    done_ = true;
+  }
+
+  bool is_done() { return done_; }
+
+  /** Waits for the fetch to finish and hands the chunk over to the caller. */
+  Array* take() {
+    thread_.join();
+    Array* chunk = chunk_;
+    chunk_ = nullptr;
+    return chunk;
+  }
+};
+
+/**
+ * ReadAhead::
+ * Detects sequential scans over the chunks of a Column and fetches the next depth_ remote chunks
+ * in the background while the current one is processed. Local chunks, including replicas of remote
+ * ones, are never read ahead, they are only a deserialization away.
+ *
+ * The stats describe the current scan and are reset by reset_stats(): stalls_ counts remote
+ * chunks that had to be fetched synchronously, hidden_ the ones that were already there when the
+ * scan reached them, partially_hidden_ the ones still in flight that the scan had to wait on, and
+ * dropped_ the ones a jump of the scan left outside its window, which are discarded.
+ * Authors: Kaylin Devchand & Cristian Stransky
+ */
+class ReadAhead : public Object {
+  public:
+  Array pending_; // PendingChunk*, owned
+  size_t depth_;
+  size_t last_chunk_;
+  size_t issued_;
+  size_t hidden_;
+  size_t partially_hidden_;
+  size_t stalls_;
+  size_t dropped_;
+
+  ReadAhead(size_t depth) : pending_('O', MAX_READ_AHEAD) {
+    set_depth(depth);
+    last_chunk_ = -1;
+    reset_stats();
+  }
+
+  void set_depth(size_t depth) { depth_ = min(depth, MAX_READ_AHEAD); }
+
+  size_t get_depth() { return depth_; }
+
+  void reset_stats() {
+    issued_ = 0;
+    hidden_ = 0;
+    partially_hidden_ = 0;
+    stalls_ = 0;
+    dropped_ = 0;
+  }
+
+  PendingChunk* get_pending_(size_t ii) { return static_cast<PendingChunk*>(pending_.get(ii).o); }
+
+  bool is_pending_(size_t chunk_index) {
+    for (size_t ii = 0; ii < pending_.length(); ii++)
+      if (get_pending_(ii)->chunk_index_ == chunk_index) return true;
+    return false;
+  }
+
+  /** Returns the chunk if it was read ahead, nullptr otherwise. The caller owns the chunk. */
+  Array* take(size_t chunk_index) {
+    for (size_t ii = 0; ii < pending_.length(); ii++) {
+      PendingChunk* pending = get_pending_(ii);
+      if (pending->chunk_index_ == chunk_index) {
+        if (pending->is_done()) hidden_++;
+        else partially_hidden_++;
+        pending_.remove(ii);
+        Array* chunk = pending->take();
+        delete pending;
+        return chunk;
+      }
+    }
+    return nullptr;
+  }
+
+  void record_stall() { stalls_++; }
+
+  /** Waits for and discards the fetches outside the window following the chunk, left over from a
+    * scan that jumped or stopped, so they do not hold the slots of the window forever. */
+  void drop_stale_(size_t chunk_index) {
+    for (size_t ii = 0; ii < pending_.length();) {
+      PendingChunk* pending = get_pending_(ii);
+      size_t index = pending->chunk_index_;
+      if (index > chunk_index && index <= chunk_index + depth_) {
+        ii++;
+        continue;
+      }
+      pending_.remove(ii);
+      delete pending;
+      dropped_++;
+    }
+  }
+
+  /** Called on every switch to a new chunk, issues fetches once two chunks were read in order. */
+  void advance(size_t chunk_index, KeyArray* keys, KV_Store* kv, char type, ChunkCache* remote_cache) {
+    drop_stale_(chunk_index);
+    bool sequential = last_chunk_ + 1 == chunk_index;
+    last_chunk_ = chunk_index;
+    if (!sequential) return;
+    size_t local_node = kv->get_node_index();
+    for (size_t ii = chunk_index + 1; ii < keys->length() && ii <= chunk_index + depth_; ii++) {
+      if (pending_.length() >= depth_) return;
+      Key* key = keys->get(ii);
+      if (key->is_on(local_node, kv->get_num_other_nodes()) || remote_cache->contains(ii)
+          || is_pending_(ii))
+        continue;
+      pending_.push(object_to_payload(new PendingChunk(ii, kv, key, type)));
+      issued_++;
+    }
+  }
+
+  size_t issued() { return issued_; }
+
+  size_t hidden() { return hidden_; }
+
+  size_t partially_hidden() { return partially_hidden_; }
+
+  size_t stalls() { return stalls_; }
+
+  size_t dropped() { return dropped_; }
+};
@@ -9,17 +9,27 @@
  * This class represents a single row of data constructed according to a
  * dataframe's schema. The purpose of this class is to make it easier to add
  * read/write complete rows. Internally a dataframe hold data in columns.
- * Rows have pointer equality.
+ * Rows have pointer equality. A field can be missing, it then reads as the
+ * default of its type, or nullptr for a string, until it is set again.
+ * A borrowing row keeps the strings it is set with instead of copies, e.g.
+ * those of the chunks a data frame fills it from. They have to outlive
+ * their use through the row.
  */
 class Row : public Object {
   public:
 
-  // list of columns with only one element each
+  // list of columns with only one element each, missing fields are marked missing in it
   Array* cells_;
   Schema schema_;
+  bool* projected_; // owned, nullptr when every column can be read
+  bool borrows_; // whether the strings of cells_ are not owned
  
   /** Build a row following a schema. */
-  Row(Schema& scm) : schema_(scm) {
+  Row(Schema& scm) : Row(scm, false) { }
+
+  Row(Schema& scm, bool borrows) : schema_(scm) {
+    projected_ = nullptr;
+    borrows_ = borrows;
     size_t width = schema_.width();
     // Array is simply an IntArray to avoid bad deletes. Type handling is now done by the Schema.
     cells_ = new Array('I', width);
@@ -28,63 +38,133 @@ class Row : public Object {
         case 'I': cells_->push(int_to_payload(DEFAULT_INT_VALUE)); break;
         case 'D': cells_->push(double_to_payload(DEFAULT_DOUBLE_VALUE)); break;
         case 'B': cells_->push(bool_to_payload(DEFAULT_BOOL_VALUE)); break;
-        case 'S': cells_->push(object_to_payload(DEFAULT_STRING_VALUE.clone())); break;
+        case 'S': cells_->push(object_to_payload(default_string_())); break;
       }
   }
 
   ~Row() {
-    for (size_t ii = 0; ii < schema_.width(); ii++)
+    for (size_t ii = 0; ii < schema_.width() && !borrows_; ii++)
       if (schema_.col_type(ii) == 'S')
         delete cells_->get(ii).o;
     delete cells_;
+    delete[] projected_;
+  }
+
+  /** Restricts the row to the given columns, as when a data frame only fills those. Reading any
+    * other column is an error. */
+  void project(IntArray& cols) {
+    if (projected_ == nullptr) projected_ = new bool[::max(schema_.width(), 1)];
+    for (size_t ii = 0; ii < schema_.width(); ii++) projected_[ii] = false;
+    for (size_t ii = 0; ii < cols.length(); ii++) {
+      assert((size_t)cols.get(ii) < schema_.width());
+      projected_[cols.get(ii)] = true;
+    }
   }
+
+  bool is_projected(size_t col) { return projected_ == nullptr || projected_[col]; }
  
   /** Setters: set the given column with the given value. Setting a column with
     * a value of the wrong type is undefined. */
   void set(size_t col, int val) { 
     assert(schema_.col_type(col) == 'I');
     cells_->replace(col, int_to_payload(val));
+    cells_->set_missing(col, false);
   }
 
   void set(size_t col, double val) {
     assert(schema_.col_type(col) == 'D');
     cells_->replace(col, double_to_payload(val));
+    cells_->set_missing(col, false);
   }
 
   void set(size_t col, bool val) {
     assert(schema_.col_type(col) == 'B');
     cells_->replace(col, bool_to_payload(val));
+    cells_->set_missing(col, false);
   }
 
-  /** Acquire ownership of the string. */
+  /** Copies the string, unless the row borrows it. */
   void set(size_t col, String* val) {
     assert(schema_.col_type(col) == 'S');
-    val = val ? val->clone() : DEFAULT_STRING_VALUE.clone();
+    if (val == nullptr) val = default_string_();
+    else if (!borrows_) val = val->clone();
+    replace_string_(col, val);
+    cells_->set_missing(col, false);
+  }
+
+  /** The string of an empty field, shared by borrowing rows. */
+  String* default_string_() {
+    return borrows_ ? &DEFAULT_STRING_VALUE : DEFAULT_STRING_VALUE.clone();
+  }
+
+  void replace_string_(size_t col, String* val) {
     Payload p = cells_->replace(col, object_to_payload(val));
-    delete p.o;
+    if (!borrows_) delete p.o;
+  }
+
+  /** Returns the string of the field, now owned by the caller, and leaves the field missing. Only
+    * a row owning its strings can give them away. */
+  String* take_string(size_t col) {
+    assert(schema_.col_type(col) == 'S' && !borrows_);
+    String* val = static_cast<String*>(cells_->replace(col, object_to_payload(nullptr)).o);
+    cells_->set_missing(col);
+    return val;
+  }
+
+  bool borrows() { return borrows_; }
+
+  /** Marks the field missing, as a field absent from a file is. */
+  void set_missing(size_t col) {
+    switch (schema_.col_type(col)) {
+      case 'I': cells_->replace(col, int_to_payload(DEFAULT_INT_VALUE)); break;
+      case 'D': cells_->replace(col, double_to_payload(DEFAULT_DOUBLE_VALUE)); break;
+      case 'B': cells_->replace(col, bool_to_payload(DEFAULT_BOOL_VALUE)); break;
+      case 'S': replace_string_(col, nullptr); break;
+    }
+    cells_->set_missing(col);
+  }
+
+  /** Sets the field with the idx-th element of a chunk of the column's type, missing if the
+    * element is. */
+  void set_from_chunk(size_t col, Array* chunk, size_t idx) {
+    if (chunk->is_missing(idx)) {
+      set_missing(col);
+      return;
+    }
+    switch (schema_.col_type(col)) {
+      case 'I': set(col, static_cast<IntArray*>(chunk)->get(idx)); break;
+      case 'D': set(col, static_cast<DoubleArray*>(chunk)->get(idx)); break;
+      case 'B': set(col, static_cast<BoolArray*>(chunk)->get(idx)); break;
+      case 'S': set(col, static_cast<StringArray*>(chunk)->get(idx)); break;
+    }
+  }
+
+  bool is_missing(size_t col) {
+    assert(is_projected(col));
+    return cells_->is_missing(col);
   }
  
   /** Getters: get the value at the given column. If the column is not
     * of the requested type, the result is undefined. */
   int get_int(size_t col) { 
-    assert(schema_.col_type(col) == 'I');
+    assert(schema_.col_type(col) == 'I' && is_projected(col));
     return cells_->get(col).i; 
   }
 
   bool get_bool(size_t col) { 
-    assert(schema_.col_type(col) == 'B');
+    assert(schema_.col_type(col) == 'B' && is_projected(col));
     return cells_->get(col).b; 
   }
 
   double get_double(size_t col) {
-    assert(schema_.col_type(col) == 'D');
+    assert(schema_.col_type(col) == 'D' && is_projected(col));
     return cells_->get(col).d; 
   }
   
   // NOTE: Returns a pointer that can be volatile (if coming from KV store, will overwrite the old
   // cache String pointer, so String address CAN change later), clone if needed longer
   String* get_string(size_t col) {
-    assert(schema_.col_type(col) == 'S');
+    assert(schema_.col_type(col) == 'S' && is_projected(col));
     return static_cast<String*>(cells_->get(col).o);
     
   }
@@ -23,4 +23,105 @@ class Rower : public Object {
   virtual void join_delete(Rower* other) = 0;
 
   virtual Rower* clone() { assert(0); }
+
+  /** Name the rower is registered under in the RowerRegistry, only registered rowers can be
+      shipped to the nodes their chunks live on. Their state travels through serial_len() and
+      serialize(), and is read back by the factory they are registered with. */
+  virtual const char* registered_name() { return nullptr; }
+};
+
+/*******************************************************************************
+ *  RowBatch::
+ *  A run of consecutive rows of a data frame, handed out as the typed chunks of
+ *  each column instead of one Row at a time. Element ii of every column is row
+ *  start() + ii of the data frame. The chunks are on loan from the columns and
+ *  are only valid during the call to BatchRower::accept.
+ */
+class RowBatch : public Object {
+ public:
+  Schema schema_;
+  Array** chunks_; // owned array, chunks not owned
+  size_t start_;
+  size_t length_;
+
+  RowBatch(Schema& schema) : schema_(schema) {
+    chunks_ = new Array*[max(schema_.width(), 1)];
+    for (size_t ii = 0; ii < schema_.width(); ii++) chunks_[ii] = nullptr;
+    start_ = 0;
+    length_ = 0;
+  }
+
+  ~RowBatch() { delete[] chunks_; }
+
+  void set_chunk(size_t col, Array* chunk) { chunks_[col] = chunk; }
+
+  void set_range(size_t start, size_t length) {
+    start_ = start;
+    length_ = length;
+  }
+
+  Array* get_chunk_(size_t col, char type) {
+    assert(schema_.col_type(col) == type && chunks_[col] != nullptr);
+    return chunks_[col];
+  }
+
+  /** Typed views of a column, valid for indexes [0, length()). Columns left out of the
+    * projection of a map have no chunk and may not be viewed. */
+  int* ints(size_t col) { return static_cast<IntArray*>(get_chunk_(col, 'I'))->ints_; }
+
+  double* doubles(size_t col) { return static_cast<DoubleArray*>(get_chunk_(col, 'D'))->doubles_; }
+
+  BoolArray* bools(size_t col) { return static_cast<BoolArray*>(get_chunk_(col, 'B')); }
+
+  StringArray* strings(size_t col) { return static_cast<StringArray*>(get_chunk_(col, 'S')); }
+
+  /** The strings of the column if the chunk is dictionary encoded, nullptr otherwise. Its codes
+    * can then be compared instead of the strings. */
+  DictStringArray* dict_strings(size_t col) { return dynamic_cast<DictStringArray*>(strings(col)); }
+
+  /** The strings of the column if the chunk keeps them in a blob, nullptr otherwise. Their
+    * characters can then be read in place, see BlobStringArray::chars. */
+  BlobStringArray* blob_strings(size_t col) { return dynamic_cast<BlobStringArray*>(strings(col)); }
+
+  /** Whether the field of the column is missing in the idx-th row of the batch. Missing fields
+    * hold the default of their type in the typed views, and nullptr for strings. */
+  bool is_missing(size_t col, size_t idx) { return chunks_[col]->is_missing(idx); }
+
+  /** Fills the row with the fields of the idx-th row of the batch, leaving the fields of the
+    * columns the batch holds no chunk of untouched. */
+  void fill_row(size_t idx, Row& row) {
+    assert(idx < length_);
+    for (size_t ii = 0; ii < schema_.width(); ii++)
+      if (chunks_[ii] != nullptr) row.set_from_chunk(ii, chunks_[ii], idx);
+  }
+
+  /** Index in the data frame of the first row of the batch. */
+  size_t start() { return start_; }
+
+  /** Number of rows in the batch. */
+  size_t length() { return length_; }
+
+  size_t width() { return schema_.width(); }
+
+  char col_type(size_t idx) { return schema_.col_type(idx); }
+};
+
+/*******************************************************************************
+ *  BatchRower::
+ *  The chunk at a time counterpart of Rower. accept() is called once per batch
+ *  of the rows of a chunk, so simple scans and aggregations can be written as
+ *  tight loops over the typed arrays of a RowBatch.
+ */
+class BatchRower : public Object {
+ public:
+  /** Called once per batch, in row order. The batch is on loan and must not be retained. */
+  virtual void accept(RowBatch& batch) = 0;
+
+  /** Same contract as Rower::join_delete. */
+  virtual void join_delete(BatchRower* other) = 0;
+
+  virtual BatchRower* clone() { assert(0); }
+
+  /** Same contract as Rower::registered_name. */
+  virtual const char* registered_name() { return nullptr; }
 };
\ No newline at end of file
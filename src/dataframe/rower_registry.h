@@ -0,0 +1,83 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include "../helpers/map.h"
+#include "../helpers/serial.h"
+#include "rower.h"
+
+class KV_Store;
+
+// Rebuild a rower from the state written by its serialize(), on the node owning the store
+typedef Rower* (*RowerFactory)(Deserializer& deserializer, KV_Store* kv);
+typedef BatchRower* (*BatchRowerFactory)(Deserializer& deserializer, KV_Store* kv);
+
+/**
+ * The factory of a registered Rower or BatchRower, wrapped in an Object so that it can be kept in
+ * a Map. Only one of the two is set.
+ */
+class RowerFactoryEntry : public Object {
+  public:
+  RowerFactory factory_;
+  BatchRowerFactory batch_factory_;
+
+  RowerFactoryEntry(RowerFactory factory, BatchRowerFactory batch_factory) {
+    factory_ = factory;
+    batch_factory_ = batch_factory;
+  }
+
+  RowerFactoryEntry* clone() { return new RowerFactoryEntry(factory_, batch_factory_); }
+};
+
+/**
+ * RowerRegistry::
+ * Maps the names of rowers to the factories rebuilding them on the nodes they are shipped to.
+ * Every node has to register the same rowers under the same names before any of them is shipped,
+ * typically when the application starts.
+ * Authors: Kaylin Devchand & Cristian Stransky
+ */
+class RowerRegistry : public Object {
+  public:
+  Map factories_; // String* -> RowerFactoryEntry*
+
+  void add_entry_(const char* name, RowerFactoryEntry& entry) {
+    String key(name);
+    delete factories_.put(&key, &entry);
+  }
+
+  RowerFactoryEntry* get_entry_(const char* name) {
+    if (name == nullptr) return nullptr;
+    String key(name);
+    return dynamic_cast<RowerFactoryEntry*>(factories_.get(&key));
+  }
+
+  /** Registers the factory under the name, replacing any factory already registered under it. */
+  void add(const char* name, RowerFactory factory) {
+    RowerFactoryEntry entry(factory, nullptr);
+    add_entry_(name, entry);
+  }
+
+  void add(const char* name, BatchRowerFactory factory) {
+    RowerFactoryEntry entry(nullptr, factory);
+    add_entry_(name, entry);
+  }
+
+  /** Returns the Rower factory registered under the name, nullptr if there is none. */
+  RowerFactory get(const char* name) {
+    RowerFactoryEntry* entry = get_entry_(name);
+    return entry ? entry->factory_ : nullptr;
+  }
+
+  /** Returns the BatchRower factory registered under the name, nullptr if there is none. */
+  BatchRowerFactory get_batch(const char* name) {
+    RowerFactoryEntry* entry = get_entry_(name);
+    return entry ? entry->batch_factory_ : nullptr;
+  }
+
+  bool contains(const char* name) { return get_entry_(name) != nullptr; }
+};
+
+/** The registry of this process. */
+RowerRegistry& rower_registry() {
+  static RowerRegistry registry;
+  return registry;
+}
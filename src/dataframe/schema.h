@@ -92,6 +92,11 @@ class Schema : public Object {
     this->num_rows_++;
   }
 
+  /** Add n rows at once, as when the chunks of another frame are appended. */
+  void add_rows(size_t n) {
+    this->num_rows_ += n;
+  }
+
   /** Return type of column at idx. An idx >= width is undefined. */
   char col_type(size_t idx) {
     assert(idx < num_cols_);
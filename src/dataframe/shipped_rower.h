@@ -0,0 +1,56 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <thread>
+
+#include "../helpers/array.h"
+#include "../helpers/serial.h"
+#include "../kv_store/kv_store.h"
+
+/**
+ * A rower shipped to another node on a background thread, see DataFrame::ship_map. The node runs
+ * it over the chunks it holds and sends it back serialized.
+ */
+class ShippedRower : public Object {
+  public:
+  size_t node_index_;
+  IntArray* chunks_; // owned
+  String* rower_name_; // owned
+  Serializer* rower_; // owned
+  Serializer* df_; // owned
+  char* result_; // owned until taken, written by thread_
+  std::thread thread_;
+
+  /** Takes ownership of the chunks. */
+  ShippedRower(KV_Store* kv, size_t node_index, IntArray* chunks, String* rower_name,
+    Serializer* rower, Serializer* df) {
+    node_index_ = node_index;
+    chunks_ = chunks;
+    rower_name_ = rower_name->clone();
+    rower_ = rower->clone();
+    df_ = df->clone();
+    result_ = nullptr;
+    thread_ = std::thread(&ShippedRower::ship_, this, kv);
+  }
+
+  ~ShippedRower() {
+    if (thread_.joinable()) thread_.join();
+    delete chunks_;
+    delete rower_name_;
+    delete rower_;
+    delete df_;
+    delete[] result_;
+  }
+
+  void ship_(KV_Store* kv) {
+    result_ = kv->ship_rower(node_index_, rower_name_, rower_, df_, chunks_);
+  }
+
+  /** Waits for the rower to come back and hands its serial over to the caller. */
+  char* take() {
+    thread_.join();
+    char* result = result_;
+    result_ = nullptr;
+    return result;
+  }
+};
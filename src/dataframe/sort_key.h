@@ -0,0 +1,156 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <algorithm>
+
+#include "fields.h"
+
+/*******************************************************************************
+ *  SortKey::
+ *  The columns a frame is sorted on, most significant first, and the direction
+ *  of the sort. Rows are compared given the chunks of every column of the frame
+ *  they belong to, of which only those of the sort columns are read.
+ */
+class SortKey : public Object {
+ public:
+  Schema schema_; // of the sorted frame
+  IntArray* cols_; // owned
+  bool ascending_;
+
+  SortKey(Schema& schema, IntArray& cols, bool ascending) : schema_(schema) {
+    assert(cols.length() > 0);
+    cols_ = cols.clone();
+    ascending_ = ascending;
+  }
+
+  SortKey(SortKey& other) : schema_(other.schema_) {
+    cols_ = other.cols_->clone();
+    ascending_ = other.ascending_;
+  }
+
+  SortKey(Deserializer& deserializer) : schema_(deserializer) {
+    cols_ = new IntArray(deserializer);
+    ascending_ = deserializer.deserialize_bool();
+  }
+
+  ~SortKey() { delete cols_; }
+
+  SortKey* clone() { return new SortKey(*this); }
+
+  /** Negative if row a_idx of the a chunks comes before row b_idx of the b chunks once sorted,
+    * positive if it comes after and 0 if their keys are equal. */
+  int compare(Array** a, size_t a_idx, Array** b, size_t b_idx) {
+    for (size_t ii = 0; ii < cols_->length(); ii++) {
+      size_t col = cols_->get(ii);
+      int order = compare_fields_(a[col], a_idx, b[col], schema_.col_type(col), b_idx);
+      if (order != 0) return ascending_ ? order : -order;
+    }
+    return 0;
+  }
+
+  size_t serial_len() { return schema_.serial_len() + cols_->serial_len() + sizeof(bool); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(&schema_);
+    serializer.serialize_object(cols_);
+    serializer.serialize_bool(ascending_);
+    return serializer.get_serial();
+  }
+};
+
+/*******************************************************************************
+ *  Splitters::
+ *  Keys cutting the rows of a frame sorted on a SortKey into ranges of about
+ *  the same number of rows, picked from a sample of the rows. Range p holds the
+ *  rows after splitter p - 1 and up to splitter p, so rows with equal keys
+ *  always fall in the same range.
+ */
+class Splitters : public Object {
+ public:
+  SortKey* key_; // owned
+  Array** rows_; // owned, chunks of the splitters indexed like the columns, nullptr off the key
+
+  /** Picks num_parts - 1 splitters among the sample, whose chunks are indexed like the columns of
+    * the frame with nullptr for the columns off the key. */
+  Splitters(SortKey& key, Array** sample, size_t num_parts) {
+    key_ = key.clone();
+    init_rows_();
+    size_t sample_length = sample[key_->cols_->get(0)]->length();
+    size_t* order = new size_t[::max(sample_length, 1)];
+    for (size_t ii = 0; ii < sample_length; ii++) order[ii] = ii;
+    std::sort(order, order + sample_length,
+      [this, sample](size_t x, size_t y) { return key_->compare(sample, x, sample, y) < 0; });
+    for (size_t ii = 1; ii < num_parts && sample_length > 0; ii++) {
+      for (size_t jj = 0; jj < key_->cols_->length(); jj++) {
+        size_t col = key_->cols_->get(jj);
+        push_field_(rows_[col], sample[col], key_->schema_.col_type(col),
+          order[ii * sample_length / num_parts]);
+      }
+    }
+    delete[] order;
+  }
+
+  Splitters(Splitters& other) {
+    key_ = other.key_->clone();
+    rows_ = new Array*[::max(key_->schema_.width(), 1)];
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++)
+      rows_[ii] = other.rows_[ii] ? other.rows_[ii]->clone() : nullptr;
+  }
+
+  Splitters(Deserializer& deserializer) {
+    key_ = new SortKey(deserializer);
+    rows_ = new Array*[::max(key_->schema_.width(), 1)];
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++) rows_[ii] = nullptr;
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++) {
+      size_t col = key_->cols_->get(ii);
+      rows_[col] = deserialize_array(deserializer, key_->schema_.col_type(col));
+    }
+  }
+
+  ~Splitters() {
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++) delete rows_[ii];
+    delete[] rows_;
+    delete key_;
+  }
+
+  void init_rows_() {
+    rows_ = new Array*[::max(key_->schema_.width(), 1)];
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++) rows_[ii] = nullptr;
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++) {
+      size_t col = key_->cols_->get(ii);
+      rows_[col] = new_field_array_(key_->schema_.col_type(col), 1);
+    }
+  }
+
+  Splitters* clone() { return new Splitters(*this); }
+
+  size_t length() { return rows_[key_->cols_->get(0)]->length(); }
+
+  /** Range of the idx-th row of the chunks, the number of splitters not after it. */
+  size_t part_of(Array** chunks, size_t idx) {
+    size_t low = 0;
+    size_t high = length();
+    while (low < high) {
+      size_t mid = (low + high) / 2;
+      if (key_->compare(rows_, mid, chunks, idx) <= 0) low = mid + 1;
+      else high = mid;
+    }
+    return low;
+  }
+
+  size_t serial_len() {
+    size_t len = key_->serial_len();
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++)
+      len += rows_[key_->cols_->get(ii)]->serial_len();
+    return len;
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(key_);
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++)
+      serializer.serialize_object(rows_[key_->cols_->get(ii)]);
+    return serializer.get_serial();
+  }
+};
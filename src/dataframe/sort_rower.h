@@ -0,0 +1,395 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "dataframe_builder.h"
+#include "fields.h"
+#include "rower_registry.h"
+#include "sort_key.h"
+
+/*******************************************************************************
+ *  SampleRower::
+ *  Keeps the key of every stride-th row of the frame, by row index, to pick the
+ *  Splitters of a distributed sort from.
+ */
+class SampleRower : public BatchRower {
+ public:
+  SortKey* key_; // owned
+  size_t stride_;
+  Array** sample_; // owned, indexed like the columns, nullptr off the key
+
+  SampleRower(SortKey& key, size_t stride) {
+    key_ = key.clone();
+    stride_ = stride;
+    init_sample_(nullptr);
+  }
+
+  SampleRower(Deserializer& deserializer, KV_Store* kv) {
+    key_ = new SortKey(deserializer);
+    stride_ = deserializer.deserialize_size_t();
+    init_sample_(&deserializer);
+  }
+
+  ~SampleRower() {
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++) delete sample_[ii];
+    delete[] sample_;
+    delete key_;
+  }
+
+  /** Creates the sample arrays, reading them from the deserializer if any. */
+  void init_sample_(Deserializer* deserializer) {
+    sample_ = new Array*[::max(key_->schema_.width(), 1)];
+    for (size_t ii = 0; ii < key_->schema_.width(); ii++) sample_[ii] = nullptr;
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++) {
+      size_t col = key_->cols_->get(ii);
+      char type = key_->schema_.col_type(col);
+      sample_[col] = deserializer ? deserialize_array(*deserializer, type)
+        : new_field_array_(type, 1);
+    }
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new SampleRower(deserializer, kv);
+  }
+
+  void accept(RowBatch& batch) {
+    for (size_t ii = (stride_ - batch.start() % stride_) % stride_; ii < batch.length();
+        ii += stride_) {
+      for (size_t jj = 0; jj < key_->cols_->length(); jj++) {
+        size_t col = key_->cols_->get(jj);
+        push_field_(sample_[col], batch.chunks_[col], batch.col_type(col), ii);
+      }
+    }
+  }
+
+  BatchRower* clone() { return new SampleRower(*key_, stride_); }
+
+  void join_delete(BatchRower* other) {
+    SampleRower* sample_rower = dynamic_cast<SampleRower*>(other);
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++) {
+      size_t col = key_->cols_->get(ii);
+      Array* from = sample_rower->sample_[col];
+      for (size_t jj = 0; jj < from->length(); jj++)
+        push_field_(sample_[col], from, key_->schema_.col_type(col), jj);
+    }
+    delete other;
+  }
+
+  const char* registered_name() { return "SampleRower"; }
+
+  size_t serial_len() {
+    size_t len = key_->serial_len() + sizeof(size_t);
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++)
+      len += sample_[key_->cols_->get(ii)]->serial_len();
+    return len;
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(key_);
+    serializer.serialize_size_t(stride_);
+    for (size_t ii = 0; ii < key_->cols_->length(); ii++)
+      serializer.serialize_object(sample_[key_->cols_->get(ii)]);
+    return serializer.get_serial();
+  }
+};
+
+bool sample_rower_registered_ = (rower_registry().add("SampleRower",
+  static_cast<BatchRowerFactory>(SampleRower::deserialize)), true);
+
+/*******************************************************************************
+ *  SortRun::
+ *  Rows sorted on a SortKey, read back in order a block at a time. A run stays
+ *  in memory or is spilled to a temporary file in blocks of ELEMENT_ARRAY_SIZE
+ *  rows, so merging spilled runs only holds one block of each in memory.
+ */
+class SortRun : public Object {
+ public:
+  Schema schema_;
+  FILE* file_; // owned, nullptr for a run in memory
+  Array** block_; // owned, chunks of the rows being read, nullptr once all are read
+  size_t pos_;
+
+  /** Takes ownership of the chunks of the sorted rows. A spilled run writes them to a temporary
+    * file, unlinked right away so it goes away with the run, and deletes them. */
+  SortRun(Schema& schema, Array** rows, bool spill) : schema_(schema) {
+    file_ = nullptr;
+    block_ = rows;
+    pos_ = 0;
+    if (spill) spill_();
+    else if (block_[0]->length() == 0) delete_block_();
+  }
+
+  void spill_() {
+    const char* dir = getenv("TMPDIR");
+    String path(dir ? dir : "/tmp");
+    path.concat("/sort_run_XXXXXX");
+    int fd = mkstemp(path.c_str());
+    assert(fd != -1);
+    unlink(path.c_str());
+    file_ = fdopen(fd, "w+b");
+    size_t num_rows = block_[0]->length();
+    for (size_t start = 0; start < num_rows; start += ELEMENT_ARRAY_SIZE) {
+      size_t end = ::min(start + ELEMENT_ARRAY_SIZE, num_rows);
+      for (size_t ii = 0; ii < schema_.width(); ii++) {
+        char type = schema_.col_type(ii);
+        Array* part = new_field_array_(type, end - start);
+        for (size_t jj = start; jj < end; jj++) push_field_(part, block_[ii], type, jj);
+        size_t len = part->serial_len();
+        char* serial = part->serialize();
+        fwrite(&len, sizeof(size_t), 1, file_);
+        fwrite(serial, 1, len, file_);
+        delete[] serial;
+        delete part;
+      }
+    }
+    delete_block_();
+    rewind(file_);
+    read_block_();
+  }
+
+  ~SortRun() {
+    delete_block_();
+    if (file_ != nullptr) fclose(file_);
+  }
+
+  void delete_block_() {
+    if (block_ == nullptr) return;
+    for (size_t ii = 0; ii < schema_.width(); ii++) delete block_[ii];
+    delete[] block_;
+    block_ = nullptr;
+  }
+
+  /** Reads the next block of a spilled run, leaving block_ nullptr at the end of the file. */
+  void read_block_() {
+    pos_ = 0;
+    if (file_ == nullptr) return;
+    size_t len;
+    if (fread(&len, sizeof(size_t), 1, file_) != 1) return;
+    block_ = new Array*[schema_.width()];
+    for (size_t ii = 0; ii < schema_.width(); ii++) {
+      size_t read = ii == 0 ? 1 : fread(&len, sizeof(size_t), 1, file_);
+      assert(read == 1);
+      char* serial = new char[len];
+      read = fread(serial, 1, len, file_);
+      assert(read == len);
+      Deserializer deserializer(serial);
+      block_[ii] = deserialize_array(deserializer, schema_.col_type(ii));
+      delete[] serial;
+    }
+  }
+
+  /** Whether every row of the run has been read. */
+  bool done() { return block_ == nullptr; }
+
+  /** Moves on to the next row. */
+  void advance() {
+    if (++pos_ < block_[0]->length()) return;
+    delete_block_();
+    read_block_();
+  }
+};
+
+/*******************************************************************************
+ *  SortRower::
+ *  Sorts the rows of the batches it is given on a SortKey. Rows are buffered
+ *  until max_rows of them are, then sorted into a run spilled to a local file.
+ *  The runs of the clones on a node are gathered on join, and before the rower
+ *  leaves the node they are merged k ways into the sorted frame of its range,
+ *  written by a builder pinned to the node. Ranges are numbered by node, the
+ *  chunks of range p starting at first_chunks[p] so the chunks of all ranges
+ *  are keyed name_col_chunk in row order, see DataFrame::sort.
+ */
+class SortRower : public BatchRower {
+ public:
+  SortKey* key_; // owned
+  String* name_; // owned, key of the sorted frame
+  size_t max_rows_;
+  IntArray* first_chunks_; // owned
+  KV_Store* kv_; // not owned, store of the node the rower runs on
+  Array** buffer_; // owned, chunks of the rows not in a run yet
+  Array runs_; // SortRuns of the rows seen so far
+  DataFrame** sorted_; // owned, sorted frame of every range, nullptr if not merged here
+
+  SortRower(SortKey& key, String* name, size_t max_rows, IntArray& first_chunks, KV_Store* kv)
+      : runs_('O', 1) {
+    key_ = key.clone();
+    name_ = name->clone();
+    max_rows_ = max_rows;
+    first_chunks_ = first_chunks.clone();
+    kv_ = kv;
+    init_();
+  }
+
+  SortRower(Deserializer& deserializer, KV_Store* kv) : runs_('O', 1) {
+    key_ = new SortKey(deserializer);
+    name_ = new String(deserializer);
+    max_rows_ = deserializer.deserialize_size_t();
+    first_chunks_ = new IntArray(deserializer);
+    kv_ = kv;
+    init_();
+    for (size_t ii = 0; ii < num_ranges(); ii++)
+      if (deserializer.deserialize_bool()) sorted_[ii] = new DataFrame(deserializer, kv);
+  }
+
+  void init_() {
+    buffer_ = new Array*[::max(width(), 1)];
+    new_buffer_();
+    sorted_ = new DataFrame*[num_ranges()];
+    for (size_t ii = 0; ii < num_ranges(); ii++) sorted_[ii] = nullptr;
+  }
+
+  ~SortRower() {
+    for (size_t ii = 0; ii < width(); ii++) delete buffer_[ii];
+    delete[] buffer_;
+    for (size_t ii = 0; ii < num_ranges(); ii++) delete sorted_[ii];
+    delete[] sorted_;
+    delete first_chunks_;
+    delete name_;
+    delete key_;
+  }
+
+  static BatchRower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new SortRower(deserializer, kv);
+  }
+
+  size_t width() { return key_->schema_.width(); }
+
+  size_t num_ranges() { return first_chunks_->length(); }
+
+  void new_buffer_() {
+    for (size_t ii = 0; ii < width(); ii++)
+      buffer_[ii] = new_field_array_(key_->schema_.col_type(ii),
+        ::min(max_rows_, ELEMENT_ARRAY_SIZE));
+  }
+
+  void accept(RowBatch& batch) {
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      for (size_t jj = 0; jj < width(); jj++)
+        push_field_(buffer_[jj], batch.chunks_[jj], batch.col_type(jj), ii);
+      if (buffer_[0]->length() >= max_rows_) runs_.push(object_to_payload(sort_buffer_(true)));
+    }
+  }
+
+  /** Sorts the buffered rows into a run, spilled or kept in memory, and empties the buffer. Rows
+    * with equal keys keep the order they came in. */
+  SortRun* sort_buffer_(bool spill) {
+    size_t num_rows = buffer_[0]->length();
+    size_t* order = new size_t[::max(num_rows, 1)];
+    for (size_t ii = 0; ii < num_rows; ii++) order[ii] = ii;
+    std::stable_sort(order, order + num_rows,
+      [this](size_t x, size_t y) { return key_->compare(buffer_, x, buffer_, y) < 0; });
+    Array** rows = new Array*[::max(width(), 1)];
+    for (size_t ii = 0; ii < width(); ii++) {
+      char type = key_->schema_.col_type(ii);
+      rows[ii] = new_field_array_(type, ::max(num_rows, 1));
+      for (size_t jj = 0; jj < num_rows; jj++) push_field_(rows[ii], buffer_[ii], type, order[jj]);
+      delete buffer_[ii];
+    }
+    delete[] order;
+    new_buffer_();
+    return new SortRun(key_->schema_, rows, spill);
+  }
+
+  SortRun* run_(size_t idx) { return static_cast<SortRun*>(runs_.get(idx).o); }
+
+  /** Merges the runs, and the rows still buffered, into the sorted frame of the range of this
+    * node. Runs holding equal keys are read in the order they were made. */
+  void merge_() {
+    if (buffer_[0]->length() > 0) runs_.push(object_to_payload(sort_buffer_(false)));
+    size_t num_runs = runs_.length();
+    if (num_runs == 0) return;
+    size_t node = kv_->get_node_index();
+    assert(sorted_[node] == nullptr);
+    DataFrameBuilder builder(key_->schema_, name_, kv_);
+    builder.set_chunk_rows(chunk_rows_for(key_->schema_, DEFAULT_CHUNK_BYTES));
+    builder.pin_to_node(node);
+    builder.start_at_chunk(first_chunks_->get(node));
+    Row row(key_->schema_, true);
+
+    // Min heap of the runs on the row each is at
+    size_t* heap = new size_t[num_runs];
+    size_t heap_size = 0;
+    auto after = [this](size_t x, size_t y) {
+      int order = key_->compare(run_(x)->block_, run_(x)->pos_, run_(y)->block_, run_(y)->pos_);
+      return order > 0 || (order == 0 && x > y);
+    };
+    for (size_t ii = 0; ii < num_runs; ii++) if (!run_(ii)->done()) heap[heap_size++] = ii;
+    std::make_heap(heap, heap + heap_size, after);
+    while (heap_size > 0) {
+      std::pop_heap(heap, heap + heap_size, after);
+      SortRun* run = run_(heap[heap_size - 1]);
+      set_fields_(row, 0, key_->schema_, run->block_, run->pos_);
+      builder.add_row(row);
+      run->advance();
+      if (run->done()) heap_size--;
+      else std::push_heap(heap, heap + heap_size, after);
+    }
+    delete[] heap;
+    runs_.clear();
+    sorted_[node] = builder.done();
+  }
+
+  BatchRower* clone() { return new SortRower(*key_, name_, max_rows_, *first_chunks_, kv_); }
+
+  /** The rows of the other rower came after those of this one, its runs follow the ones this
+    * rower made of all of its rows. */
+  void join_delete(BatchRower* other) {
+    SortRower* sort_rower = dynamic_cast<SortRower*>(other);
+    if (buffer_[0]->length() > 0) runs_.push(object_to_payload(sort_buffer_(false)));
+    while (sort_rower->runs_.length() > 0) runs_.push(sort_rower->runs_.remove(0));
+    if (sort_rower->buffer_[0]->length() > 0)
+      runs_.push(object_to_payload(sort_rower->sort_buffer_(false)));
+    for (size_t ii = 0; ii < num_ranges(); ii++) {
+      if (sort_rower->sorted_[ii] == nullptr) continue;
+      assert(sorted_[ii] == nullptr);
+      sorted_[ii] = sort_rower->sorted_[ii];
+      sort_rower->sorted_[ii] = nullptr;
+    }
+    delete other;
+  }
+
+  /** Merges the rows left on this node and returns the sorted frame of every range appended in
+    * range order, owned by the caller. */
+  DataFrame* take() {
+    merge_();
+    DataFrame* result = new DataFrame(key_->schema_, kv_);
+    for (size_t ii = 0; ii < num_ranges(); ii++)
+      if (sorted_[ii] != nullptr) result->append_chunks(*sorted_[ii]);
+    return result;
+  }
+
+  const char* registered_name() { return "SortRower"; }
+
+  // The runs are merged on the node the rower leaves, only the sorted frames are sent
+  size_t serial_len() {
+    merge_();
+    size_t len = key_->serial_len()
+      + name_->serial_len()
+      + sizeof(size_t)
+      + first_chunks_->serial_len();
+    for (size_t ii = 0; ii < num_ranges(); ii++)
+      len += sizeof(bool) + (sorted_[ii] ? sorted_[ii]->serial_len() : 0);
+    return len;
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(key_);
+    serializer.serialize_object(name_);
+    serializer.serialize_size_t(max_rows_);
+    serializer.serialize_object(first_chunks_);
+    for (size_t ii = 0; ii < num_ranges(); ii++) {
+      serializer.serialize_bool(sorted_[ii] != nullptr);
+      if (sorted_[ii] != nullptr) serializer.serialize_object(sorted_[ii]);
+    }
+    return serializer.get_serial();
+  }
+};
+
+bool sort_rower_registered_ = (rower_registry().add("SortRower",
+  static_cast<BatchRowerFactory>(SortRower::deserialize)), true);
@@ -0,0 +1,233 @@
+// Made by Kaylin Devchand and Cristian Stransky
+#pragma once
+
+#include <math.h>
+
+#include "../helpers/array.h"
+#include "../helpers/serial.h"
+#include "kernels.h"
+
+// Bits of the bitmap the distinct values of a chunk are estimated with
+const size_t DISTINCT_BITMAP_BITS = 4096;
+
+/** Estimates the distinct values among those hashed into the bitmap, by linear counting. */
+size_t estimate_distinct_(uint64_t* bitmap, size_t count) {
+  size_t zeros = DISTINCT_BITMAP_BITS - count_bits(bitmap, DISTINCT_BITMAP_BITS);
+  if (zeros == 0) return count;
+  double estimate = DISTINCT_BITMAP_BITS * log((double)DISTINCT_BITMAP_BITS / zeros);
+  return std::min((size_t)(estimate + 0.5), count);
+}
+
+void mark_hash_(uint64_t* bitmap, uint64_t hash) {
+  size_t bit = (hash * 0x9E3779B97F4A7C15ull) >> 52; // top 12 bits, DISTINCT_BITMAP_BITS = 2^12
+  bitmap[bit / 64] |= (uint64_t)1 << (bit % 64);
+}
+
+/*******************************************************************************
+ *  ZoneMap::
+ *  Statistics of one chunk of a column: the min and max of its elements, how
+ *  many there are and an estimate of how many are distinct, all over the
+ *  elements that are not missing, and how many are missing. Bools count as 0 and
+ *  1, strings have no range. A chunk whose statistics are not known has the
+ *  range [-infinity, infinity], so no predicate ever skips it.
+ */
+class ZoneMap : public Object {
+ public:
+  double min_;
+  double max_;
+  size_t count_;
+  size_t distinct_;
+  size_t nulls_;
+
+  ZoneMap(double min, double max, size_t count, size_t distinct, size_t nulls) {
+    min_ = min;
+    max_ = max;
+    count_ = count;
+    distinct_ = distinct;
+    nulls_ = nulls;
+  }
+
+  ZoneMap(double min, double max, size_t count, size_t distinct)
+    : ZoneMap(min, max, count, distinct, 0) { }
+
+  /** The statistics of a chunk nothing is known about. */
+  static ZoneMap unknown(size_t count) { return ZoneMap(-INFINITY, INFINITY, count, count); }
+
+  /** Computes the statistics of a chunk of the given column type. */
+  static ZoneMap of(Array* chunk, char type) {
+    size_t nulls = chunk->num_missing();
+    if (nulls > 0) return of_present_(chunk, type);
+    size_t n = chunk->length();
+    if (n == 0) return ZoneMap(INFINITY, -INFINITY, 0, 0);
+    uint64_t bitmap[DISTINCT_BITMAP_BITS / 64];
+    memset(bitmap, 0, sizeof(bitmap));
+    switch (type) {
+      case 'I': {
+        int* ints = static_cast<IntArray*>(chunk)->ints_;
+        for (size_t ii = 0; ii < n; ii++) mark_hash_(bitmap, (uint64_t)(int64_t)ints[ii]);
+        return ZoneMap(min_ints(ints, n), max_ints(ints, n), n, estimate_distinct_(bitmap, n));
+      }
+      case 'D': {
+        double* doubles = static_cast<DoubleArray*>(chunk)->doubles_;
+        for (size_t ii = 0; ii < n; ii++) {
+          uint64_t bits;
+          memcpy(&bits, &doubles[ii], sizeof(uint64_t));
+          mark_hash_(bitmap, bits);
+        }
+        return ZoneMap(min_doubles(doubles, n), max_doubles(doubles, n), n,
+          estimate_distinct_(bitmap, n));
+      }
+      case 'B': {
+        size_t num_true = count_true(static_cast<BoolArray*>(chunk));
+        return ZoneMap(num_true == n ? 1 : 0, num_true > 0 ? 1 : 0, n,
+          (num_true > 0) + (num_true < n));
+      }
+      case 'S': {
+        DictStringArray* dict = dynamic_cast<DictStringArray*>(chunk);
+        if (dict != nullptr) return ZoneMap(-INFINITY, INFINITY, n, dict->dictionary()->length());
+        StringArray* strings = static_cast<StringArray*>(chunk);
+        for (size_t ii = 0; ii < n; ii++)
+          if (strings->get(ii) != nullptr) mark_hash_(bitmap, strings->get(ii)->hash());
+        return ZoneMap(-INFINITY, INFINITY, n, estimate_distinct_(bitmap, n));
+      }
+    }
+    assert(0);
+  }
+
+  /** The statistics of a chunk with missing elements, which are left out. */
+  static ZoneMap of_present_(Array* chunk, char type) {
+    size_t nulls = chunk->num_missing();
+    size_t n = chunk->length() - nulls;
+    if (n == 0) return ZoneMap(INFINITY, -INFINITY, 0, 0, nulls);
+    uint64_t bitmap[DISTINCT_BITMAP_BITS / 64];
+    memset(bitmap, 0, sizeof(bitmap));
+    for (size_t ii = 0; ii < chunk->length(); ii++) {
+      if (chunk->is_missing(ii)) continue;
+      switch (type) {
+        case 'I':
+          mark_hash_(bitmap, (uint64_t)(int64_t)static_cast<IntArray*>(chunk)->get(ii));
+          break;
+        case 'D': {
+          double val = static_cast<DoubleArray*>(chunk)->get(ii);
+          uint64_t bits;
+          memcpy(&bits, &val, sizeof(uint64_t));
+          mark_hash_(bitmap, bits);
+          break;
+        }
+        case 'B': mark_hash_(bitmap, static_cast<BoolArray*>(chunk)->get(ii)); break;
+        case 'S': mark_hash_(bitmap, static_cast<StringArray*>(chunk)->get(ii)->hash()); break;
+      }
+    }
+    if (type == 'S') return ZoneMap(-INFINITY, INFINITY, n, estimate_distinct_(bitmap, n), nulls);
+    Aggregate min(AggOp::Min);
+    min.add_chunk(chunk, type);
+    Aggregate max(AggOp::Max);
+    max.add_chunk(chunk, type);
+    return ZoneMap(min.result(), max.result(), n, estimate_distinct_(bitmap, n), nulls);
+  }
+
+  /** Whether some element of the chunk may satisfy element op value. */
+  bool may_match(CmpOp op, double value) {
+    if (count_ == 0) return false;
+    switch (op) {
+      case CmpOp::Lt: return min_ < value;
+      case CmpOp::Le: return min_ <= value;
+      case CmpOp::Gt: return max_ > value;
+      case CmpOp::Ge: return max_ >= value;
+      case CmpOp::Eq: return min_ <= value && value <= max_;
+      case CmpOp::Ne: return !(min_ == value && max_ == value);
+    }
+    assert(0);
+  }
+
+  /** Whether every element of the chunk satisfies element op value. */
+  bool all_match(CmpOp op, double value) {
+    switch (op) {
+      case CmpOp::Lt: return max_ < value;
+      case CmpOp::Le: return max_ <= value;
+      case CmpOp::Gt: return min_ > value;
+      case CmpOp::Ge: return min_ >= value;
+      case CmpOp::Eq: return min_ == value && max_ == value;
+      case CmpOp::Ne: return value < min_ || max_ < value;
+    }
+    assert(0);
+  }
+};
+
+/*******************************************************************************
+ *  ZoneMaps::
+ *  The ZoneMap of every chunk of a column, in chunk order. Kept as one array per
+ *  statistic so that they serialize with a single copy each.
+ */
+class ZoneMaps : public Object {
+ public:
+  DoubleArray* mins_; // owned
+  DoubleArray* maxs_; // owned
+  IntArray* counts_; // owned
+  IntArray* distincts_; // owned
+  IntArray* nulls_; // owned
+
+  ZoneMaps() {
+    mins_ = new DoubleArray(1);
+    maxs_ = new DoubleArray(1);
+    counts_ = new IntArray(1);
+    distincts_ = new IntArray(1);
+    nulls_ = new IntArray(1);
+  }
+
+  ZoneMaps(ZoneMaps& other) {
+    mins_ = other.mins_->clone();
+    maxs_ = other.maxs_->clone();
+    counts_ = other.counts_->clone();
+    distincts_ = other.distincts_->clone();
+    nulls_ = other.nulls_->clone();
+  }
+
+  ZoneMaps(Deserializer& deserializer) {
+    mins_ = new DoubleArray(deserializer);
+    maxs_ = new DoubleArray(deserializer);
+    counts_ = new IntArray(deserializer);
+    distincts_ = new IntArray(deserializer);
+    nulls_ = new IntArray(deserializer);
+  }
+
+  ~ZoneMaps() {
+    delete mins_;
+    delete maxs_;
+    delete counts_;
+    delete distincts_;
+    delete nulls_;
+  }
+
+  ZoneMaps* clone() { return new ZoneMaps(*this); }
+
+  void push(ZoneMap zone) {
+    mins_->push(zone.min_);
+    maxs_->push(zone.max_);
+    counts_->push(zone.count_);
+    distincts_->push(zone.distinct_);
+    nulls_->push(zone.nulls_);
+  }
+
+  ZoneMap get(size_t chunk_index) {
+    return ZoneMap(mins_->get(chunk_index), maxs_->get(chunk_index), counts_->get(chunk_index),
+      distincts_->get(chunk_index), nulls_->get(chunk_index));
+  }
+
+  size_t length() { return counts_->length(); }
+
+  size_t serial_len() {
+    return mins_->serial_len() + maxs_->serial_len() + counts_->serial_len()
+      + distincts_->serial_len() + nulls_->serial_len();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_object(mins_);
+    serializer.serialize_object(maxs_);
+    serializer.serialize_object(counts_);
+    serializer.serialize_object(distincts_);
+    serializer.serialize_object(nulls_);
+    return serializer.get_serial();
+  }
+};
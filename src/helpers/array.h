@@ -1,27 +1,46 @@
 // Made by Kaylin Devchand and Cristian Stransky
 #pragma once
 
+#include <stdint.h>
+#include <new>
 #include "object.h"
 #include "string.h"
 #include <assert.h>
 #include "payload.h"
 
+// Set on the header type of a serialized Array whose missing elements follow the header as a
+// bitmap, see Array::set_missing. Header types are ASCII, so the bit is otherwise always clear.
+const char MISSING_ELEMENTS_FLAG = (char)0x80;
+
+/**
+ * Generic Array backed by a Payload union per element. The primitive arrays (IntArray,
+ * DoubleArray, BoolArray) keep their own dense storage instead, elements_ is then nullptr and the
+ * Payload based methods go through get_payload().
+ * Any element can be marked missing, e.g. a field absent from a file. Its slot keeps the value it
+ * was pushed with, the default of the type for the dense arrays and nullptr for the strings.
+ */
 class Array : public Object {
 public:
   size_t size_;
   size_t count_;
   char type_;
-  Payload* elements_;
+  Payload* elements_; // owned; nullptr for the dense arrays
+  uint64_t* missing_; // owned, bit ii % 64 of word ii / 64 set if element ii is missing
+  size_t missing_words_; // words of missing_, the elements past them are not missing
+  size_t num_missing_;
 
-  Array(char type, size_t size, size_t count) {
+  Array(char type, size_t size, size_t count, bool dense) {
     assert(size > 0 && size >= count && (type == 'I' || type == 'B' || type == 'D' || type == 'O'));
     count_ = count;
     size_ = size;
     type_ = type;
     // TODO: Find a way to do this without using new
-    elements_ = new Payload[size_];  
+    elements_ = dense ? nullptr : new Payload[size_];  
+    init_missing_();
   }
 
+  Array(char type, size_t size, size_t count) : Array(type, size, count, false) { }
+
   Array(char type, size_t size) : Array(type, size, 0) { }
 
   Array(char type) : Array(type, 1) { }
@@ -31,14 +50,26 @@ public:
       if (arr.type_ == 'O')
         elements_[i].o = arr.elements_[i].o ? arr.elements_[i].o->clone() : nullptr;
       else
-        elements_[i] = arr.elements_[i];
+        elements_[i] = arr.get_payload(i);
     }
+    copy_missing_(arr);
   }
 
-  Array(Deserializer& deserializer) {
+  /** Reads the header, dense arrays then read their own elements right after it */
+  Array(Deserializer& deserializer, bool dense) {
     size_ = deserializer.deserialize_size_t();
     count_ = deserializer.deserialize_size_t();
     type_ = deserializer.deserialize_char();
+    elements_ = nullptr;
+    init_missing_();
+    if (type_ & MISSING_ELEMENTS_FLAG) {
+      type_ &= ~MISSING_ELEMENTS_FLAG;
+      grow_missing_(words_for_missing_(count_));
+      deserializer.deserialize_bytes(missing_, missing_words_ * sizeof(uint64_t));
+      for (size_t ii = 0; ii < missing_words_; ii++) 
+        num_missing_ += __builtin_popcountll(missing_[ii]);
+    }
+    if (dense) return;
     elements_ = new Payload[size_];
     for (size_t ii = 0; ii < count_ && type_ != 'O'; ii++) {
       switch(type_) {
@@ -49,23 +80,105 @@ public:
     }
   }
 
+  Array(Deserializer& deserializer) : Array(deserializer, false) { }
+
   ~Array() {
-    if (type_ == 'O') {
+    if (type_ == 'O' && elements_ != nullptr) {
       for (size_t ii = 0; ii < count_; ii++)
         delete elements_[ii].o;  
     }
     delete[] elements_;
+    delete[] missing_;
+  }
+
+  static size_t words_for_missing_(size_t count) { return (count + 63) / 64; }
+
+  void init_missing_() {
+    missing_ = nullptr;
+    missing_words_ = 0;
+    num_missing_ = 0;
+  }
+
+  /** Makes room for at least the given number of words of missing bits. */
+  void grow_missing_(size_t words) {
+    if (words <= missing_words_) return;
+    words = ::max(words, missing_words_ * 2);
+    uint64_t* missing = new uint64_t[words];
+    memset(missing, 0, words * sizeof(uint64_t));
+    if (missing_words_ > 0) memcpy(missing, missing_, missing_words_ * sizeof(uint64_t));
+    delete[] missing_;
+    missing_ = missing;
+    missing_words_ = words;
+  }
+
+  void copy_missing_(Array& from) {
+    if (from.num_missing_ == 0) return;
+    grow_missing_(from.missing_words_);
+    memcpy(missing_, from.missing_, from.missing_words_ * sizeof(uint64_t));
+    num_missing_ = from.num_missing_;
+  }
+
+  void clear_missing_() {
+    if (missing_words_ > 0) memset(missing_, 0, missing_words_ * sizeof(uint64_t));
+    num_missing_ = 0;
+  }
+
+  /** Shifts the missing bits past index down by one, as removing the element does. */
+  void remove_missing_(size_t index) {
+    if (num_missing_ == 0) return;
+    set_missing(index, false);
+    for (size_t ii = index + 1; ii < count_; ii++) set_missing(ii - 1, is_missing(ii));
+    set_missing(count_ - 1, false);
+  }
+
+  /** Marks the element at index missing, or not. */
+  void set_missing(size_t index, bool missing) {
+    assert(index < count_);
+    size_t word = index / 64;
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if (word >= missing_words_) {
+      if (!missing) return;
+      grow_missing_(word + 1);
+    }
+    if (((missing_[word] & bit) != 0) == missing) return;
+    missing_[word] ^= bit;
+    if (missing) num_missing_++;
+    else num_missing_--;
+  }
+
+  void set_missing(size_t index) { set_missing(index, true); }
+
+  bool is_missing(size_t index) {
+    size_t word = index / 64;
+    return word < missing_words_ && (missing_[word] >> (index % 64)) & 1;
+  }
+
+  /** Number of missing elements. */
+  size_t num_missing() { return num_missing_; }
+
+  /** Whether the elements of both arrays are missing at the same indexes. */
+  bool missing_equals_(Array* other) {
+    if (num_missing_ != other->num_missing_) return false;
+    for (size_t ii = 0; ii < count_ && num_missing_ > 0; ii++)
+      if (is_missing(ii) != other->is_missing(ii)) return false;
+    return true;
   }
 
   bool equals(Object* const obj) {
     Array* arr = dynamic_cast<Array*>(obj); 
-    if (!arr || type_ != arr->type_) return false;
+    if (!arr || type_ != arr->type_ || !missing_equals_(arr)) return false;
     for (size_t i = 0; i < count_; i++) {
+      Payload mine = get_payload(i);
+      Payload other = arr->get_payload(i);
       switch(type_) {
-        case 'I': if (elements_[i].i != arr->elements_[i].i) return false; break;
-        case 'B': if (elements_[i].b != arr->elements_[i].b) return false; break;
-        case 'D': if (elements_[i].d != arr->elements_[i].d) return false; break;
-        case 'O': if (!elements_[i].o->equals(arr->elements_[i].o)) return false; break;
+        case 'I': if (mine.i != other.i) return false; break;
+        case 'B': if (mine.b != other.b) return false; break;
+        case 'D': if (mine.d != other.d) return false; break;
+        case 'O': 
+          if (mine.o == nullptr || other.o == nullptr) {
+            if (mine.o != other.o) return false;
+          } else if (!mine.o->equals(other.o)) return false;
+          break;
       }
     }
     return true;
@@ -76,12 +189,13 @@ public:
   size_t hash() { 
     size_t hash = 0;
     for (size_t i = 0; i < count_; i++) {
+      Payload element = get_payload(i);
       switch(type_) {
         // We want to avoid 0 * 0, so we add 1 to both sides
-        case 'I': hash += (elements_[i].i + 1) * (i + 1);
-        case 'B': hash += (elements_[i].b + 1) * (i + 1);
-        case 'D': hash += (elements_[i].d + 1) * (i + 1);
-        case 'O': hash += (elements_[i].o->hash() + 1) * (i + 1);
+        case 'I': hash += (element.i + 1) * (i + 1); break;
+        case 'B': hash += (element.b + 1) * (i + 1); break;
+        case 'D': hash += (element.d + 1) * (i + 1); break;
+        case 'O': hash += ((element.o ? element.o->hash() : 0) + 1) * (i + 1); break;
       }
     }
     return hash;
@@ -101,17 +215,21 @@ public:
 
   /** returns the new size **/
   size_t push(Payload to_add) {
+    assert(elements_);
     if (count_ + 1 > size_)
       increase_array_();
     elements_[count_] = to_add;
     return count_++;
   }
 
-  Payload get(size_t index) {
+  /** The element wrapped in a Payload, dense arrays override this with their own storage */
+  virtual Payload get_payload(size_t index) {
     assert(count_ > 0 && index < count_);
     return elements_[index];
   }
 
+  Payload get(size_t index) { return get_payload(index); }
+
   /** returns -1 if not found **/
   size_t index_of(Payload payload) {
     for (size_t ii = 0; ii < count_; ii++) {
@@ -130,19 +248,21 @@ public:
     Payload element = elements_[index];
     for (size_t i = index; i < count_ - 1; i++)
       elements_[i] = elements_[i + 1];
+    remove_missing_(index);
     count_--;
     return element;
   }
 
-  void clear() {
+  virtual void clear() {
     if (type_ == 'O') 
       for (size_t ii = 0; ii < count_; ii++) 
         delete elements_[ii].o;
     count_ = 0;
+    clear_missing_();
   }
 
   Payload replace(size_t index, Payload to_add) {
-    assert(count_ > 0 && index < count_);
+    assert(elements_ && count_ > 0 && index < count_);
     Payload element = elements_[index];
     elements_[index] = to_add;
     return element;
@@ -156,28 +276,45 @@ public:
       case 'O': {
         size_t elements_serial_length = 0;
         for (size_t ii = 0; ii < count_; ii++)
-          elements_serial_length += elements_[ii].o->serial_len();
+          if (!is_missing(ii)) elements_serial_length += elements_[ii].o->serial_len();
         return elements_serial_length;
       }
     }
   }
 
-  size_t serial_len() {
+  size_t header_serial_len_() {
     return sizeof(size_t) // size_
       + sizeof(size_t) // count_
       + sizeof(char) // type_
-      + elements_serial_len_();
+      + (num_missing_ > 0 ? words_for_missing_(count_) * sizeof(uint64_t) : 0);
+  }
+
+  /** Writes the header with the given type, and the missing bits if any element is missing. */
+  void serialize_header_(Serializer& serializer, char type) {
+    serializer.serialize_size_t(size_);
+    serializer.serialize_size_t(count_);
+    if (num_missing_ == 0) {
+      serializer.serialize_char(type);
+      return;
+    }
+    serializer.serialize_char(type | MISSING_ELEMENTS_FLAG);
+    grow_missing_(words_for_missing_(count_));
+    serializer.serialize_bytes(missing_, words_for_missing_(count_) * sizeof(uint64_t));
+  }
+
+  void serialize_header_(Serializer& serializer) { serialize_header_(serializer, type_); }
+
+  size_t serial_len() {
+    return header_serial_len_() + elements_serial_len_();
   }
 
   char* serialize() {
     size_t serial_size = serial_len();
     Serializer serializer(serial_size);
-    serializer.serialize_size_t(size_);
-    serializer.serialize_size_t(count_);
-    serializer.serialize_char(type_);
+    serialize_header_(serializer);
     for (size_t ii = 0; ii < count_; ii++) {
       switch(type_) {
-        case 'O': serializer.serialize_object(elements_[ii].o); break;
+        case 'O': if (!is_missing(ii)) serializer.serialize_object(elements_[ii].o); break;
         case 'I': serializer.serialize_int(elements_[ii].i); break;
         case 'D': serializer.serialize_double(elements_[ii].d); break;
         case 'B': serializer.serialize_bool(elements_[ii].b); break;
@@ -187,47 +324,554 @@ public:
   }
 };
 
+/**
+ * Bools packed 64 to a word, both in memory and on the wire. Bits at or past count_ are always 
+ * kept at 0.
+ */
 class BoolArray : public Array {
 public:
+  uint64_t* bits_; // owned; element ii is bit (ii % 64) of word (ii / 64)
+
   BoolArray() : BoolArray(1) { }
-  BoolArray(const size_t size) : Array('B', size) { }
-  BoolArray(BoolArray& arr) : Array(arr) { }
-  BoolArray(Deserializer& deserializer) : Array(deserializer) { }
+
+  BoolArray(const size_t size) : Array('B', size, 0, true) { 
+    bits_ = new uint64_t[words_for_(size_)];
+    memset(bits_, 0, words_for_(size_) * sizeof(uint64_t));
+  }
+
+  BoolArray(BoolArray& arr) : BoolArray(arr.size_) { 
+    count_ = arr.count_;
+    memcpy(bits_, arr.bits_, words_for_(count_) * sizeof(uint64_t));
+    copy_missing_(arr);
+  }
+
+  // Only count_ elements are allocated, chunks read from the KV_Store never grow
+  BoolArray(Deserializer& deserializer) : Array(deserializer, true) { 
+    size_ = max(count_, 1);
+    bits_ = new uint64_t[words_for_(size_)];
+    memset(bits_, 0, words_for_(size_) * sizeof(uint64_t));
+    deserializer.deserialize_bytes(bits_, words_for_(count_) * sizeof(uint64_t));
+  }
+
+  ~BoolArray() { delete[] bits_; }
+
+  static size_t words_for_(size_t num_bools) { return (num_bools + 63) / 64; }
+
   BoolArray* clone() { return new BoolArray(*this); }
-  size_t push(bool to_add) { return Array::push(bool_to_payload(to_add)); }
-  bool get(size_t index) { return Array::get(index).b; }
-  size_t index_of(bool to_find) { return Array::index_of(bool_to_payload(to_find)); }
-  bool remove(size_t index) { return Array::remove(index).b; }
-  bool replace(size_t index, bool to_add) { return Array::replace(index, bool_to_payload(to_add)).b; }
+
+  bool equals(Object* const obj) {
+    BoolArray* arr = dynamic_cast<BoolArray*>(obj);
+    return arr && count_ == arr->count_ && missing_equals_(arr)
+      && memcmp(bits_, arr->bits_, words_for_(count_) * sizeof(uint64_t)) == 0;
+  }
+
+  void increase_array_() {
+    size_t old_words = words_for_(size_);
+    size_ = size_ * 2;
+    uint64_t* new_bits = new uint64_t[words_for_(size_)];
+    memset(new_bits, 0, words_for_(size_) * sizeof(uint64_t));
+    memcpy(new_bits, bits_, old_words * sizeof(uint64_t));
+    delete[] bits_;
+    bits_ = new_bits;
+  }
+
+  void set_bit_(size_t index, bool value) {
+    uint64_t mask = (uint64_t)1 << (index % 64);
+    if (value) bits_[index / 64] |= mask;
+    else bits_[index / 64] &= ~mask;
+  }
+
+  size_t push(bool to_add) { 
+    if (count_ + 1 > size_)
+      increase_array_();
+    set_bit_(count_, to_add);
+    return count_++;
+  }
+
+  /** Pushes n bools at once, growing the array once at most. */
+  void push_range(const bool* vals, size_t n) {
+    while (count_ + n > size_) increase_array_();
+    for (size_t ii = 0; ii < n; ii++) set_bit_(count_ + ii, vals[ii]);
+    count_ += n;
+  }
+
+  bool get(size_t index) { 
+    assert(count_ > 0 && index < count_);
+    return (bits_[index / 64] >> (index % 64)) & 1;
+  }
+
+  Payload get_payload(size_t index) { return bool_to_payload(get(index)); }
+
+  size_t index_of(bool to_find) { 
+    for (size_t ii = 0; ii < count_; ii++)
+      if (get(ii) == to_find) return ii;
+    return -1;
+  }
+
+  bool remove(size_t index) { 
+    bool element = get(index);
+    for (size_t ii = index; ii < count_ - 1; ii++)
+      set_bit_(ii, get(ii + 1));
+    set_bit_(count_ - 1, false);
+    remove_missing_(index);
+    count_--;
+    return element;
+  }
+
+  bool replace(size_t index, bool to_add) { 
+    bool element = get(index);
+    set_bit_(index, to_add);
+    return element;
+  }
+
+  void clear() {
+    memset(bits_, 0, words_for_(count_) * sizeof(uint64_t));
+    count_ = 0;
+    clear_missing_();
+  }
+
+  size_t serial_len() { return header_serial_len_() + words_for_(count_) * sizeof(uint64_t); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serialize_header_(serializer);
+    serializer.serialize_bytes(bits_, words_for_(count_) * sizeof(uint64_t));
+    return serializer.get_serial();
+  }
 };
 
+/** Doubles stored contiguously, serialized with a single copy. */
 class DoubleArray : public Array {
 public:
+  double* doubles_; // owned
+
   DoubleArray() : DoubleArray(1) { }
-  DoubleArray(const size_t size) : Array('D', size) { }
-  DoubleArray(DoubleArray& arr) : Array(arr) { }
-  DoubleArray(Deserializer& deserializer) : Array(deserializer) { }
+
+  DoubleArray(const size_t size) : Array('D', size, 0, true) { doubles_ = new double[size_]; }
+
+  DoubleArray(DoubleArray& arr) : DoubleArray(arr.size_) { 
+    count_ = arr.count_;
+    memcpy(doubles_, arr.doubles_, count_ * sizeof(double));
+    copy_missing_(arr);
+  }
+
+  // Only count_ elements are allocated, chunks read from the KV_Store never grow
+  DoubleArray(Deserializer& deserializer) : Array(deserializer, true) { 
+    size_ = max(count_, 1);
+    doubles_ = new double[size_];
+    deserializer.deserialize_bytes(doubles_, count_ * sizeof(double));
+  }
+
+  ~DoubleArray() { delete[] doubles_; }
+
   DoubleArray* clone() { return new DoubleArray(*this); }
-  size_t push(double to_add) { return Array::push(double_to_payload(to_add)); }
-  double get(size_t index) { return Array::get(index).d; }
-  size_t index_of(double to_find) { return Array::index_of(double_to_payload(to_find)); }
-  double remove(size_t index) { return Array::remove(index).d; }
-  double replace(size_t index, double to_add) { return Array::replace(index, double_to_payload(to_add)).d;
+
+  bool equals(Object* const obj) {
+    DoubleArray* arr = dynamic_cast<DoubleArray*>(obj);
+    if (!arr || count_ != arr->count_ || !missing_equals_(arr)) return false;
+    for (size_t ii = 0; ii < count_; ii++)
+      if (doubles_[ii] != arr->doubles_[ii]) return false;
+    return true;
+  }
+
+  void increase_array_() {
+    size_ = size_ * 2;
+    double* new_doubles = new double[size_];
+    memcpy(new_doubles, doubles_, count_ * sizeof(double));
+    delete[] doubles_;
+    doubles_ = new_doubles;
+  }
+
+  size_t push(double to_add) { 
+    if (count_ + 1 > size_)
+      increase_array_();
+    doubles_[count_] = to_add;
+    return count_++;
+  }
+
+  /** Pushes n doubles with a single copy. */
+  void push_range(const double* vals, size_t n) {
+    while (count_ + n > size_) increase_array_();
+    memcpy(doubles_ + count_, vals, n * sizeof(double));
+    count_ += n;
+  }
+
+  double get(size_t index) { 
+    assert(count_ > 0 && index < count_);
+    return doubles_[index];
+  }
+
+  Payload get_payload(size_t index) { return double_to_payload(get(index)); }
+
+  size_t index_of(double to_find) { 
+    for (size_t ii = 0; ii < count_; ii++)
+      if (doubles_[ii] == to_find) return ii;
+    return -1;
+  }
+
+  double remove(size_t index) { 
+    double element = get(index);
+    memmove(doubles_ + index, doubles_ + index + 1, (count_ - index - 1) * sizeof(double));
+    remove_missing_(index);
+    count_--;
+    return element;
+  }
+
+  double replace(size_t index, double to_add) { 
+    double element = get(index);
+    doubles_[index] = to_add;
+    return element;
+  }
+
+  size_t serial_len() { return header_serial_len_() + count_ * sizeof(double); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serialize_header_(serializer);
+    serializer.serialize_bytes(doubles_, count_ * sizeof(double));
+    return serializer.get_serial();
+  }
+};
+
+// Header types of the encodings of a serialized IntArray, see IntArray::cheapest_encoding
+const char PLAIN_INT_ENCODING = 'I'; // the ints as they are
+const char FOR_INT_ENCODING = 'F'; // frame of reference, offsets from the min bit packed
+const char DELTA_INT_ENCODING = 'T'; // the first int then the bit packed deltas
+const char RLE_INT_ENCODING = 'R'; // runs of equal ints
+
+/** Packs values of width bits into 64 bit words written to the serializer. */
+class BitPacker_ {
+public:
+  Serializer& serializer_;
+  size_t width_;
+  uint64_t word_;
+  size_t used_; // bits of word_ in use
+
+  BitPacker_(Serializer& serializer, size_t width) : serializer_(serializer) {
+    width_ = width;
+    word_ = 0;
+    used_ = 0;
+  }
+
+  void put(uint64_t value) {
+    if (width_ == 0) return;
+    word_ |= value << used_;
+    used_ += width_;
+    if (used_ >= 64) {
+      serializer_.serialize_bytes(&word_, sizeof(uint64_t));
+      used_ -= 64;
+      word_ = used_ > 0 ? value >> (width_ - used_) : 0;
+    }
+  }
+
+  void flush() {
+    if (used_ > 0) serializer_.serialize_bytes(&word_, sizeof(uint64_t));
+  }
+
+  static size_t words_for(size_t count, size_t width) { return (count * width + 63) / 64; }
+};
+
+/** Reads back the values written by a BitPacker_. */
+class BitUnpacker_ {
+public:
+  Deserializer& deserializer_;
+  size_t width_;
+  uint64_t mask_;
+  uint64_t word_;
+  size_t left_; // bits of word_ not read yet
+
+  BitUnpacker_(Deserializer& deserializer, size_t width) : deserializer_(deserializer) {
+    width_ = width;
+    mask_ = width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+    word_ = 0;
+    left_ = 0;
+  }
+
+  uint64_t get() {
+    if (width_ == 0) return 0;
+    if (left_ >= width_) {
+      uint64_t value = word_ & mask_;
+      word_ = width_ == 64 ? 0 : word_ >> width_;
+      left_ -= width_;
+      return value;
+    }
+    uint64_t value = word_;
+    size_t taken = left_;
+    deserializer_.deserialize_bytes(&word_, sizeof(uint64_t));
+    value |= word_ << taken;
+    word_ = width_ - taken == 64 ? 0 : word_ >> (width_ - taken);
+    left_ = 64 - (width_ - taken);
+    return value & mask_;
+  }
+};
+
+/** Statistics of some ints the encodings are sized from, gathered in one pass. */
+class IntStats_ {
+public:
+  size_t count_;
+  int min_;
+  int max_;
+  int64_t min_delta_;
+  int64_t max_delta_;
+  size_t runs_;
+
+  IntStats_() : IntStats_(nullptr, 0) { }
+
+  IntStats_(const int* ints, size_t count) {
+    count_ = count;
+    min_ = max_ = count > 0 ? ints[0] : 0;
+    min_delta_ = max_delta_ = 0;
+    runs_ = count > 0 ? 1 : 0;
+    for (size_t ii = 1; ii < count; ii++) {
+      int val = ints[ii];
+      int64_t delta = (int64_t)val - ints[ii - 1];
+      if (val < min_) min_ = val;
+      if (val > max_) max_ = val;
+      if (ii == 1 || delta < min_delta_) min_delta_ = delta;
+      if (ii == 1 || delta > max_delta_) max_delta_ = delta;
+      if (delta != 0) runs_++;
+    }
+  }
+
+  /** Number of bits needed to write every value in [0, range]. */
+  static size_t bits_for(uint64_t range) {
+    size_t bits = 0;
+    while (bits < 64 && (range >> bits) != 0) bits++;
+    return bits;
+  }
+
+  size_t for_width() { return bits_for((uint64_t)((int64_t)max_ - min_)); }
+
+  size_t delta_width() { return bits_for((uint64_t)(max_delta_ - min_delta_)); }
+
+  /** Bytes the ints take with the encoding, after the header. */
+  size_t encoded_len(char encoding) {
+    if (encoding == PLAIN_INT_ENCODING || count_ == 0) return count_ * sizeof(int);
+    switch (encoding) {
+      case FOR_INT_ENCODING:
+        return sizeof(int) + sizeof(char)
+          + BitPacker_::words_for(count_, for_width()) * sizeof(uint64_t);
+      case DELTA_INT_ENCODING:
+        return sizeof(int) + sizeof(int64_t) + sizeof(char)
+          + BitPacker_::words_for(count_ - 1, delta_width()) * sizeof(uint64_t);
+      case RLE_INT_ENCODING: return sizeof(size_t) + runs_ * 2 * sizeof(int);
+    }
+    assert(0);
+    return 0;
+  }
+
+  /** The encoding writing the ints to the fewest bytes, plain ones on a tie as they are the
+    * fastest to read back. */
+  char cheapest_encoding() {
+    char encodings[4] = { PLAIN_INT_ENCODING, FOR_INT_ENCODING, DELTA_INT_ENCODING,
+      RLE_INT_ENCODING };
+    char best = PLAIN_INT_ENCODING;
+    for (size_t ii = 1; ii < 4; ii++)
+      if (encoded_len(encodings[ii]) < encoded_len(best)) best = encodings[ii];
+    return best;
   }
 };
 
+/** Ints stored contiguously. They are serialized with a single copy, or encoded to fewer bytes
+  * when set_encoding was given one of the other encodings. Chunks are always plain once read.
+  * set_encoding gathers the statistics the encoders need once, changing the ints afterwards goes
+  * back to the plain encoding. */
 class IntArray : public Array {
 public:
+  int* ints_; // owned
+  char encoding_; // header type the array is serialized with
+  IntStats_ stats_; // of the ints when encoding_ was set, unused by the plain encoding
+
   IntArray() : IntArray(1) { }
-  IntArray(const size_t size) : Array('I', size) { }
-  IntArray(IntArray& arr) : Array(arr) { }
-  IntArray(Deserializer& deserializer) : Array(deserializer) { }
+
+  IntArray(const size_t size) : Array('I', size, 0, true) { 
+    ints_ = new int[size_]; 
+    encoding_ = PLAIN_INT_ENCODING;
+  }
+
+  IntArray(IntArray& arr) : IntArray(arr.size_) { 
+    count_ = arr.count_;
+    encoding_ = arr.encoding_;
+    stats_ = arr.stats_;
+    memcpy(ints_, arr.ints_, count_ * sizeof(int));
+    copy_missing_(arr);
+  }
+
+  // Only count_ elements are allocated, chunks read from the KV_Store never grow
+  IntArray(Deserializer& deserializer) : Array(deserializer, true) { 
+    size_ = max(count_, 1);
+    ints_ = new int[size_];
+    switch (type_) {
+      case FOR_INT_ENCODING: decode_for_(deserializer); break;
+      case DELTA_INT_ENCODING: decode_delta_(deserializer); break;
+      case RLE_INT_ENCODING: decode_rle_(deserializer); break;
+      default: deserializer.deserialize_bytes(ints_, count_ * sizeof(int));
+    }
+    type_ = 'I';
+    encoding_ = PLAIN_INT_ENCODING;
+  }
+
+  ~IntArray() { delete[] ints_; }
+
   IntArray* clone() { return new IntArray(*this); }
-  size_t push(int to_add) { return Array::push(int_to_payload(to_add)); }
-  int get(size_t index) { return Array::get(index).i; }
-  size_t index_of(int to_find) { return Array::index_of(int_to_payload(to_find)); }
-  int remove(size_t index) { return Array::remove(index).i; }
-  int replace(size_t index, int to_add) { return Array::replace(index, int_to_payload(to_add)).i;
+
+  bool equals(Object* const obj) {
+    IntArray* arr = dynamic_cast<IntArray*>(obj);
+    return arr && count_ == arr->count_ && missing_equals_(arr)
+      && memcmp(ints_, arr->ints_, count_ * sizeof(int)) == 0;
+  }
+
+  void increase_array_() {
+    size_ = size_ * 2;
+    int* new_ints = new int[size_];
+    memcpy(new_ints, ints_, count_ * sizeof(int));
+    delete[] ints_;
+    ints_ = new_ints;
+  }
+
+  size_t push(int to_add) { 
+    if (count_ + 1 > size_)
+      increase_array_();
+    encoding_ = PLAIN_INT_ENCODING;
+    ints_[count_] = to_add;
+    return count_++;
+  }
+
+  /** Pushes n ints with a single copy. */
+  void push_range(const int* vals, size_t n) {
+    while (count_ + n > size_) increase_array_();
+    encoding_ = PLAIN_INT_ENCODING;
+    memcpy(ints_ + count_, vals, n * sizeof(int));
+    count_ += n;
+  }
+
+  int get(size_t index) { 
+    assert(count_ > 0 && index < count_);
+    return ints_[index];
+  }
+
+  Payload get_payload(size_t index) { return int_to_payload(get(index)); }
+
+  size_t index_of(int to_find) { 
+    for (size_t ii = 0; ii < count_; ii++)
+      if (ints_[ii] == to_find) return ii;
+    return -1;
+  }
+
+  int remove(size_t index) { 
+    int element = get(index);
+    memmove(ints_ + index, ints_ + index + 1, (count_ - index - 1) * sizeof(int));
+    encoding_ = PLAIN_INT_ENCODING;
+    remove_missing_(index);
+    count_--;
+    return element;
+  }
+
+  int replace(size_t index, int to_add) { 
+    int element = get(index);
+    encoding_ = PLAIN_INT_ENCODING;
+    ints_[index] = to_add;
+    return element;
+  }
+
+  void clear() {
+    count_ = 0;
+    encoding_ = PLAIN_INT_ENCODING;
+    clear_missing_();
+  }
+
+  /** The encoding serializing the ints to the fewest bytes. */
+  char cheapest_encoding() { return IntStats_(ints_, count_).cheapest_encoding(); }
+
+  /** Sets the encoding of the serial, e.g. to cheapest_encoding(). */
+  void set_encoding(char encoding) {
+    set_encoding(encoding, encoding == PLAIN_INT_ENCODING ? IntStats_() : IntStats_(ints_, count_));
+  }
+
+  /** Sets the encoding with the statistics of the ints already gathered, e.g. to pick it. */
+  void set_encoding(char encoding, IntStats_ stats) {
+    encoding_ = encoding;
+    stats_ = stats;
+  }
+
+  size_t encoded_len_() {
+    if (encoding_ == PLAIN_INT_ENCODING) return count_ * sizeof(int);
+    assert(stats_.count_ == count_);
+    return stats_.encoded_len(encoding_);
+  }
+
+  size_t serial_len() { return header_serial_len_() + encoded_len_(); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    char encoding = count_ == 0 ? PLAIN_INT_ENCODING : encoding_;
+    serialize_header_(serializer, encoding);
+    switch (encoding) {
+      case FOR_INT_ENCODING: encode_for_(serializer); break;
+      case DELTA_INT_ENCODING: encode_delta_(serializer); break;
+      case RLE_INT_ENCODING: encode_rle_(serializer); break;
+      default: serializer.serialize_bytes(ints_, count_ * sizeof(int));
+    }
+    return serializer.get_serial();
+  }
+
+  void encode_for_(Serializer& serializer) {
+    int min = stats_.min_;
+    size_t width = stats_.for_width();
+    serializer.serialize_int(min);
+    serializer.serialize_char(width);
+    BitPacker_ packer(serializer, width);
+    for (size_t ii = 0; ii < count_; ii++) packer.put((uint64_t)((int64_t)ints_[ii] - min));
+    packer.flush();
+  }
+
+  void decode_for_(Deserializer& deserializer) {
+    int min = deserializer.deserialize_int();
+    BitUnpacker_ unpacker(deserializer, deserializer.deserialize_char());
+    for (size_t ii = 0; ii < count_; ii++) ints_[ii] = (int)(min + (int64_t)unpacker.get());
+  }
+
+  void encode_delta_(Serializer& serializer) {
+    int64_t min_delta = stats_.min_delta_;
+    size_t width = stats_.delta_width();
+    serializer.serialize_int(ints_[0]);
+    serializer.serialize_bytes(&min_delta, sizeof(int64_t));
+    serializer.serialize_char(width);
+    BitPacker_ packer(serializer, width);
+    for (size_t ii = 1; ii < count_; ii++) 
+      packer.put((uint64_t)((int64_t)ints_[ii] - ints_[ii - 1] - min_delta));
+    packer.flush();
+  }
+
+  void decode_delta_(Deserializer& deserializer) {
+    ints_[0] = deserializer.deserialize_int();
+    int64_t min_delta;
+    deserializer.deserialize_bytes(&min_delta, sizeof(int64_t));
+    BitUnpacker_ unpacker(deserializer, deserializer.deserialize_char());
+    for (size_t ii = 1; ii < count_; ii++) 
+      ints_[ii] = (int)(ints_[ii - 1] + min_delta + (int64_t)unpacker.get());
+  }
+
+  void encode_rle_(Serializer& serializer) {
+    serializer.serialize_size_t(stats_.runs_);
+    size_t run_start = 0;
+    for (size_t ii = 1; ii <= count_; ii++) {
+      if (ii == count_ || ints_[ii] != ints_[run_start]) {
+        serializer.serialize_int(ints_[run_start]);
+        serializer.serialize_int(ii - run_start);
+        run_start = ii;
+      }
+    }
+  }
+
+  void decode_rle_(Deserializer& deserializer) {
+    size_t runs = deserializer.deserialize_size_t();
+    size_t ii = 0;
+    for (size_t run = 0; run < runs; run++) {
+      int val = deserializer.deserialize_int();
+      int length = deserializer.deserialize_int();
+      for (int jj = 0; jj < length; jj++) ints_[ii++] = val;
+    }
   }
 };
 
@@ -240,6 +884,9 @@ public:
   ObjectArray(size_t size) : Array('O', size) { }
   ObjectArray(ObjectArray& arr) : Array(arr) { }
   ObjectArray(Deserializer& deserializer) : Array(deserializer) { }
+  /** For subclasses keeping their objects their own way, as DictStringArray does */
+  ObjectArray(size_t size, bool dense) : Array('O', size, 0, dense) { }
+  ObjectArray(Deserializer& deserializer, bool dense) : Array(deserializer, dense) { }
   ObjectArray* clone() { return new ObjectArray(*this); }
   virtual size_t push(Object* const to_add) { return Array::push(object_to_payload(to_add ? to_add->clone() : nullptr)); }
   Object* get(size_t index) { return Array::get(index).o; }
@@ -255,19 +902,456 @@ public:
   StringArray() : StringArray(1) {  }
   StringArray(size_t size) : ObjectArray(size) { }
   StringArray(StringArray& arr) : ObjectArray(arr) { }
+  StringArray(size_t size, bool dense) : ObjectArray(size, dense) { }
+  StringArray(Deserializer& deserializer, bool dense) : ObjectArray(deserializer, dense) { }
   
   StringArray(Deserializer& deserializer) : ObjectArray(deserializer) {
     for (size_t ii = 0; ii < count_; ii++) 
-      elements_[ii].o = new String(deserializer);
+      elements_[ii].o = is_missing(ii) ? nullptr : new String(deserializer);
   }
 
+  /** A nullptr string is a missing element, only the strings present are kept and serialized. */
   size_t push(Object* const to_add) { 
     assert(to_add == nullptr || dynamic_cast<String*>(to_add));
-    return ObjectArray::push(to_add); 
+    size_t index = ObjectArray::push(to_add); 
+    if (to_add == nullptr) set_missing(index);
+    return index;
+  }
+
+  /** Pushes the string itself instead of a copy, the array now owns it. */
+  virtual size_t push_owned(String* to_add) {
+    size_t index = Array::push(object_to_payload(to_add));
+    if (to_add == nullptr) set_missing(index);
+    return index;
   }
 
   StringArray* clone() { return new StringArray(*this); }
   String* get(size_t index) { return static_cast<String*>(ObjectArray::get(index)); }
-  String* remove(size_t index) { return static_cast<String*>(ObjectArray::remove(index)); }
-  String* replace(size_t index, String* const to_add) { return static_cast<String*>(ObjectArray::replace(index, to_add)); }
-};
\ No newline at end of file
+  /** Removes the element and returns its string, owned by the caller. */
+  virtual String* remove(size_t index) {
+    return static_cast<String*>(ObjectArray::remove(index));
+  }
+  /** Replaces the element with a copy of the string, returns the old one owned by the caller. */
+  virtual String* replace(size_t index, String* const to_add) {
+    set_missing(index, to_add == nullptr);
+    return static_cast<String*>(ObjectArray::replace(index, to_add));
+  }
+};
+
+// Header type of a serialized DictStringArray, which is an 'O' Array once read back
+const char DICT_STRING_ARRAY_TYPE = 'K';
+
+/**
+ * A StringArray stored as a dictionary of its distinct strings plus the code of every element, the
+ * index of its string in the dictionary. Repeated strings are kept and serialized once, with codes
+ * of 1, 2 or 4 bytes depending on the size of the dictionary. Equality tests and grouping can
+ * compare the codes instead of the strings. Elements are read through the dictionary, which
+ * keeps the strings of removed or replaced elements.
+ */
+class DictStringArray : public StringArray {
+public:
+  StringArray* dict_; // owned, distinct strings in order of first appearance
+  IntArray* codes_; // owned
+  int* slots_; // owned, open addressing table of the codes by string hash, -1 when empty
+  size_t num_slots_;
+
+  DictStringArray() : StringArray(1, true) {
+    dict_ = new StringArray(1);
+    codes_ = new IntArray(1);
+    build_slots_();
+  }
+
+  DictStringArray(DictStringArray& arr) : StringArray(1, true) {
+    dict_ = arr.dict_->clone();
+    codes_ = arr.codes_->clone();
+    count_ = arr.count_;
+    copy_missing_(arr);
+    build_slots_();
+  }
+
+  DictStringArray(Deserializer& deserializer) : StringArray(deserializer, true) {
+    assert(type_ == DICT_STRING_ARRAY_TYPE);
+    type_ = 'O';
+    dict_ = new StringArray(deserializer);
+    size_t code_width = deserializer.deserialize_char();
+    codes_ = new IntArray(max(count_, 1));
+    int* codes = codes_->ints_;
+    if (code_width == sizeof(int)) {
+      deserializer.deserialize_bytes(codes, count_ * sizeof(int));
+    } else {
+      for (size_t ii = 0; ii < count_; ii++) {
+        if (code_width == sizeof(uint8_t)) {
+          uint8_t code;
+          deserializer.deserialize_bytes(&code, sizeof(uint8_t));
+          codes[ii] = code;
+        } else {
+          uint16_t code;
+          deserializer.deserialize_bytes(&code, sizeof(uint16_t));
+          codes[ii] = code;
+        }
+      }
+    }
+    codes_->count_ = count_;
+    for (size_t ii = 0; ii < count_ && num_missing_ > 0; ii++)
+      if (is_missing(ii)) codes[ii] = -1;
+    build_slots_();
+  }
+
+  ~DictStringArray() {
+    delete dict_;
+    delete codes_;
+    delete[] slots_;
+  }
+
+  /** Encodes the strings, or returns nullptr if there are more than max_distinct of them. The
+    * missing strings stay missing. */
+  static DictStringArray* encode(StringArray& strings, size_t max_distinct) {
+    DictStringArray* encoded = new DictStringArray();
+    for (size_t ii = 0; ii < strings.length(); ii++) {
+      String* str = strings.get(ii);
+      if (str != nullptr && encoded->code_of(str) == -1
+          && encoded->dict_->length() == max_distinct) {
+        delete encoded;
+        return nullptr;
+      }
+      encoded->push(str);
+    }
+    return encoded;
+  }
+
+  void build_slots_() {
+    num_slots_ = 16;
+    while (num_slots_ < dict_->length() * 2) num_slots_ *= 2;
+    slots_ = new int[num_slots_];
+    for (size_t ii = 0; ii < num_slots_; ii++) slots_[ii] = -1;
+    for (size_t ii = 0; ii < dict_->length(); ii++) slots_[find_slot_(dict_->get(ii))] = ii;
+  }
+
+  /** The slot holding the code of the string, or the empty slot it would go in. */
+  size_t find_slot_(String* str) {
+    size_t slot = str->hash() & (num_slots_ - 1);
+    while (slots_[slot] != -1 && !dict_->get(slots_[slot])->equals(str))
+      slot = (slot + 1) & (num_slots_ - 1);
+    return slot;
+  }
+
+  /** Returns the code of the string, or -1 if it is not in the dictionary. */
+  int code_of(String* str) { return slots_[find_slot_(str)]; }
+
+  /** Returns the code of the string, adding it to the dictionary if it is not in it yet. */
+  int add_code_(String* str) {
+    size_t slot = find_slot_(str);
+    int code = slots_[slot];
+    if (code == -1) {
+      code = dict_->length();
+      dict_->push(str);
+      slots_[slot] = code;
+      if (dict_->length() * 2 > num_slots_) {
+        delete[] slots_;
+        build_slots_();
+      }
+    }
+    return code;
+  }
+
+  /** A nullptr string is a missing element, its code is -1. */
+  size_t push(Object* const to_add) {
+    if (to_add == nullptr) {
+      codes_->push(-1);
+      set_missing(count_++);
+      return count_ - 1;
+    }
+    String* str = dynamic_cast<String*>(to_add);
+    assert(str);
+    codes_->push(add_code_(str));
+    return count_++;
+  }
+
+  /** The dictionary keeps its own copy, the string is deleted. */
+  size_t push_owned(String* to_add) {
+    size_t index = push(to_add);
+    delete to_add;
+    return index;
+  }
+
+  String* remove(size_t index) {
+    String* removed = get(index) ? get(index)->clone() : nullptr;
+    codes_->remove(index);
+    remove_missing_(index);
+    count_--;
+    return removed;
+  }
+
+  String* replace(size_t index, String* const to_add) {
+    String* replaced = get(index) ? get(index)->clone() : nullptr;
+    codes_->replace(index, to_add ? add_code_(to_add) : -1);
+    set_missing(index, to_add == nullptr);
+    return replaced;
+  }
+
+  Payload get_payload(size_t index) {
+    assert(index < count_);
+    if (is_missing(index)) return object_to_payload(nullptr);
+    return object_to_payload(dict_->get(codes_->ints_[index]));
+  }
+
+  void clear() {
+    dict_->clear();
+    codes_->clear();
+    delete[] slots_;
+    build_slots_();
+    count_ = 0;
+    clear_missing_();
+  }
+
+  DictStringArray* clone() { return new DictStringArray(*this); }
+
+  StringArray* dictionary() { return dict_; }
+
+  /** The code of every element, valid for indexes [0, length()). */
+  int* codes() { return codes_->ints_; }
+
+  size_t code_width_() {
+    if (dict_->length() <= UINT8_MAX + 1) return sizeof(uint8_t);
+    if (dict_->length() <= UINT16_MAX + 1) return sizeof(uint16_t);
+    return sizeof(int);
+  }
+
+  size_t serial_len() {
+    return header_serial_len_() + dict_->serial_len() + sizeof(char) + count_ * code_width_();
+  }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serialize_header_(serializer, DICT_STRING_ARRAY_TYPE); // the missing codes are read back as -1
+    serializer.serialize_object(dict_);
+    size_t code_width = code_width_();
+    serializer.serialize_char(code_width);
+    int* codes = codes_->ints_;
+    if (code_width == sizeof(int)) {
+      serializer.serialize_bytes(codes, count_ * sizeof(int));
+    } else {
+      for (size_t ii = 0; ii < count_; ii++) {
+        if (code_width == sizeof(uint8_t)) {
+          uint8_t code = codes[ii];
+          serializer.serialize_bytes(&code, sizeof(uint8_t));
+        } else {
+          uint16_t code = codes[ii];
+          serializer.serialize_bytes(&code, sizeof(uint16_t));
+        }
+      }
+    }
+    return serializer.get_serial();
+  }
+};
+
+// Header type of a serialized BlobStringArray, which is an 'O' Array once read back
+const char BLOB_STRING_ARRAY_TYPE = 'V';
+
+/**
+ * A StringArray keeping its characters in a single blob, every string followed by its terminator,
+ * and the offset of every string in it. It is read back with two copies, of the offsets and of the
+ * blob, instead of allocating every string. Its elements are Strings viewing the blob, owned by
+ * the array and valid as long as it is. Missing elements take no room in the blob. The first
+ * change to its elements turns it into a plain StringArray owning a copy of every string, see
+ * own_elements_.
+ */
+class BlobStringArray : public StringArray {
+public:
+  uint32_t* offsets_; // owned, element ii starts at offsets_[ii], the blob is offsets_[count_] long
+  char* blob_; // owned
+  String* views_; // owned, raw storage of a String per element, constructed for those present
+  // Once own_elements_ ran, elements_ holds the strings and offsets_, blob_ and views_ are nullptr
+
+  /** Copies the strings into a blob. */
+  BlobStringArray(StringArray& strings) : StringArray(max(strings.length(), 1), true) {
+    copy_strings_(strings);
+  }
+
+  BlobStringArray(BlobStringArray& arr) : StringArray(max(arr.count_, 1), true) {
+    if (arr.elements_ != nullptr) {
+      copy_strings_(arr);
+      return;
+    }
+    count_ = arr.count_;
+    copy_missing_(arr);
+    offsets_ = new uint32_t[count_ + 1];
+    memcpy(offsets_, arr.offsets_, (count_ + 1) * sizeof(uint32_t));
+    blob_ = new char[max(arr.blob_len_(), 1)];
+    memcpy(blob_, arr.blob_, arr.blob_len_());
+    build_views_();
+  }
+
+  BlobStringArray(Deserializer& deserializer) : StringArray(deserializer, true) {
+    assert(type_ == BLOB_STRING_ARRAY_TYPE);
+    type_ = 'O';
+    offsets_ = new uint32_t[count_ + 1];
+    deserializer.deserialize_bytes(offsets_, (count_ + 1) * sizeof(uint32_t));
+    blob_ = new char[max(blob_len_(), 1)];
+    deserializer.deserialize_bytes(blob_, blob_len_());
+    build_views_();
+  }
+
+  ~BlobStringArray() {
+    if (views_ != nullptr) delete_views_();
+    delete[] blob_;
+    delete[] offsets_;
+  }
+
+  /** Bytes the strings would be serialized to as a blob, without copying them into one. */
+  static size_t serial_len_of(StringArray& strings) {
+    size_t blob_len = 0;
+    for (size_t ii = 0; ii < strings.length(); ii++)
+      if (!strings.is_missing(ii)) blob_len += strings.get(ii)->size() + 1;
+    return strings.header_serial_len_() + (strings.length() + 1) * sizeof(uint32_t) + blob_len;
+  }
+
+  void copy_strings_(StringArray& strings) {
+    count_ = strings.length();
+    copy_missing_(strings);
+    offsets_ = new uint32_t[count_ + 1];
+    size_t blob_len = 0;
+    for (size_t ii = 0; ii < count_; ii++) {
+      offsets_[ii] = blob_len;
+      if (!is_missing(ii)) blob_len += strings.get(ii)->size() + 1;
+      assert(blob_len <= UINT32_MAX);
+    }
+    offsets_[count_] = blob_len;
+    blob_ = new char[max(blob_len, 1)];
+    for (size_t ii = 0; ii < count_; ii++) {
+      if (is_missing(ii)) continue;
+      memcpy(blob_ + offsets_[ii], strings.get(ii)->c_str(), string_len_(ii) + 1);
+    }
+    build_views_();
+  }
+
+  size_t blob_len_() { return offsets_[count_]; }
+
+  /** Characters of the idx-th string, without its terminator. */
+  size_t string_len_(size_t idx) { return offsets_[idx + 1] - offsets_[idx] - 1; }
+
+  /** Constructs the view of every element present, the Strings steal their characters from the
+    * blob and give them back before being destroyed. */
+  void build_views_() {
+    views_ = static_cast<String*>(::operator new(max(count_, 1) * sizeof(String)));
+    for (size_t ii = 0; ii < count_; ii++)
+      if (!is_missing(ii)) new (views_ + ii) String(true, blob_ + offsets_[ii], string_len_(ii));
+  }
+
+  void delete_views_() {
+    for (size_t ii = 0; ii < count_; ii++) {
+      if (is_missing(ii)) continue;
+      views_[ii].steal();
+      views_[ii].~String();
+    }
+    ::operator delete(views_);
+  }
+
+  /** Copies every string out of the blob into elements_, which then hold the elements as in any
+    * StringArray, and frees the blob. */
+  void own_elements_() {
+    if (elements_ != nullptr) return;
+    elements_ = new Payload[size_];
+    for (size_t ii = 0; ii < count_; ii++) {
+      if (is_missing(ii)) elements_[ii].o = nullptr;
+      else elements_[ii].o = new String(blob_ + offsets_[ii], string_len_(ii));
+    }
+    delete_views_();
+    delete[] blob_;
+    delete[] offsets_;
+    views_ = nullptr;
+    blob_ = nullptr;
+    offsets_ = nullptr;
+  }
+
+  size_t push(Object* const to_add) {
+    own_elements_();
+    return StringArray::push(to_add);
+  }
+
+  size_t push_owned(String* to_add) {
+    own_elements_();
+    return StringArray::push_owned(to_add);
+  }
+
+  String* remove(size_t index) {
+    own_elements_();
+    return StringArray::remove(index);
+  }
+
+  String* replace(size_t index, String* const to_add) {
+    own_elements_();
+    return StringArray::replace(index, to_add);
+  }
+
+  Payload get_payload(size_t index) {
+    if (elements_ != nullptr) return StringArray::get_payload(index);
+    assert(index < count_);
+    return object_to_payload(is_missing(index) ? nullptr : views_ + index);
+  }
+
+  /** Characters of the idx-th string, read straight from the blob, nullptr if it is missing. */
+  char* chars(size_t idx) {
+    if (is_missing(idx)) return nullptr;
+    return elements_ != nullptr ? get(idx)->c_str() : blob_ + offsets_[idx];
+  }
+
+  /** Whether the idx-th string has the given characters, without looking at its view. */
+  bool chars_equal(size_t idx, const char* str, size_t len) {
+    if (is_missing(idx)) return false;
+    if (elements_ != nullptr) return get(idx)->size() == len && memcmp(chars(idx), str, len) == 0;
+    if (string_len_(idx) != len) return false;
+    return memcmp(blob_ + offsets_[idx], str, len) == 0;
+  }
+
+  void clear() {
+    if (elements_ != nullptr) {
+      StringArray::clear();
+      return;
+    }
+    delete_views_();
+    count_ = 0;
+    offsets_[0] = 0;
+    clear_missing_();
+    build_views_();
+  }
+
+  BlobStringArray* clone() { return new BlobStringArray(*this); }
+
+  size_t serial_len() {
+    if (elements_ != nullptr) return StringArray::serial_len();
+    return header_serial_len_() + (count_ + 1) * sizeof(uint32_t) + blob_len_();
+  }
+
+  char* serialize() {
+    if (elements_ != nullptr) return StringArray::serialize();
+    Serializer serializer(serial_len());
+    serialize_header_(serializer, BLOB_STRING_ARRAY_TYPE);
+    serializer.serialize_bytes(offsets_, (count_ + 1) * sizeof(uint32_t));
+    serializer.serialize_bytes(blob_, blob_len_());
+    return serializer.get_serial();
+  }
+};
+
+/** Reads back a StringArray, or the DictStringArray or BlobStringArray that was serialized. */
+StringArray* deserialize_string_array(Deserializer& deserializer) {
+  size_t start = deserializer.get_serial_index();
+  deserializer.deserialize_size_t(); // size_
+  deserializer.deserialize_size_t(); // count_
+  char type = deserializer.deserialize_char() & ~MISSING_ELEMENTS_FLAG;
+  deserializer.set_serial_index(start);
+  if (type == DICT_STRING_ARRAY_TYPE) return new DictStringArray(deserializer);
+  if (type == BLOB_STRING_ARRAY_TYPE) return new BlobStringArray(deserializer);
+  return new StringArray(deserializer);
+}
+
+/** Reads back an array of elements of the given column type, 'I', 'D', 'B' or 'S'. */
+Array* deserialize_array(Deserializer& deserializer, char type) {
+  switch (type) {
+    case 'I': return new IntArray(deserializer);
+    case 'D': return new DoubleArray(deserializer);
+    case 'B': return new BoolArray(deserializer);
+    case 'S': return deserialize_string_array(deserializer);
+  }
+  assert(0);
+}
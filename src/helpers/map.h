@@ -227,7 +227,7 @@ class Map: public Object {
         }
 
         virtual Array* key_set() {
-            ObjectArray* keys = new ObjectArray(count_);
+            ObjectArray* keys = new ObjectArray(max(count_, 1));
             for (size_t ii = 0; ii < buckets_size_; ii++) {
                 ObjectArray* bucket_array = dynamic_cast<ObjectArray*>(buckets_->get(ii));
                 for (size_t jj = 0; jj < bucket_array->length(); jj++) {
@@ -255,7 +255,7 @@ class SIMap : public Map {
     Num* remove(String* s) { return dynamic_cast<Num*>(Map::remove(s)); }
     StringArray* key_set() { 
         ObjectArray* key_set = dynamic_cast<ObjectArray*>(Map::key_set()); 
-        StringArray* keys = new StringArray(key_set->length());
+        StringArray* keys = new StringArray(max(key_set->length(), 1));
         for (size_t ii = 0; ii < key_set->length(); ii++) keys->push(key_set->get(ii));
         delete key_set;
         return keys;
@@ -71,6 +71,12 @@ class Serializer : public Object {
         serial_index_ += char_array_size;
     }
 
+    /** Copies len raw bytes in one go, used for dense arrays of primitives */
+    void serialize_bytes(const void* bytes, size_t len) {
+        memcpy(serial_ + serial_index_, bytes, len);
+        serial_index_ += len;
+    }
+
     void serialize_object(Object* object) {
         size_t object_serial_size = object->serial_len();
         char* object_serial = object->serialize();
@@ -168,6 +174,12 @@ class Deserializer {
         return char_value;
     }
 
+    /** Copies len raw bytes into dest in one go, the mirror of Serializer::serialize_bytes */
+    void deserialize_bytes(void* dest, size_t len) {
+        memcpy(dest, &serial_[serial_index_], len);
+        serial_index_ += len;
+    }
+
     // NOTE: The char_array_size does NOT include the null terminator at the end
     // NOTE: The returned char array must be deleted as well
     char* deserialize_char_array(size_t char_array_size) {
@@ -24,29 +24,23 @@ size_t MAX_SCHEMA_READ = 500;
 // NOTE: The DataFrame is NOT deleted, and must be grabbed and deleted independently
 class SoR {
     private:
+    // A field is missing when the line ends before it or it is written <>, unlike <"">
+    bool is_missing_from_line_(StringArray* line, size_t index) {
+        return index >= line->length() || line->is_missing(index);
+    }
+
     String* get_string_from_line_(StringArray* line, size_t index) {
-        if (index < line->length())
-            return line->get(index);
-        else
-            return &DEFAULT_STRING_VALUE;
+        return line->get(index);
     }
 
     double get_double_from_line_(StringArray* line, size_t index) {
-        if (index < line->length()) {
-            String* element = line->get(index);
-            return stof(element->c_str());
-        }
-        else
-            return DEFAULT_DOUBLE_VALUE;
+        String* element = line->get(index);
+        return stof(element->c_str());
     }
 
     int get_int_from_line_(StringArray* line, size_t index) {
-        if (index < line->length()) {
-            String* element = line->get(index);
-            return atoi(element->c_str());
-        }
-        else
-            return DEFAULT_INT_VALUE;
+        String* element = line->get(index);
+        return atoi(element->c_str());
     }
 
     bool get_bool_(String* element) {
@@ -54,19 +48,21 @@ class SoR {
     }
 
     bool get_bool_from_line_(StringArray* line, size_t index) {
-        if (index < line->length()) {
-            String* element = line->get(index);
-            return get_bool_(element);
-        }
-        else
-            return DEFAULT_BOOL_VALUE;
+        String* element = line->get(index);
+        return get_bool_(element);
     }
 
     void add_line_(StringArray* line) {
         Schema schema(cols_types_);
-        Row row(schema);
+        // The row borrows the strings of the line, the builder copies them
+        Row row(schema, true);
         for (int i = 0; i < schema.width(); i++) {
             char type = schema.col_type(i);
+            // Missing fields are marked as such instead of holding a default value
+            if (is_missing_from_line_(line, i)) {
+                row.set_missing(i);
+                continue;
+            }
             // NOTE: There is no checking to make sure that a value being input into the Row's 
             // Column is correct, it will cast whatever it is given. Example:
             // column_types = <STRING><INT>
@@ -270,13 +266,15 @@ class SoR {
                     break;
                 case '>': {
                     size_t bytes = buf_index - string_start_;
-                    if (buf_[string_start_] == '\"') {
+                    bool quoted = buf_[string_start_] == '\"';
+                    if (quoted) {
                         string_start_++;
                         bytes -= 2;
                     }
                     String file_line_string(buf_ + string_start_, bytes);
                     string_start_ = buf_index + 1;
-                    current_line.push(&file_line_string);               
+                    // An empty field without quotes is a missing one
+                    current_line.push(bytes == 0 && !quoted ? nullptr : &file_line_string);
                     break;
                 }
                 default:
@@ -3,6 +3,11 @@
 #include "../dataframe/dataframe.h"
 #include "../helpers/sor.h"
 #include "../dataframe/dataframe_builder.h"
+#include "../dataframe/filter_rower.h"
+#include "../dataframe/bool_op_rower.h"
+#include "../dataframe/join_rower.h"
+#include "../dataframe/group_by_rower.h"
+#include "../dataframe/sort_rower.h"
 
 class KD_Store {
     public:
@@ -10,10 +15,12 @@ class KD_Store {
 
     KD_Store(size_t node_index) {
         kv_ = new KV_Store(node_index);
+        kv_->set_rower_runner(run_shipped_rower);
     }
 
     KD_Store(size_t node_index, const char* my_ip, const char* server_ip) {
         kv_ = new KV_Store(my_ip, server_ip, node_index);
+        kv_->set_rower_runner(run_shipped_rower);
         kv_->connect_to_server(node_index);
         kv_->run_server(200);
     }
@@ -54,15 +61,11 @@ DataFrame* make_new_dataframe_from_array_(Key* key, KD_Store* kd, size_t num, co
     int* int_array, double* double_array, bool* bool_array, String** string_array) {
     Schema schema(type);
     DataFrameBuilder df_builder(schema, key->get_key(), kd->get_kv());
-    Row row(schema);
-    for (size_t ii = 0; ii < num; ii++) {
-        switch(type[0]) {
-            case 'I': row.set(0, int_array[ii]); break;
-            case 'D': row.set(0, double_array[ii]); break;
-            case 'B': row.set(0, bool_array[ii]); break;
-            case 'S': row.set(0, string_array[ii]); break;
-        }
-        df_builder.add_row(row);
+    switch(type[0]) {
+        case 'I': df_builder.append_column_range(0, int_array, num); break;
+        case 'D': df_builder.append_column_range(0, double_array, num); break;
+        case 'B': df_builder.append_column_range(0, bool_array, num); break;
+        case 'S': df_builder.append_column_range(0, string_array, num); break;
     }
     DataFrame* d = df_builder.done();
     kd->put(key, d);
@@ -92,13 +95,206 @@ DataFrame* DataFrame::from_file(Key* key, KD_Store* kd, char* file_name) {
     return sor.get_dataframe();
 }
 
+/** Builds a frame of the rows the rower sets until it returns true. The strings of every row are
+  * moved into the frame, so the rower has to set every string field of every row. */
 DataFrame* DataFrame::from_rower(Key* key, KD_Store* kd, const char* types, Rower& rower) {
     Schema schema(types);
     DataFrameBuilder df_builder(schema, key->get_key(), kd->get_kv());
     Row row(schema);
     while (!rower.accept(row)) 
-        df_builder.add_row(row);
+        df_builder.move_row(row);
     DataFrame* df = df_builder.done();
     kd->put(key, df);
     return df;
 }
+
+/** Keeps the rows accepted by the predicate, which has to be registered in the rower_registry() and
+  * clonable. Every node filters the chunks it holds in parallel and the rows it keeps are written
+  * to chunks homed on that node. Rows kept by a node stay in order, those of this node come first
+  * and those of the other nodes follow in node order. */
+DataFrame* DataFrame::filter(Key* key, KD_Store* kd, Rower& r) {
+    IntArray* chunks = all_chunks_();
+    DataFrame* df = filter_(key, kd, r, chunks);
+    delete chunks;
+    return df;
+}
+
+/** Same as filter, for a predicate that only accepts rows for which element op value holds in the
+  * column. Chunks ruled out by their zone map are skipped without being read. */
+DataFrame* DataFrame::filter(Key* key, KD_Store* kd, Rower& r, size_t col, CmpOp op, 
+    double value) {
+    IntArray* chunks = chunks_where(col, op, value);
+    DataFrame* df = filter_(key, kd, r, chunks);
+    delete chunks;
+    return df;
+}
+
+/** Keeps the rows whose 'S' column equals value. The chunks are filtered where they are held as
+  * by filter, on the codes of the dictionary encoded ones, see EqualStringsFilterRower. */
+DataFrame* DataFrame::filter(Key* key, KD_Store* kd, size_t col, String* value) {
+    EqualStringsFilterRower filter_rower(key->get_key(), schema_, col, value, kv_);
+    ship_map(filter_rower);
+    DataFrame* df = filter_rower.take();
+    kd->put(key, df);
+    return df;
+}
+
+/** Inner equi-join of two frames on an 'I' or 'S' column of each, stored under out_key. The joined
+  * rows hold the columns of left then those of right and come in no particular order. A hash
+  * table is built from the smaller frame on every node holding chunks of the larger one, which
+  * then probe it with their local chunks and keep the joined rows through builders pinned to
+  * themselves. Broadcast builds every table from the whole smaller frame, Partitioned first
+  * hash partitions both frames over the nodes and builds each table from the local partition. */
+DataFrame* DataFrame::join(DataFrame* left, DataFrame* right, size_t left_col, size_t right_col,
+    Key* out_key, KD_Store* kd, JoinStrategy strategy) {
+    char key_type = left->get_schema().col_type(left_col);
+    assert((key_type == 'I' || key_type == 'S') 
+      && right->get_schema().col_type(right_col) == key_type);
+    Schema schema(left->get_schema().types_->c_str());
+    for (size_t ii = 0; ii < right->ncols(); ii++) 
+        schema.add_column(right->get_schema().col_type(ii));
+
+    bool build_is_left = left->nrows() < right->nrows();
+    DataFrame* build = build_is_left ? left : right;
+    DataFrame* probe = build_is_left ? right : left;
+    size_t build_col = build_is_left ? left_col : right_col;
+    size_t probe_col = build_is_left ? right_col : left_col;
+    if (strategy == JoinStrategy::Auto) {
+        strategy = build->nrows() <= BROADCAST_JOIN_MAX_ROWS 
+          ? JoinStrategy::Broadcast : JoinStrategy::Partitioned;
+    }
+    bool partitioned = strategy == JoinStrategy::Partitioned;
+    if (partitioned) {
+        size_t num_parts = kd->get_kv()->get_num_other_nodes();
+        String build_name(*out_key->get_key());
+        build_name.concat("_build");
+        build = build->partition_(&build_name, build_col, num_parts);
+        String probe_name(*out_key->get_key());
+        probe_name.concat("_probe");
+        probe = probe->partition_(&probe_name, probe_col, num_parts);
+    }
+
+    JoinRower join_rower(out_key->get_key(), schema, probe_col, *build, build_col, build_is_left,
+      !partitioned, kd->get_kv());
+    probe->ship_map(join_rower);
+    DataFrame* df = join_rower.take();
+    kd->put(out_key, df);
+    if (partitioned) {
+        delete build;
+        delete probe;
+    }
+    return df;
+}
+
+/** Groups the rows of the frame by the values of the key columns and computes the aggregates of
+  * every group, stored under out_key. The result holds the key columns then the result of every
+  * aggregate, 'I' for Count and 'D' otherwise, one row per group in no particular order. Every
+  * node first aggregates its chunks with a hash table per thread and sends the partial result of
+  * each group to the node its keys hash to, which all then finish their groups in parallel. */
+DataFrame* DataFrame::group_by(Key* out_key, KD_Store* kd, IntArray& key_cols, 
+    GroupAggregates& aggregates) {
+    assert(key_cols.length() > 0);
+    String partial_name(*out_key->get_key());
+    partial_name.concat("_partial");
+    GroupByRower partial_rower(&partial_name, schema_, key_cols, aggregates, false, 
+      kd->get_kv()->get_num_other_nodes(), kv_);
+    ship_map(partial_rower);
+    DataFrame* partials = partial_rower.take();
+
+    IntArray partial_keys(key_cols.length());
+    for (size_t ii = 0; ii < key_cols.length(); ii++) partial_keys.push(ii);
+    GroupByRower final_rower(out_key->get_key(), partials->get_schema(), partial_keys, aggregates,
+      true, 1, kv_);
+    partials->ship_map(final_rower);
+    DataFrame* df = final_rower.take();
+    kd->put(out_key, df);
+    delete partials;
+    return df;
+}
+
+/** Sorts the rows of the frame on the by columns, most significant first, into a frame stored
+  * under out_key. Rows with equal keys keep their relative order on a single node. With several
+  * nodes the frame is first split into one range of keys per node, cut at splitters picked from
+  * a sample of the keys, so every node sorts its range on its own. Each node sorts runs of at most
+  * max_rows_in_memory rows per thread, spilling them to temporary files, then merges them into
+  * the chunks of its range, which stay homed on it. */
+DataFrame* DataFrame::sort(Key* out_key, KD_Store* kd, IntArray& by_cols, bool ascending,
+    size_t max_rows_in_memory) {
+    SortKey sort_key(schema_, by_cols, ascending);
+    size_t num_parts = kd->get_kv()->get_num_other_nodes();
+    DataFrame* ranges = this;
+    if (num_parts > 1) {
+        SampleRower sample_rower(sort_key, ::max(nrows() / (num_parts * SORT_SAMPLES_PER_NODE), 1));
+        ship_map(sample_rower);
+        Splitters splitters(sort_key, sample_rower.sample_, num_parts);
+        String range_name(*out_key->get_key());
+        range_name.concat("_range");
+        ranges = partition_(&range_name, by_cols.get(0), num_parts, &splitters);
+    }
+
+    // The chunks of range p follow those of the ranges before it, SortRower cuts them at
+    // chunk_rows rows
+    size_t chunk_rows = chunk_rows_for(schema_, DEFAULT_CHUNK_BYTES);
+    size_t* range_rows = new size_t[num_parts];
+    for (size_t ii = 0; ii < num_parts; ii++) range_rows[ii] = 0;
+    for (size_t ii = 0; ii < ranges->num_chunks(); ii++)
+        range_rows[ranges->chunk_home_node(ii) % num_parts] += ranges->chunk_length(ii);
+    IntArray first_chunks(num_parts);
+    size_t next_chunk = 0;
+    for (size_t ii = 0; ii < num_parts; ii++) {
+        first_chunks.push(next_chunk);
+        next_chunk += (range_rows[ii] + chunk_rows - 1) / chunk_rows;
+    }
+    delete[] range_rows;
+
+    SortRower sort_rower(sort_key, out_key->get_key(), max_rows_in_memory, first_chunks, kv_);
+    ranges->ship_map(sort_rower);
+    DataFrame* df = sort_rower.take();
+    kd->put(out_key, df);
+    if (ranges != this) delete ranges;
+    return df;
+}
+
+/** Hash partitions the rows of the frame on the column into a frame whose chunks of partition p
+  * are homed on node p, owned by the caller. Given splitters, the rows are split by range of the
+  * sort key instead. */
+DataFrame* DataFrame::partition_(String* name, size_t col, size_t num_parts,
+    Splitters* splitters) {
+    PartitionRower partition_rower(name, schema_, col, num_parts, kv_, splitters);
+    ship_map(partition_rower);
+    return partition_rower.take();
+}
+
+DataFrame* DataFrame::filter_(Key* key, KD_Store* kd, Rower& r, IntArray* chunks) {
+    FilterRower filter_rower(key->get_key(), schema_, r, kv_);
+    ship_map_(filter_rower, chunks);
+    DataFrame* df = filter_rower.take();
+    kd->put(key, df);
+    return df;
+}
+
+/** Computes a op b between two 'B' columns into a one column frame, every node computing the
+  * chunks it holds. The chunks of the result are homed with the rows they were computed from. */
+DataFrame* DataFrame::bool_op_(Key* key, KD_Store* kd, size_t a, BoolOp op, size_t b) {
+    assert(schema_.col_type(a) == 'B' && schema_.col_type(b) == 'B');
+    BoolOpRower rower(key->get_key(), a, op, b, kv_);
+    ship_map(rower);
+    Schema schema("B");
+    DataFrame* df = new DataFrame(schema, kv_);
+    rower.add_chunks_to(df->get_column(0));
+    df->get_schema().add_rows(nrows());
+    kd->put(key, df);
+    return df;
+}
+
+DataFrame* DataFrame::bools_and(Key* key, KD_Store* kd, size_t a, size_t b) {
+    return bool_op_(key, kd, a, BoolOp::And, b);
+}
+
+DataFrame* DataFrame::bools_or(Key* key, KD_Store* kd, size_t a, size_t b) {
+    return bool_op_(key, kd, a, BoolOp::Or, b);
+}
+
+DataFrame* DataFrame::bools_not(Key* key, KD_Store* kd, size_t col) {
+    return bool_op_(key, kd, col, BoolOp::Not, col);
+}
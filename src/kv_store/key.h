@@ -1,30 +1,47 @@
 #pragma once
 
+#include <stdint.h>
+
 #include "../helpers/string.h"
 
+// Replicas of a value stored on every node, whatever their number
+const size_t BROADCAST_REPLICAS = SIZE_MAX;
+
+/**
+ * Name of a value in the KV_Store and the node it is homed on. A replicated value is also copied
+ * on the replicas_ - 1 nodes following its home node, wrapping around.
+ */
 class Key : public Object {
     public:
     String* key_;
     size_t node_index_;
+    size_t replicas_; // nodes holding a copy of the value, at least 1
 
     Key(const char* key, size_t node_index) {
         key_ = new String(key);
         node_index_ = node_index;
+        replicas_ = 1;
     }
 
-    Key(String* key, size_t node_index) {
+    Key(String* key, size_t node_index) : Key(key, node_index, 1) { }
+
+    Key(String* key, size_t node_index, size_t replicas) {
+        assert(replicas > 0);
         key_ = key->clone();
         node_index_ = node_index;
+        replicas_ = replicas;
     }
 
     Key(Key& from) : Object(from) {
         key_ = from.key_->clone();
         node_index_ = from.node_index_;
+        replicas_ = from.replicas_;
     }
 
     Key(Deserializer& deserializer) {
         key_ = new String(deserializer); 
         node_index_ = deserializer.deserialize_size_t();
+        replicas_ = deserializer.deserialize_size_t();
     }
 
     ~Key() { delete key_; }
@@ -33,23 +50,48 @@ class Key : public Object {
 
     size_t get_node_index() { return node_index_; }
 
+    size_t get_replicas() { return replicas_; }
+
+    /** Nodes out of num_nodes holding a copy of the value. */
+    size_t num_copies(size_t num_nodes) { return replicas_ < num_nodes ? replicas_ : num_nodes; }
+
+    /** Node of the ii-th copy of the value, the home node first. */
+    size_t replica_node(size_t ii, size_t num_nodes) {
+        return ii == 0 ? node_index_ : (node_index_ + ii) % num_nodes;
+    }
+
+    /** Whether the node holds a copy of the value. */
+    bool is_on(size_t node, size_t num_nodes) {
+        if (replicas_ == 1 || node_index_ >= num_nodes) return node == node_index_;
+        return (node + num_nodes - node_index_) % num_nodes < replicas_;
+    }
+
+    /** Node the given one reads the value from: itself if it holds a copy, otherwise one of the
+     *  copies picked by its index, so that the readers of a value spread over its copies. */
+    size_t node_to_read(size_t node, size_t num_nodes) {
+        if (is_on(node, num_nodes)) return node;
+        return replica_node(node % num_copies(num_nodes), num_nodes);
+    }
+
     bool equals(Object* other) {
         if (other == this) return true;
         Key* other_key = dynamic_cast<Key*>(other);
         return other_key != nullptr 
             && this->key_->equals(other_key->key_)
-            && this->node_index_ == other_key->node_index_;
+            && this->node_index_ == other_key->node_index_
+            && this->replicas_ == other_key->replicas_;
     }
 
     Key* clone() { return new Key(*this); }
 
-    size_t serial_len() { return key_->serial_len() + sizeof(size_t); }
+    size_t serial_len() { return key_->serial_len() + sizeof(size_t) + sizeof(size_t); }
 
     char* serialize() {
         size_t serial_size = serial_len();
         Serializer serializer(serial_size);
         serializer.serialize_object(key_);
         serializer.serialize_size_t(node_index_);
+        serializer.serialize_size_t(replicas_);
         return serializer.get_serial();
     }
 };
\ No newline at end of file
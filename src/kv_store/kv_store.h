@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <thread>
 
 #include "../helpers/map.h"
 #include "key.h"
@@ -13,29 +15,65 @@
 // node_index of 6, so making this variable 6 will cause all values to be sent to the remote).
 const int LOCAL_SOCKET_DESCRIPTOR = 0;
 
+class KV_Store;
+
+// Runs a shipped rower over chunks homed on this node and returns the serialized rower. Set by
+// KD_Store, as running a rower needs a DataFrame.
+typedef Serializer* (*ShippedRowerRunner)(KV_Store* kv, ShipRower* message);
+
+/**
+ * A rower shipped to this node, run on its own thread so that the server thread keeps answering
+ * the other nodes meanwhile, e.g. the Gets of the rowers they run at the same time. The rower is
+ * sent back on the socket it came from.
+ */
+class RunningRower : public Object {
+    public:
+    ShipRower* message_; // owned
+    int socket_;
+    std::atomic<bool> done_;
+    std::thread thread_;
+
+    /** Takes ownership of the message, the thread is started by the KV_Store. */
+    RunningRower(ShipRower* message, int socket) {
+        message_ = message;
+        socket_ = socket;
+        done_ = false;
+    }
+
+    ~RunningRower() {
+        if (thread_.joinable()) thread_.join();
+        delete message_;
+    }
+};
+
 class KV_Store : public Node {
     public:
     Map* kv_map_; // String* -> Serializer* 
     Map* get_queue_;
     size_t local_node_index_;
+    ShippedRowerRunner rower_runner_;
     std::mutex kv_map_mutex_;
     std::mutex get_queue_mutex_;
     std::condition_variable cv_;
+    Array running_rowers_; // RunningRower*, owned, only touched by the server thread
     
     KV_Store(const char* client_ip_address, const char* server_ip_address, size_t local_node_index) 
-        : Node(client_ip_address, server_ip_address) {
+        : Node(client_ip_address, server_ip_address), running_rowers_('O', 1) {
         kv_map_ = new Map();
         get_queue_ = new Map();
         local_node_index_ = local_node_index;
+        rower_runner_ = nullptr;
     }
 
-    KV_Store(size_t local_node_index) : Node() {
+    KV_Store(size_t local_node_index) : Node(), running_rowers_('O', 1) {
         kv_map_ = new Map();
         get_queue_ = new Map();
         local_node_index_ = local_node_index;
+        rower_runner_ = nullptr;
     }
 
     ~KV_Store() {
+        reap_rowers_(true);
         delete kv_map_;
         delete get_queue_;
     }
@@ -82,18 +120,40 @@ class KV_Store : public Node {
         put_socket_into_queue_(key_name, socket);
     }
 
+    // Puts the value on its home node, and on the nodes following it if the key is replicated.
+    // Every remote copy is sent on a thread of its own, so a put waits on the slowest replica
+    // rather than on all of them in turn
     void put(Key* key, Object* value) {
         Serializer serial(value->serial_len());
         serial.serialize_object(value);
-        if (key->get_node_index() == local_node_index_) {
-            put_map_(key->get_key(), &serial);
-        } 
-        else {
+        size_t num_nodes = get_num_other_nodes();
+        size_t num_copies = key->num_copies(num_nodes);
+        Put** messages = new Put*[num_copies];
+        std::thread* senders = new std::thread[num_copies];
+        size_t num_senders = 0;
+        for (size_t ii = 0; ii < num_copies; ii++) {
+            size_t node = key->replica_node(ii, num_nodes);
+            if (node == local_node_index_) continue;
             // call upon another Node to put the kv
-            int index = other_node_indexes_->index_of(key->get_node_index());
-            Put message(my_ip_, other_nodes_->get(index), key->get_key(), &serial);
-            send_message_to_node(&message);
+            int index = other_node_indexes_->index_of(node);
+            messages[num_senders] = new Put(my_ip_, other_nodes_->get(index), key->get_key(),
+                &serial);
+            senders[num_senders] = std::thread(&KV_Store::send_message_to_node, this,
+                messages[num_senders]);
+            num_senders++;
+        }
+        if (key->is_on(local_node_index_, num_nodes)) put_map_(key->get_key(), &serial);
+        for (size_t ii = 0; ii < num_senders; ii++) {
+            senders[ii].join();
+            delete messages[ii];
         }
+        delete[] senders;
+        delete[] messages;
+    }
+
+    // Node this one reads the value of the key from, itself if it holds a copy
+    size_t node_to_read_(Key* key) {
+        return key->node_to_read(local_node_index_, get_num_other_nodes());
     }
 
     size_t get_node_index() {
@@ -110,18 +170,32 @@ class KV_Store : public Node {
 
     // Returns a new char array, make sure to delete it later
     char* get_value_serial(Key* key) {
-        if (key->get_node_index() == local_node_index_) {
+        size_t node = node_to_read_(key);
+        if (node == local_node_index_) {
+            // Locked as DataFrame::pmap reads chunks from several threads at once
+            std::unique_lock<std::mutex> lock(kv_map_mutex_);
             Serializer* map_serial = get_map_(key->get_key());
             return map_serial->get_serial();
         }
         else {
-            int index = other_node_indexes_->index_of(key->get_node_index());
+            int index = other_node_indexes_->index_of(node);
             Get message(my_ip_, other_nodes_->get(index), key->get_key());
             return send_message_and_receive_serial_(message);
         }
 
     }
 
+    void set_rower_runner(ShippedRowerRunner rower_runner) { rower_runner_ = rower_runner; }
+
+    // Runs the rower over the given chunks on their home node and returns the serialized rower 
+    // it sends back. Returns a new char array, make sure to delete it later
+    char* ship_rower(size_t node_index, String* rower_name, Serializer* rower, Serializer* df, 
+        IntArray* chunks) {
+        int index = other_node_indexes_->index_of(node_index);
+        ShipRower message(my_ip_, other_nodes_->get(index), rower_name, rower, df, chunks);
+        return send_message_and_receive_serial_(message);
+    }
+
     void put_socket_into_queue_(String* key_name, int socket_descriptor) {
         IntArray* sockets = dynamic_cast<IntArray*>(get_queue_->get(key_name));
         if (sockets) {
@@ -142,16 +216,17 @@ class KV_Store : public Node {
     }
 
     char* wait_get_value_serial(Key* key) {
-        if (key->get_node_index() == local_node_index_) {
+        size_t node = node_to_read_(key);
+        if (node == local_node_index_) {
             Serializer* map_serial = get_map_(key->get_key());
 
             if (!map_serial) {
                 map_serial = wait_for_local_map_value_(key); 
-            } 
+            }
             return map_serial->get_serial();
         }
         else {
-            int index = other_node_indexes_->index_of(key->get_node_index());
+            int index = other_node_indexes_->index_of(node);
             WaitAndGet message(my_ip_, other_nodes_->get(index), key->get_key());
             return send_message_and_receive_serial_(message);
         }
@@ -161,13 +236,7 @@ class KV_Store : public Node {
     Array* get_array(Key* key, char type) {
         char* kv_serial = get_value_serial(key);
         Deserializer deserializer(kv_serial);
-        Array* array;
-        switch(type) {
-            case 'I': array = new IntArray(deserializer); break;
-            case 'B': array = new BoolArray(deserializer); break;
-            case 'D': array = new DoubleArray(deserializer); break;
-            case 'S': array = new StringArray(deserializer); break;
-        }
+        Array* array = deserialize_array(deserializer, type);
         delete[] kv_serial;
         return array;
     }
@@ -176,6 +245,27 @@ class KV_Store : public Node {
         return other_node_indexes_ ? other_node_indexes_->get(index) : local_node_index_;
     }
 
+    void run_rower_(RunningRower* run) {
+        Serializer* result = rower_runner_(this, run->message_);
+        Value value_message(my_ip_, run->message_->get_sender(), result);
+        send_message(run->socket_, &value_message);
+        delete result;
+        run->done_ = true;
+    }
+
+    // Joins the shipped rowers that were sent back already, or all of them
+    void reap_rowers_(bool all) {
+        for (size_t ii = 0; ii < running_rowers_.length();) {
+            RunningRower* run = static_cast<RunningRower*>(running_rowers_.get(ii).o);
+            if (all || run->done_) {
+                running_rowers_.remove(ii);
+                delete run;
+            } else {
+                ii++;
+            }
+        }
+    }
+
     bool decode_message_(Message* message, int client) {
         switch (message->get_kind()) {
             case MsgKind::Put: {
@@ -185,26 +275,46 @@ class KV_Store : public Node {
             }
             case MsgKind::Get: {
                 Get* get_message = dynamic_cast<Get*>(message);
+                // Locked as shipped rowers put values from their own threads, only while the
+                // message copies the value so the send does not hold up the other readers
+                std::unique_lock<std::mutex> lock(kv_map_mutex_);
                 Serializer* value = get_map_(get_message->get_key_name());
                 if (!value) {
                     // There is no key value pair, for the given key
                     assert(0);
                 }
                 Value value_message(my_ip_, get_message->get_sender(), value);
+                lock.unlock();
                 send_message(client_sockets_->get(client), &value_message);
                 return 1;
             }
             case MsgKind::WaitAndGet: {
                 WaitAndGet* get_message = dynamic_cast<WaitAndGet*>(message);
+                // Queued before the lock is released, so a concurrent put finds the socket
+                std::unique_lock<std::mutex> lock(kv_map_mutex_);
                 Serializer* value = get_map_(get_message->get_key_name());
                 if (value) {
                     Value value_message(my_ip_, get_message->get_sender(), value);
+                    lock.unlock();
                     send_message(client_sockets_->get(client), &value_message);
                 } else {
                     put_get_queue_(get_message->get_key_name(), client_sockets_->get(client));
                 }
                 return 1;
-            }   
+            }
+            case MsgKind::ShipRower: {
+                // Runs on a thread of its own, the message is copied as the caller deletes it
+                ShipRower* ship_message = dynamic_cast<ShipRower*>(message);
+                assert(rower_runner_);
+                reap_rowers_(false);
+                ShipRower* copy = new ShipRower(ship_message->get_sender(),
+                    ship_message->get_target(), ship_message->get_rower_name(),
+                    ship_message->get_rower(), ship_message->get_df(), ship_message->get_chunks());
+                RunningRower* run = new RunningRower(copy, client_sockets_->get(client));
+                running_rowers_.push(object_to_payload(run));
+                run->thread_ = std::thread(&KV_Store::run_rower_, this, run);
+                return 1;
+            }
             default:
                 // Priority is now kicked up to the Parent class
                 return Node::decode_message_(message, client);
@@ -9,7 +9,7 @@
 #include "../helpers/serial.h"
 #include "../helpers/array.h"
 
-enum class MsgKind { Ack, Put, Get, WaitAndGet, Value, Kill, Register, Directory, Complete };
+enum class MsgKind { Ack, Put, Get, WaitAndGet, Value, Kill, Register, Directory, Complete, ShipRower };
 
 class Message : public Object {
     public:
@@ -304,6 +304,82 @@ class Value : public Message {
     }
 };
 
+/**
+ * Asks the home node of some chunks to run a registered Rower over them. The node answers with a
+ * Value holding the serialized rower once it went over all of the chunks.
+ */
+class ShipRower : public Message {
+    public:
+    String* rower_name_; // name the rower is registered under
+    Serializer* rower_; // state of the rower to run
+    Serializer* df_; // the DataFrame the chunks belong to
+    IntArray* chunks_; // indexes of the chunks to run the rower over, in order
+
+    ShipRower(String* sender, String* target, String* rower_name, Serializer* rower, 
+        Serializer* df, IntArray* chunks) : Message(MsgKind::ShipRower, sender, target) {
+        rower_name_ = rower_name->clone();
+        rower_ = rower->clone();
+        df_ = df->clone();
+        chunks_ = chunks->clone();
+    }
+
+    ShipRower(Deserializer& deserializer) : Message(MsgKind::ShipRower, deserializer) {
+        rower_name_ = new String(deserializer);
+        rower_ = deserialize_serializer_(deserializer);
+        df_ = deserialize_serializer_(deserializer);
+        chunks_ = new IntArray(deserializer);
+    }
+
+    ~ShipRower() {
+        delete rower_name_;
+        delete rower_;
+        delete df_;
+        delete chunks_;
+    }
+
+    String* get_rower_name() { return rower_name_; }
+
+    Serializer* get_rower() { return rower_; }
+
+    Serializer* get_df() { return df_; }
+
+    IntArray* get_chunks() { return chunks_; }
+
+    Serializer* deserialize_serializer_(Deserializer& deserializer) {
+        size_t len = deserializer.deserialize_size_t();
+        char* serial = deserializer.deserialize_char_array(len - 1);
+        Serializer* serializer = new Serializer(serial, len);
+        delete[] serial;
+        return serializer;
+    }
+
+    void serialize_serializer_(Serializer& serializer, Serializer* value) {
+        serializer.serialize_size_t(value->get_serial_size());
+        char* serial = value->get_serial();
+        serializer.serialize_chars(serial, value->get_serial_size() - 1);
+        delete[] serial;
+    }
+
+    size_t serial_len() {
+        return Message::serial_len()
+            + rower_name_->serial_len()
+            + sizeof(size_t) + rower_->get_serial_size()
+            + sizeof(size_t) + df_->get_serial_size()
+            + chunks_->serial_len();
+    }
+
+    char* serialize() {
+        size_t serial_size = serial_len();
+        Serializer serializer(serial_size);
+        serialize_message_(serializer);
+        serializer.serialize_object(rower_name_);
+        serialize_serializer_(serializer, rower_);
+        serialize_serializer_(serializer, df_);
+        serializer.serialize_object(chunks_);
+        return serializer.get_serial();
+    }
+};
+
 Message* Message::deserialize_message(char* buff) {
     Deserializer deserializer(buff);
     MsgKind msg_kind = static_cast<MsgKind>(deserializer.deserialize_size_t());
@@ -326,6 +402,8 @@ Message* Message::deserialize_message(char* buff) {
             return new Value(deserializer);
         case MsgKind::Complete:
             return new Complete(deserializer);
+        case MsgKind::ShipRower:
+            return new ShipRower(deserializer);
         default:
             assert(0);
     }
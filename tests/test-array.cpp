@@ -393,6 +393,32 @@ void array_test() {
   OK("16");
 }
 
+/** Tests the dense storage of the primitive arrays, including bools crossing word boundaries */
+void dense_array_test() {
+  BoolArray bools(1);
+  IntArray ints(1);
+  for (size_t ii = 0; ii < 200; ii++) {
+    bools.push(ii % 3 == 0);
+    ints.push(ii * 2);
+  }
+  t_true(bools.length() == 200, "17a");
+  t_true(bools.get(63) && !bools.get(64) && bools.get(66), "17b");
+  t_true(bools.get_payload(129).b && !bools.get_payload(130).b, "17c");
+  t_true(bools.remove(63) && bools.length() == 199, "17d");
+  t_true(!bools.get(63) && bools.get(65), "17e");
+  t_true(bools.index_of(true) == 0 && bools.index_of(false) == 1, "17f");
+  t_true(ints.get(150) == 300 && ints.get_payload(150).i == 300, "17g");
+  t_true(ints.remove(0) == 0 && ints.get(0) == 2 && ints.length() == 199, "17h");
+
+  BoolArray* bools_clone = bools.clone();
+  t_true(bools_clone->equals(&bools), "17i");
+  bools_clone->replace(198, !bools.get(198));
+  t_false(bools_clone->equals(&bools), "17j");
+  delete bools_clone;
+
+  OK("17");
+}
+
 int main() {
   basic_object_test();
   basic_string_test();
@@ -415,6 +441,7 @@ int main() {
   basic_columnarray_test();
   basic_keyarray_test();
   array_test();
+  dense_array_test();
 
   exit(0);
 }
\ No newline at end of file
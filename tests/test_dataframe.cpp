@@ -65,6 +65,107 @@ class AddRower : public Rower {
  
 };
 
+/*******************************************************************************
+ *  IntSumRower::
+ *  Sums the first column of a DataFrame of ints.
+ */
+class IntSumRower : public Rower {
+ public:
+  long sum_ = 0;
+
+  bool accept(Row& r) {
+    sum_ += r.get_int(0);
+    return true;
+  }
+
+  Rower* clone() { return new IntSumRower(); }
+
+  void join_delete(Rower* other) {
+    sum_ += dynamic_cast<IntSumRower*>(other)->sum_;
+    delete other;
+  }
+};
+
+/*******************************************************************************
+ *  IntFilterRower::
+ *  Keeps the rows whose first column, an int, is a multiple of modulus_.
+ */
+class IntFilterRower : public Rower {
+ public:
+  int modulus_;
+
+  IntFilterRower(int modulus) { modulus_ = modulus; }
+
+  static Rower* deserialize(Deserializer& deserializer, KV_Store* kv) {
+    return new IntFilterRower(deserializer.deserialize_int());
+  }
+
+  bool accept(Row& r) { return r.get_int(0) % modulus_ == 0; }
+
+  Rower* clone() { return new IntFilterRower(modulus_); }
+
+  void join_delete(Rower* other) { delete other; }
+
+  const char* registered_name() { return "IntFilterRower"; }
+
+  size_t serial_len() { return sizeof(int); }
+
+  char* serialize() {
+    Serializer serializer(serial_len());
+    serializer.serialize_int(modulus_);
+    return serializer.get_serial();
+  }
+};
+
+/*******************************************************************************
+ *  TotalsBatchRower::
+ *  Totals every column of an "IDBS" DataFrame a chunk at a time.
+ */
+class TotalsBatchRower : public BatchRower {
+ public:
+  long int_sum_ = 0;
+  double double_sum_ = 0;
+  size_t num_true_ = 0;
+  size_t chars_ = 0;
+  size_t rows_ = 0;
+  size_t batches_ = 0;
+  size_t next_start_ = 0;
+
+  void accept(RowBatch& batch) {
+    int* ints = batch.ints(0);
+    double* doubles = batch.doubles(1);
+    BoolArray* bools = batch.bools(2);
+    StringArray* strings = batch.strings(3);
+    for (size_t ii = 0; ii < batch.length(); ii++) {
+      int_sum_ += ints[ii];
+      double_sum_ += doubles[ii];
+      num_true_ += bools->get(ii);
+      chars_ += strings->get(ii)->size();
+    }
+    // Chunks come in order, a clone may start anywhere
+    if (batches_ > 0) GT_EQUALS(batch.start(), next_start_);
+    next_start_ = batch.start() + batch.length();
+    rows_ += batch.length();
+    batches_++;
+  }
+
+  BatchRower* clone() { return new TotalsBatchRower(); }
+
+  /** Clones are joined in chunk order, so the runs they visited must follow each other. */
+  void join_delete(BatchRower* other) {
+    TotalsBatchRower* totals = dynamic_cast<TotalsBatchRower*>(other);
+    GT_EQUALS(totals->next_start_ - totals->rows_, next_start_);
+    int_sum_ += totals->int_sum_;
+    double_sum_ += totals->double_sum_;
+    num_true_ += totals->num_true_;
+    chars_ += totals->chars_;
+    rows_ += totals->rows_;
+    batches_ += totals->batches_;
+    next_start_ = totals->next_start_;
+    delete other;
+  }
+};
+
 void test() {
   Schema s("II");
 
@@ -634,6 +735,121 @@ void test_from_rower_file() {
   printf("Dataframe from rower file reader test passed!\n");
 }
 
+void test_chunk_cache() {
+  KV_Store kv(0);
+  String name("cache");
+  DataFrameBuilder df_b("I", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  for (int ii = 0; ii < ELEMENT_ARRAY_SIZE * 4; ii++) {
+    r.set(0, ii);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+  Column* col = df->get_column(0);
+  ChunkCache* cache = col->get_local_cache();
+
+  // Alternating between two chunks only fetches each of them once
+  for (int ii = 0; ii < 10; ii++) {
+    GT_EQUALS(df->get_int(0, 0), 0);
+    GT_EQUALS(df->get_int(0, ELEMENT_ARRAY_SIZE * 3), ELEMENT_ARRAY_SIZE * 3);
+  }
+  GT_EQUALS(cache->misses(), 2);
+  GT_EQUALS(cache->hits(), 18);
+  GT_EQUALS(cache->num_chunks(), 2);
+  GT_EQUALS(col->get_remote_cache()->misses(), 0);
+
+  // A budget of a single chunk evicts the least recently used one
+  size_t chunk_bytes = cache->bytes_used() / 2;
+  df->set_cache_budget(chunk_bytes, chunk_bytes);
+  GT_EQUALS(cache->num_chunks(), 1);
+  GT_EQUALS(df->get_int(0, ELEMENT_ARRAY_SIZE * 3 + 1), ELEMENT_ARRAY_SIZE * 3 + 1);
+  GT_EQUALS(df->get_int(0, ELEMENT_ARRAY_SIZE + 1), ELEMENT_ARRAY_SIZE + 1);
+  GT_EQUALS(df->get_int(0, ELEMENT_ARRAY_SIZE * 3 + 2), ELEMENT_ARRAY_SIZE * 3 + 2);
+  GT_EQUALS(cache->num_chunks(), 1);
+  GT_EQUALS(cache->misses(), 4);
+  GT_EQUALS(cache->evictions(), 3);
+
+  delete df;
+  printf("Dataframe chunk cache test passed!\n");
+}
+
+void test_chunk_sizing() {
+  KV_Store kv(0);
+  // Chunks hold about the bytes asked for, whatever the width of their rows
+  String doubles_name("doubles");
+  DataFrameBuilder doubles_b("D", &doubles_name, &kv);
+  doubles_b.set_chunk_bytes(50 * sizeof(double));
+  GT_EQUALS(doubles_b.get_chunk_rows(), 50);
+  Row d(doubles_b.df_->get_schema());
+  for (size_t ii = 0; ii < 230; ii++) {
+    d.set(0, ii * 1.5);
+    doubles_b.add_row(d);
+  }
+  DataFrame* doubles = doubles_b.done();
+  GT_EQUALS(doubles->num_chunks(), 5);
+  GT_EQUALS(doubles->chunk_length(4), 30);
+  GT_EQUALS(doubles->get_column(0)->chunk_size(), 50);
+  GT_EQUALS(doubles->get_double(0, 229), 229 * 1.5);
+  GT_EQUALS(doubles->get_column(0)->get_home_node(120), 0);
+  // Bools are packed, so more of them fit the same bytes
+  Schema bools("BBBB");
+  GT_EQUALS(chunk_rows_for(bools, 50), 100);
+  GT_EQUALS(chunk_rows_for(bools, 1), 2);
+
+  // The chunk size travels with the column
+  char* serial = doubles->serialize();
+  Deserializer deserializer(serial);
+  DataFrame copy(deserializer, &kv);
+  GT_EQUALS(copy.get_column(0)->chunk_size(), 50);
+  GT_EQUALS(copy.get_double(0, 101), 101 * 1.5);
+  delete[] serial;
+
+  // Long strings cut chunks short of the estimated rows
+  String strings_name("strings");
+  DataFrameBuilder strings_b("SI", &strings_name, &kv);
+  strings_b.set_chunk_bytes(2000);
+  size_t estimated_rows = strings_b.get_chunk_rows();
+  Row s(strings_b.df_->get_schema());
+  for (size_t ii = 0; ii < 100; ii++) {
+    String str("x");
+    for (size_t jj = 0; jj < 200; jj++) str.concat('x');
+    str.concat(ii);
+    s.set(0, &str);
+    s.set(1, (int)ii);
+    strings_b.add_row(s);
+  }
+  DataFrame* strings = strings_b.done();
+  GT_TRUE(strings->chunk_length(0) < estimated_rows);
+  GT_TRUE(strings->num_chunks() > 100 / estimated_rows + 1);
+  GT_EQUALS(atoi(strings->get_string(0, 77)->c_str() + 201), 77);
+  GT_EQUALS(strings->get_int(1, 99), 99);
+
+  // Fixed rows ignore bytes, and chunks of uneven lengths fall back to searching
+  String fixed_name("fixed");
+  DataFrameBuilder fixed_b("SI", &fixed_name, &kv);
+  fixed_b.set_chunk_rows(7);
+  for (size_t ii = 0; ii < 20; ii++) {
+    String str("y");
+    for (size_t jj = 0; jj < 2000; jj++) str.concat('y');
+    s.set(0, &str);
+    s.set(1, (int)ii);
+    fixed_b.add_row(s);
+  }
+  DataFrame* fixed = fixed_b.done();
+  GT_EQUALS(fixed->num_chunks(), 3);
+  GT_EQUALS(fixed->get_column(1)->chunk_size(), 7);
+  fixed->append_chunks(*strings);
+  GT_EQUALS(fixed->get_column(1)->chunk_size(), 0);
+  GT_EQUALS(fixed->get_int(1, 19), 19);
+  GT_EQUALS(fixed->get_int(1, 20), 0);
+  GT_EQUALS(fixed->get_int(1, 119), 99);
+
+  delete fixed;
+  delete strings;
+  delete doubles;
+  printf("Dataframe chunk sizing test passed!\n");
+}
+
 void test_local_map() {
   int cpid[2];
   String* server_ip = new String("127.0.0.1");
@@ -662,6 +878,12 @@ void test_local_map() {
     assert(map->count_ == 1);
     assert(map->get(hi)->value >= 100 && map->get(hi)->value <= 200);
 
+    // Chunks alternate between the nodes, starting with node 0
+    IntArray* chunks = df->local_chunks();
+    assert(chunks->length() == 1 && chunks->get(0) == 1);
+    assert(df->chunk_start(1) == ELEMENT_ARRAY_SIZE);
+    delete chunks;
+
     kd->application_complete();
 
     delete kd;
@@ -702,6 +924,10 @@ void test_local_map() {
     assert(map->count_ == 1);
     assert(map->get(hi)->value >= 100 && map->get(hi)->value <= 200);
 
+    IntArray* chunks = df->local_chunks();
+    assert(chunks->length() == 2 && chunks->get(0) == 0 && chunks->get(1) == 2);
+    delete chunks;
+
     kd->application_complete();
 
     delete kd;
@@ -737,6 +963,1637 @@ void test_local_map() {
   printf("Dataframe local map test passed!\n");
 }
 
+void test_batch_map() {
+  KV_Store kv(0);
+  String name("batch");
+  DataFrameBuilder df_b("IDBS", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 2 + ELEMENT_ARRAY_SIZE / 2;
+  String word("word");
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, (int)ii);
+    r.set(1, ii * 0.5);
+    r.set(2, ii % 4 == 0);
+    r.set(3, &word);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  TotalsBatchRower totals;
+  df->map(totals);
+  GT_EQUALS(totals.batches_, 3);
+  GT_EQUALS(totals.rows_, count);
+  GT_EQUALS(totals.int_sum_, (long)count * (count - 1) / 2);
+  GT_EQUALS(totals.double_sum_, count * (count - 1) / 4.0);
+  GT_EQUALS(totals.num_true_, (count + 3) / 4);
+  GT_EQUALS(totals.chars_, count * 4);
+
+  // Every chunk is homed on the only node
+  TotalsBatchRower local_totals;
+  df->local_map(local_totals);
+  GT_EQUALS(local_totals.rows_, count);
+  GT_EQUALS(local_totals.int_sum_, totals.int_sum_);
+
+  IntArray* chunks = df->local_chunks();
+  GT_EQUALS(chunks->length(), 3);
+  GT_EQUALS(df->chunk_start(2), ELEMENT_ARRAY_SIZE * 2);
+  GT_EQUALS(df->chunk_length(2), ELEMENT_ARRAY_SIZE / 2);
+  IntSumRower last;
+  df->map_chunk(chunks->get(2), last);
+  GT_EQUALS(last.sum_, (long)count * (count - 1) / 2 - (long)(ELEMENT_ARRAY_SIZE * 2) * (ELEMENT_ARRAY_SIZE * 2 - 1) / 2);
+  delete chunks;
+
+  delete df;
+  printf("Dataframe batch map test passed!\n");
+}
+
+void test_pmap() {
+  KV_Store kv(0);
+  String name("pmap");
+  DataFrameBuilder df_b("IDBS", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 7 + 3;
+  String word("word");
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, (int)ii);
+    r.set(1, ii * 0.5);
+    r.set(2, ii % 4 == 0);
+    r.set(3, &word);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  IntSumRower sum;
+  df->map(sum);
+  IntSumRower psum;
+  df->pmap(psum);
+  GT_EQUALS(psum.sum_, sum.sum_);
+  // More threads than chunks
+  IntSumRower local_psum;
+  df->local_pmap(local_psum, 16);
+  GT_EQUALS(local_psum.sum_, sum.sum_);
+
+  TotalsBatchRower totals;
+  df->pmap(totals, 3);
+  GT_EQUALS(totals.batches_, 8);
+  GT_EQUALS(totals.rows_, count);
+  GT_EQUALS(totals.int_sum_, (long)count * (count - 1) / 2);
+  GT_EQUALS(totals.double_sum_, count * (count - 1) / 4.0);
+  GT_EQUALS(totals.num_true_, (count + 3) / 4);
+  GT_EQUALS(totals.chars_, count * 4);
+
+  TotalsBatchRower local_totals;
+  df->local_pmap(local_totals, 1);
+  GT_EQUALS(local_totals.int_sum_, totals.int_sum_);
+
+  delete df;
+  printf("Dataframe pmap test passed!\n");
+}
+
+void test_filter() {
+  KD_Store kd(0);
+  Key key("to_filter", 0);
+  size_t count = ELEMENT_ARRAY_SIZE * 5 + 7;
+  int* ints = new int[count];
+  for (size_t ii = 0; ii < count; ii++) ints[ii] = ii;
+  DataFrame* df = DataFrame::from_array(&key, &kd, count, ints);
+
+  Key evens_key("evens", 0);
+  IntFilterRower evens_filter(2);
+  DataFrame* evens = df->filter(&evens_key, &kd, evens_filter);
+  GT_EQUALS(evens->nrows(), (count + 1) / 2);
+  for (size_t ii = 0; ii < evens->nrows(); ii++) GT_EQUALS(evens->get_int(0, ii), ii * 2);
+  // Every thread writes its own, possibly partial, chunks
+  size_t rows = 0;
+  for (size_t ii = 0; ii < evens->num_chunks(); ii++) {
+    GT_EQUALS(evens->chunk_start(ii), rows);
+    rows += evens->chunk_length(ii);
+  }
+  GT_EQUALS(rows, evens->nrows());
+  DataFrame* stored = kd.get(&evens_key);
+  GT_EQUALS(stored->nrows(), evens->nrows());
+  GT_EQUALS(stored->get_int(0, evens->nrows() - 1), count - 1);
+
+  Key zero_key("zero", 0);
+  IntFilterRower zero_filter(count);
+  DataFrame* zero = df->filter(&zero_key, &kd, zero_filter);
+  GT_EQUALS(zero->nrows(), 1);
+  GT_EQUALS(zero->get_int(0, 0), 0);
+
+  delete zero;
+  delete stored;
+  delete evens;
+  delete df;
+  delete[] ints;
+  printf("Dataframe filter test passed!\n");
+}
+
+void test_zone_maps() {
+  KD_Store kd(0);
+  Key key("sorted", 0);
+  size_t count = ELEMENT_ARRAY_SIZE * 5 + 7;
+  int* ints = new int[count];
+  for (size_t ii = 0; ii < count; ii++) ints[ii] = ii;
+  DataFrame* df = DataFrame::from_array(&key, &kd, count, ints);
+
+  GT_EQUALS(df->num_chunks(), 6);
+  ZoneMap zone = df->chunk_zone(0, 1);
+  GT_EQUALS(zone.min_, ELEMENT_ARRAY_SIZE);
+  GT_EQUALS(zone.max_, ELEMENT_ARRAY_SIZE * 2 - 1);
+  GT_EQUALS(zone.count_, ELEMENT_ARRAY_SIZE);
+  GT_TRUE(zone.distinct_ > ELEMENT_ARRAY_SIZE * 9 / 10 && zone.distinct_ <= ELEMENT_ARRAY_SIZE);
+  GT_EQUALS(df->chunk_zone(0, 5).count_, 7);
+
+  // Only the chunks the range overlaps are candidates
+  IntArray* chunks = df->chunks_where(0, CmpOp::Ge, ELEMENT_ARRAY_SIZE * 3 + 5);
+  GT_EQUALS(chunks->length(), 3);
+  GT_EQUALS(chunks->get(0), 3);
+  delete chunks;
+  chunks = df->chunks_where(0, CmpOp::Eq, -1);
+  GT_EQUALS(chunks->length(), 0);
+  delete chunks;
+  chunks = df->chunks_where(0, CmpOp::Ne, 3);
+  GT_EQUALS(chunks->length(), 6);
+  delete chunks;
+
+  GT_EQUALS(df->count_if(0, CmpOp::Lt, ELEMENT_ARRAY_SIZE * 2 + 3), ELEMENT_ARRAY_SIZE * 2 + 3);
+  GT_EQUALS(df->count_if(0, CmpOp::Ge, count), 0);
+  GT_EQUALS(df->count_if(0, CmpOp::Ne, 7), count - 1);
+
+  IntSumRower sum;
+  df->map_where(sum, 0, CmpOp::Ge, ELEMENT_ARRAY_SIZE * 3);
+  long expected = 0;
+  for (size_t ii = ELEMENT_ARRAY_SIZE * 3; ii < count; ii++) expected += ii;
+  GT_EQUALS(sum.sum_, expected);
+
+  Key high_key("high_evens", 0);
+  IntFilterRower evens_filter(2);
+  DataFrame* high = df->filter(&high_key, &kd, evens_filter, 0, CmpOp::Ge, ELEMENT_ARRAY_SIZE * 4);
+  GT_EQUALS(high->get_int(0, 0), ELEMENT_ARRAY_SIZE * 4);
+  GT_EQUALS(high->nrows(), (count - ELEMENT_ARRAY_SIZE * 4 + 1) / 2);
+
+  // Zones travel with the column
+  DataFrame* stored = kd.get(&key);
+  GT_EQUALS(stored->chunk_zone(0, 4).min_, ELEMENT_ARRAY_SIZE * 4);
+  GT_EQUALS(stored->chunk_zone(0, 4).max_, ELEMENT_ARRAY_SIZE * 5 - 1);
+
+  delete stored;
+  delete high;
+  delete df;
+  delete[] ints;
+  printf("Dataframe zone maps test passed!\n");
+}
+
+/** Checks a join of users "IS" and events "ID" on the user id, whichever side is left. */
+void check_users_events_join(DataFrame* joined, bool users_left, size_t num_users,
+    size_t num_events) {
+  size_t user_col = users_left ? 0 : 2;
+  size_t event_col = users_left ? 2 : 0;
+  String types(users_left ? "ISID" : "IDIS");
+  GT_TRUE(joined->get_schema().types_->equals(&types));
+  size_t expected_rows = 0;
+  double expected_total = 0;
+  for (size_t ii = 0; ii < num_events; ii++) {
+    if ((ii * 7) % (num_users + 10) >= num_users) continue;
+    expected_rows++;
+    expected_total += ii;
+  }
+  GT_EQUALS(joined->nrows(), expected_rows);
+  double total = 0;
+  for (size_t ii = 0; ii < joined->nrows(); ii++) {
+    int user = joined->get_int(user_col, ii);
+    GT_EQUALS(joined->get_int(event_col, ii), user);
+    String name("u");
+    name.concat((size_t)user % 7);
+    GT_TRUE(joined->get_string(user_col + 1, ii)->equals(&name));
+    total += joined->get_double(event_col + 1, ii);
+  }
+  GT_EQUALS(total, expected_total);
+}
+
+void test_join() {
+  KD_Store kd(0);
+  String users_name("users");
+  DataFrameBuilder users_b("IS", &users_name, kd.get_kv());
+  Row user(users_b.df_->get_schema());
+  size_t num_users = ELEMENT_ARRAY_SIZE * 2 + 5;
+  for (size_t ii = 0; ii < num_users; ii++) {
+    String name("u");
+    name.concat(ii % 7);
+    user.set(0, (int)ii);
+    user.set(1, &name);
+    users_b.add_row(user);
+  }
+  DataFrame* users = users_b.done();
+  String events_name("events");
+  DataFrameBuilder events_b("ID", &events_name, kd.get_kv());
+  Row event(events_b.df_->get_schema());
+  size_t num_events = ELEMENT_ARRAY_SIZE * 5 + 3;
+  for (size_t ii = 0; ii < num_events; ii++) {
+    event.set(0, (int)((ii * 7) % (num_users + 10)));
+    event.set(1, (double)ii);
+    events_b.add_row(event);
+  }
+  DataFrame* events = events_b.done();
+
+  JoinStrategy strategies[2] = { JoinStrategy::Broadcast, JoinStrategy::Partitioned };
+  for (size_t ii = 0; ii < 2; ii++) {
+    Key events_users("events_users", 0);
+    DataFrame* joined = DataFrame::join(events, users, 0, 0, &events_users, &kd, strategies[ii]);
+    check_users_events_join(joined, false, num_users, num_events);
+    delete joined;
+    // The build side is the smaller frame, columns still follow the arguments
+    Key users_events("users_events", 0);
+    joined = DataFrame::join(users, events, 0, 0, &users_events, &kd, strategies[ii]);
+    check_users_events_join(joined, true, num_users, num_events);
+    DataFrame* stored = kd.get(&users_events);
+    GT_EQUALS(stored->nrows(), joined->nrows());
+    delete stored;
+    delete joined;
+  }
+
+  // String keys, duplicates on both sides multiply
+  Key picked_key("picked", 0);
+  String u1("u1");
+  String u3("u3");
+  String zz("zz");
+  String* picked_names[4] = { &u1, &u3, &zz, &u1 };
+  DataFrame* picked = DataFrame::from_array(&picked_key, &kd, 4, picked_names);
+  Key by_name("by_name", 0);
+  DataFrame* joined = DataFrame::join(picked, users, 0, 1, &by_name, &kd);
+  size_t expected = 0;
+  for (size_t ii = 0; ii < num_users; ii++) expected += ii % 7 == 1 ? 2 : ii % 7 == 3;
+  GT_EQUALS(joined->nrows(), expected);
+  for (size_t ii = 0; ii < joined->nrows(); ii++)
+    GT_TRUE(joined->get_string(0, ii)->equals(joined->get_string(2, ii)));
+  delete joined;
+
+  delete picked;
+  delete events;
+  delete users;
+  printf("Dataframe join test passed!\n");
+}
+
+void test_group_by() {
+  KD_Store kd(0);
+  String name("sales");
+  DataFrameBuilder df_b("SIDB", &name, kd.get_kv());
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 6 + 11;
+  for (size_t ii = 0; ii < count; ii++) {
+    String word("w");
+    word.concat(ii % 13);
+    r.set(0, &word);
+    r.set(1, (int)(ii % 3));
+    r.set(2, (double)ii);
+    r.set(3, ii % 2 == 0);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  GroupAggregates aggregates;
+  aggregates.add(AggOp::Count, 0);
+  aggregates.add(AggOp::Sum, 2);
+  aggregates.add(AggOp::Min, 2);
+  aggregates.add(AggOp::Max, 1);
+  aggregates.add(AggOp::Mean, 2);
+  aggregates.add(AggOp::Sum, 3);
+  IntArray by_word(1);
+  by_word.push(0);
+  Key words_key("by_word", 0);
+  DataFrame* words = df->group_by(&words_key, &kd, by_word, aggregates);
+  String types("SIDDDDD");
+  GT_TRUE(words->get_schema().types_->equals(&types));
+  GT_EQUALS(words->nrows(), 13);
+  bool* seen = new bool[13];
+  for (size_t ii = 0; ii < 13; ii++) seen[ii] = false;
+  for (size_t ii = 0; ii < words->nrows(); ii++) {
+    size_t group = atoi(words->get_string(0, ii)->c_str() + 1);
+    GT_TRUE(group < 13 && !seen[group]);
+    seen[group] = true;
+    size_t rows = 0;
+    double sum = 0;
+    size_t max = 0;
+    double num_true = 0;
+    for (size_t jj = group; jj < count; jj += 13) {
+      rows++;
+      sum += jj;
+      max = ::max(max, jj % 3);
+      num_true += jj % 2 == 0;
+    }
+    GT_EQUALS(words->get_int(1, ii), rows);
+    GT_EQUALS(words->get_double(2, ii), sum);
+    GT_EQUALS(words->get_double(3, ii), group);
+    GT_EQUALS(words->get_double(4, ii), max);
+    GT_EQUALS(words->get_double(5, ii), sum / rows);
+    GT_EQUALS(words->get_double(6, ii), num_true);
+  }
+  delete[] seen;
+
+  // Several key columns, of different types
+  IntArray by_word_and_int(2);
+  by_word_and_int.push(1);
+  by_word_and_int.push(0);
+  GroupAggregates counts;
+  counts.add(AggOp::Count, 2);
+  Key pairs_key("by_pair", 0);
+  DataFrame* pairs = df->group_by(&pairs_key, &kd, by_word_and_int, counts);
+  GT_EQUALS(pairs->nrows(), 39);
+  size_t total = 0;
+  for (size_t ii = 0; ii < pairs->nrows(); ii++) total += pairs->get_int(2, ii);
+  GT_EQUALS(total, count);
+  DataFrame* stored = kd.get(&pairs_key);
+  GT_EQUALS(stored->nrows(), 39);
+
+  // -0.0 and 0.0 are the same key, and so are all NaNs
+  String zeros_name("zeros");
+  DataFrameBuilder zeros_b("DI", &zeros_name, kd.get_kv());
+  Row zeros_r(zeros_b.df_->get_schema());
+  double zero_keys[4] = {-0.0, 0.0, NAN, -NAN};
+  for (size_t ii = 0; ii < 400; ii++) {
+    zeros_r.set(0, zero_keys[ii % 4]);
+    zeros_r.set(1, (int)ii);
+    zeros_b.add_row(zeros_r);
+  }
+  DataFrame* zeros = zeros_b.done();
+  IntArray by_double(1);
+  by_double.push(0);
+  GroupAggregates zero_counts;
+  zero_counts.add(AggOp::Count, 1);
+  Key zero_groups_key("zero_groups", 0);
+  DataFrame* zero_groups = zeros->group_by(&zero_groups_key, &kd, by_double, zero_counts);
+  GT_EQUALS(zero_groups->nrows(), 2);
+  GT_EQUALS(zero_groups->get_int(1, 0), 200);
+  GT_EQUALS(zero_groups->get_int(1, 1), 200);
+  delete zero_groups;
+  delete zeros;
+
+  // A dictionary encoded key is looked up in the table once per distinct string, not per row
+  Schema batch_schema("SI");
+  RowBatch batch(batch_schema);
+  DictStringArray colors;
+  IntArray ints(1);
+  String* color_names[3] = {new String("red"), new String("green"), nullptr};
+  for (size_t ii = 0; ii < 1000; ii++) {
+    colors.push(color_names[ii % 3]);
+    ints.push((int)ii);
+  }
+  batch.set_chunk(0, &colors);
+  batch.set_chunk(1, &ints);
+  batch.set_range(0, 1000);
+  IntArray by_color(1);
+  by_color.push(0);
+  GroupAggregates color_counts;
+  color_counts.add(AggOp::Count, 1);
+  String colors_name("colors");
+  GroupByRower colors_rower(&colors_name, batch_schema, by_color, color_counts, false, 1,
+    kd.get_kv());
+  colors_rower.accept(batch);
+  GT_EQUALS(colors_rower.table_->num_groups(), 3);
+  GT_EQUALS(colors_rower.table_->num_lookups_, 3);
+  GT_EQUALS(colors_rower.table_->counts_->get(0), 334);
+  GT_EQUALS(colors_rower.table_->counts_->get(1), 333);
+  GT_EQUALS(colors_rower.table_->counts_->get(2), 333);
+  GT_TRUE(colors_rower.table_->key_arrays_[0]->is_missing(2));
+  delete color_names[0];
+  delete color_names[1];
+
+  delete stored;
+  delete pairs;
+  delete words;
+  delete df;
+  printf("Dataframe group by test passed!\n");
+}
+
+void test_sort() {
+  KD_Store kd(0);
+  String name("ids");
+  DataFrameBuilder df_b("IDS", &name, kd.get_kv());
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 5 + 17;
+  long sum = 0;
+  for (size_t ii = 0; ii < count; ii++) {
+    int val = (int)((ii * 7919) % 1009) - 500;
+    sum += val;
+    String word("w");
+    word.concat((size_t)(ii % 4));
+    r.set(0, val);
+    r.set(1, (double)ii);
+    r.set(2, &word);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  // Few rows fit in memory so most runs are spilled and merged back
+  IntArray by_int(1);
+  by_int.push(0);
+  Key sorted_key("sorted", 0);
+  DataFrame* sorted = df->sort(&sorted_key, &kd, by_int, true, ELEMENT_ARRAY_SIZE + 50);
+  GT_EQUALS(sorted->nrows(), count);
+  GT_EQUALS(sorted->sum(0), (double)sum);
+  GT_EQUALS(sorted->sum(1), (double)count * (count - 1) / 2);
+  for (size_t ii = 1; ii < count; ii++)
+    GT_TRUE((sorted->get_int(0, ii - 1) <= sorted->get_int(0, ii)));
+  for (size_t ii = 0; ii < sorted->num_chunks(); ii++) {
+    String chunk_key("sorted_0_");
+    chunk_key.concat(ii);
+    GT_TRUE(sorted->get_column(0)->keys_->get(ii)->get_key()->equals(&chunk_key));
+  }
+  DataFrame* stored = kd.get(&sorted_key);
+  GT_EQUALS(stored->nrows(), count);
+  delete stored;
+
+  // Several columns, descending, rows with equal keys keep their order
+  IntArray by_word_then_int(2);
+  by_word_then_int.push(2);
+  by_word_then_int.push(0);
+  Key desc_key("sorted_desc", 0);
+  DataFrame* desc = df->sort(&desc_key, &kd, by_word_then_int, false, ELEMENT_ARRAY_SIZE * 2);
+  GT_EQUALS(desc->nrows(), count);
+  for (size_t ii = 1; ii < count; ii++) {
+    int order = strcmp(desc->get_string(2, ii - 1)->c_str(), desc->get_string(2, ii)->c_str());
+    GT_TRUE((order >= 0));
+    if (order != 0) continue;
+    GT_TRUE((desc->get_int(0, ii - 1) >= desc->get_int(0, ii)));
+    if (desc->get_int(0, ii - 1) == desc->get_int(0, ii))
+      GT_TRUE((desc->get_double(1, ii - 1) < desc->get_double(1, ii)));
+  }
+  String last_word("w3");
+  GT_TRUE(desc->get_string(2, 0)->equals(&last_word));
+
+  // Many chunks are sorted by several threads, whose rows with equal keys keep their order whether
+  // they were still buffered or already in runs
+  String ids_name("many_ids");
+  DataFrameBuilder ids_b("ID", &ids_name, kd.get_kv());
+  ids_b.set_chunk_rows(50);
+  Row id_row(ids_b.df_->get_schema());
+  for (size_t ii = 0; ii < 1000; ii++) {
+    id_row.set(0, (int)(ii % 7));
+    id_row.set(1, (double)ii);
+    ids_b.add_row(id_row);
+  }
+  DataFrame* ids = ids_b.done();
+  GT_TRUE(ids->num_chunks() >= 20);
+  size_t max_rows[2] = { 2000, 70 };
+  for (size_t ii = 0; ii < 2; ii++) {
+    Key stable_key("sorted_ids", 0);
+    DataFrame* stable = ids->sort(&stable_key, &kd, by_int, true, max_rows[ii]);
+    GT_EQUALS(stable->nrows(), 1000);
+    for (size_t jj = 1; jj < 1000; jj++) {
+      GT_TRUE((stable->get_int(0, jj - 1) <= stable->get_int(0, jj)));
+      if (stable->get_int(0, jj - 1) == stable->get_int(0, jj))
+        GT_TRUE((stable->get_double(1, jj - 1) < stable->get_double(1, jj)));
+    }
+    delete stable;
+  }
+  delete ids;
+
+  delete desc;
+  delete sorted;
+  delete df;
+  printf("Dataframe sort test passed!\n");
+}
+
+/*******************************************************************************
+ *  ProjectedSumRower::
+ *  Sums column 0 of rows projected on columns 0 and 2 of an "IDBS" DataFrame.
+ */
+class ProjectedSumRower : public Rower {
+ public:
+  long sum_ = 0;
+
+  bool accept(Row& r) {
+    assert(r.is_projected(0) && !r.is_projected(1) && r.is_projected(2) && !r.is_projected(3));
+    sum_ += r.get_int(0);
+    return true;
+  }
+
+  Rower* clone() { return new ProjectedSumRower(); }
+
+  void join_delete(Rower* other) {
+    sum_ += dynamic_cast<ProjectedSumRower*>(other)->sum_;
+    delete other;
+  }
+};
+
+/** Sums column 1 of batches of an "IDBS" DataFrame projected on that column only. */
+class ProjectedDoubleBatchRower : public BatchRower {
+ public:
+  double sum_ = 0;
+
+  void accept(RowBatch& batch) {
+    GT_TRUE(batch.chunks_[0] == nullptr && batch.chunks_[2] == nullptr);
+    GT_TRUE(batch.chunks_[3] == nullptr);
+    double* doubles = batch.doubles(1);
+    for (size_t ii = 0; ii < batch.length(); ii++) sum_ += doubles[ii];
+  }
+
+  BatchRower* clone() { return new ProjectedDoubleBatchRower(); }
+
+  void join_delete(BatchRower* other) {
+    sum_ += dynamic_cast<ProjectedDoubleBatchRower*>(other)->sum_;
+    delete other;
+  }
+};
+
+void test_projection() {
+  KV_Store kv(0);
+  String name("projection");
+  DataFrameBuilder df_b("IDBS", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 3 + 11;
+  String word("word");
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, (int)ii);
+    r.set(1, ii * 0.5);
+    r.set(2, ii % 2 == 0);
+    r.set(3, &word);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+  long expected = (long)count * (count - 1) / 2;
+
+  IntArray cols(2);
+  cols.push(0);
+  cols.push(2);
+  ProjectedSumRower sum;
+  df->map(sum, cols);
+  GT_EQUALS(sum.sum_, expected);
+  ProjectedSumRower local_sum;
+  df->local_map(local_sum, cols);
+  GT_EQUALS(local_sum.sum_, expected);
+  ProjectedSumRower psum;
+  df->pmap(psum, cols, 3);
+  GT_EQUALS(psum.sum_, expected);
+  ProjectedSumRower local_psum;
+  df->local_pmap(local_psum, cols);
+  GT_EQUALS(local_psum.sum_, expected);
+
+  // Batches only hold the chunks of the projected columns
+  IntArray double_col(1);
+  double_col.push(1);
+  ProjectedDoubleBatchRower doubles;
+  df->pmap(doubles, double_col);
+  GT_EQUALS(doubles.sum_, count * (count - 1) / 4.0);
+  ProjectedDoubleBatchRower local_doubles;
+  df->local_map(local_doubles, double_col);
+  GT_EQUALS(local_doubles.sum_, doubles.sum_);
+
+  delete df;
+  printf("Dataframe projection test passed!\n");
+}
+
+void test_int_encodings() {
+  KV_Store kv(0);
+  String name("encoded");
+  DataFrameBuilder df_b("II", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 2 + 9;
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, (int)(ii * 5));
+    r.set(1, (int)(ii / 25 * 1000));
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  // The builder picks the encoding of every chunk, chunks are plain once read
+  char expected[2] = { DELTA_INT_ENCODING, RLE_INT_ENCODING };
+  for (size_t col = 0; col < 2; col++) {
+    char* serial = kv.get_value_serial(df->get_column(col)->keys_->get(0));
+    GT_EQUALS(serial[2 * sizeof(size_t)], expected[col]);
+    delete[] serial;
+  }
+  for (size_t ii = 0; ii < count; ii++) {
+    GT_EQUALS(df->get_int(0, ii), ii * 5);
+    GT_EQUALS(df->get_int(1, ii), ii / 25 * 1000);
+  }
+  GT_EQUALS(df->sum(0), 5.0 * count * (count - 1) / 2);
+
+  delete df;
+  printf("Dataframe int encodings test passed!\n");
+}
+
+void test_bool_ops() {
+  KD_Store kd(0);
+  String name("flags");
+  DataFrameBuilder df_b("BIB", &name, kd.get_kv());
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 3 + 17;
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, ii % 3 == 0);
+    r.set(1, (int)ii);
+    r.set(2, ii % 2 == 0);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+  GT_EQUALS(df->count_true(0), (count + 2) / 3);
+  GT_EQUALS(df->get_column(2)->count_true(), (count + 1) / 2);
+
+  Key and_key("flags_and", 0);
+  DataFrame* both = df->bools_and(&and_key, &kd, 0, 2);
+  Key or_key("flags_or", 0);
+  DataFrame* either = df->bools_or(&or_key, &kd, 0, 2);
+  Key not_key("flags_not", 0);
+  DataFrame* not_first = df->bools_not(&not_key, &kd, 0);
+  GT_EQUALS(both->nrows(), count);
+  GT_EQUALS(both->num_chunks(), df->num_chunks());
+  for (size_t ii = 0; ii < count; ii++) {
+    GT_EQUALS(both->get_bool(0, ii), (ii % 6 == 0));
+    GT_EQUALS(either->get_bool(0, ii), (ii % 3 == 0 || ii % 2 == 0));
+    GT_EQUALS(not_first->get_bool(0, ii), (ii % 3 != 0));
+  }
+  GT_EQUALS(both->count_true(0), (count + 5) / 6);
+  DataFrame* stored = kd.get(&not_key);
+  GT_EQUALS(stored->count_true(0), count - (count + 2) / 3);
+
+  delete stored;
+  delete not_first;
+  delete either;
+  delete both;
+  delete df;
+  printf("Dataframe bool ops test passed!\n");
+}
+
+void test_dict_strings() {
+  KD_Store kd(0);
+  Key key("colors", 0);
+  size_t count = ELEMENT_ARRAY_SIZE * 2 + 3;
+  String red("red");
+  String green("green");
+  String** vals = new String*[count];
+  for (size_t ii = 0; ii < count; ii++) vals[ii] = ii % 4 == 0 ? &green : &red;
+  DataFrame* df = DataFrame::from_array(&key, &kd, count, vals);
+
+  // Low cardinality chunks are dictionary encoded, except the last one which is too short and
+  // keeps its strings in a blob
+  Column* col = df->get_column(0);
+  GT_TRUE(dynamic_cast<DictStringArray*>(col->get_chunk(0)) != nullptr);
+  GT_TRUE(dynamic_cast<BlobStringArray*>(col->get_chunk(2)) != nullptr);
+  for (size_t ii = 0; ii < count; ii++) GT_TRUE(df->get_string(0, ii)->equals(vals[ii]));
+  GT_EQUALS(df->count_equal(0, &green), (count + 3) / 4);
+  GT_EQUALS(col->count_equal(&red), count - (count + 3) / 4);
+  String blue("blue");
+  GT_EQUALS(df->count_equal(0, &blue), 0);
+  // Equality filters select the rows on the codes, and skip chunks lacking the value
+  Key greens_key("greens", 0);
+  DataFrame* greens = df->filter(&greens_key, &kd, 0, &green);
+  GT_EQUALS(greens->nrows(), (count + 3) / 4);
+  for (size_t ii = 0; ii < greens->nrows(); ii++)
+    GT_TRUE(greens->get_string(0, ii)->equals(&green));
+  Key blues_key("blues", 0);
+  DataFrame* blues = df->filter(&blues_key, &kd, 0, &blue);
+  GT_EQUALS(blues->nrows(), 0);
+  IntArray rows(1);
+  equal_strings_rows(static_cast<StringArray*>(col->get_chunk(0)), &red, &rows);
+  GT_EQUALS(rows.length(), ELEMENT_ARRAY_SIZE - ELEMENT_ARRAY_SIZE / 4);
+  GT_EQUALS(rows.get(0), 1);
+  delete blues;
+  delete greens;
+
+  // Distinct strings are kept in a blob, and read as views into it
+  Key words_key("distinct", 0);
+  String** words = new String*[ELEMENT_ARRAY_SIZE];
+  for (size_t ii = 0; ii < ELEMENT_ARRAY_SIZE; ii++) {
+    words[ii] = new String("w");
+    words[ii]->concat(ii);
+  }
+  DataFrame* distinct = DataFrame::from_array(&words_key, &kd, ELEMENT_ARRAY_SIZE, words);
+  BlobStringArray* blob = dynamic_cast<BlobStringArray*>(distinct->get_column(0)->get_chunk(0));
+  GT_TRUE(blob != nullptr);
+  GT_EQUALS(distinct->get_string(0, 12)->c_str(), blob->chars(12));
+  GT_TRUE(distinct->get_string(0, 12)->equals(words[12]));
+  GT_EQUALS(distinct->count_equal(0, words[7]), 1);
+  GT_EQUALS(distinct->count_equal(0, &blue), 0);
+
+  for (size_t ii = 0; ii < ELEMENT_ARRAY_SIZE; ii++) delete words[ii];
+  delete[] words;
+  delete distinct;
+  delete[] vals;
+  delete df;
+  printf("Dataframe dictionary strings test passed!\n");
+}
+
+void test_read_ahead() {
+  int cpid[2];
+  String* server_ip = new String("127.0.0.1");
+  String* client_ip1 = new String("127.0.0.2");
+  String* client_ip2 = new String("127.0.0.3");
+  size_t count = ELEMENT_ARRAY_SIZE * 10;
+  long expected_sum = (long)count * (count - 1) / 2;
+
+  RServer* server = new RServer(server_ip->c_str());
+
+  if ((cpid[0] = fork())) {
+
+  } else {
+    // Node 1 scans the frame, half of its chunks are homed on node 0
+    sleep(0.5);
+    KD_Store* kd = new KD_Store(1, client_ip1->c_str(), server_ip->c_str());
+    sleep(2);
+
+    Key* key = new Key("ints", 0);
+    DataFrame* df = kd->wait_and_get(key);
+    ReadAhead* read_ahead = df->get_column(0)->get_read_ahead();
+
+    IntSumRower sync_sum;
+    df->set_read_ahead(0);
+    df->map(sync_sum);
+    GT_EQUALS(sync_sum.sum_, expected_sum);
+    GT_EQUALS(read_ahead->stalls(), 5);
+    GT_EQUALS(read_ahead->issued(), 0);
+
+    DataFrame* df2 = kd->get(key);
+    read_ahead = df2->get_column(0)->get_read_ahead();
+    IntSumRower sum;
+    df2->set_read_ahead(2);
+    df2->map(sum);
+    GT_EQUALS(sum.sum_, expected_sum);
+    // Only the first remote chunk is reached before the scan is known to be sequential
+    GT_EQUALS(read_ahead->issued(), 4);
+    GT_EQUALS(read_ahead->stalls(), 1);
+    GT_EQUALS(read_ahead->hidden() + read_ahead->partially_hidden(), 4);
+
+    // A jump drops the fetch it left behind, so the next sequential scan reads ahead again
+    DataFrame* df3 = kd->get(key);
+    Column* col = df3->get_column(0);
+    read_ahead = col->get_read_ahead();
+    df3->set_read_ahead(1);
+    col->get_chunk(0);
+    col->get_chunk(1);
+    GT_EQUALS(read_ahead->issued(), 1);
+    for (size_t ii = 5; ii < 10; ii++) col->get_chunk(ii);
+    GT_EQUALS(read_ahead->dropped(), 1);
+    GT_EQUALS(read_ahead->issued(), 2);
+    GT_EQUALS(read_ahead->stalls(), 2);
+    GT_EQUALS(read_ahead->hidden() + read_ahead->partially_hidden(), 1);
+    IntSumRower rescan_sum;
+    df3->map(rescan_sum);
+    GT_EQUALS(rescan_sum.sum_, expected_sum);
+
+    kd->application_complete();
+
+    delete df;
+    delete df2;
+    delete df3;
+    delete kd;
+    delete key;
+    delete server_ip;
+    delete client_ip1;
+    delete client_ip2;
+    delete server;
+    exit(0);
+  }
+
+  if ((cpid[1] = fork())) {
+
+  } else {
+    // Node 0 builds the frame, chunks alternate between the two nodes
+    sleep(0.5);
+    KD_Store* kd = new KD_Store(0, client_ip2->c_str(), server_ip->c_str());
+    sleep(2);
+
+    Key* key = new Key("ints", 0);
+    int* vals = new int[count];
+    for (size_t ii = 0; ii < count; ii++) vals[ii] = ii;
+    delete DataFrame::from_array(key, kd, count, vals);
+
+    kd->application_complete();
+
+    delete kd;
+    delete key;
+    delete[] vals;
+    delete server_ip;
+    delete client_ip1;
+    delete client_ip2;
+    delete server;
+    exit(0);
+  }
+
+  server->run_server(10);
+  server->wait_for_shutdown();
+
+  int st;
+  waitpid(cpid[0], &st, 0);
+  GT_EQUALS(st, 0);
+  waitpid(cpid[1], &st, 0);
+  GT_EQUALS(st, 0);
+  delete server;
+  delete client_ip1;
+  delete client_ip2;
+  delete server_ip;
+  printf("Dataframe read ahead test passed!\n");
+}
+
+void test_kernels() {
+  // Odd lengths exercise the scalar tails of the vector loops
+  size_t n = 103;
+  int* ints = new int[n];
+  double* doubles = new double[n];
+  for (size_t ii = 0; ii < n; ii++) {
+    ints[ii] = (int)((ii * 7919) % 201) - 100;
+    doubles[ii] = ints[ii] * 0.5;
+  }
+  SimdLevel levels[3] = { SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2 };
+  for (size_t ii = 0; ii < 3; ii++) {
+    set_simd_level(levels[ii]);
+    for (size_t len = 1; len <= n; len += 17) {
+      GT_EQUALS(sum_ints(ints, len), sum_ints_scalar_(ints, len));
+      GT_EQUALS(sum_doubles(doubles, len), sum_doubles_scalar_(doubles, len));
+      GT_EQUALS(min_ints(ints, len), min_ints_scalar_(ints, len));
+      GT_EQUALS(max_ints(ints, len), max_ints_scalar_(ints, len));
+      GT_EQUALS(min_doubles(doubles, len), min_doubles_scalar_(doubles, len));
+      GT_EQUALS(max_doubles(doubles, len), max_doubles_scalar_(doubles, len));
+      GT_EQUALS(count_if_ints(ints, len, CmpOp::Lt, -10), count_if_ints_scalar_(ints, len, CmpOp::Lt, -10));
+      GT_EQUALS(count_if_ints(ints, len, CmpOp::Eq, 3), count_if_ints_scalar_(ints, len, CmpOp::Eq, 3));
+      GT_EQUALS(count_if_doubles(doubles, len, CmpOp::Ge, 1.5), 
+        count_if_doubles_scalar_(doubles, len, CmpOp::Ge, 1.5));
+      GT_EQUALS(count_if_doubles(doubles, len, CmpOp::Ne, 0), 
+        count_if_doubles_scalar_(doubles, len, CmpOp::Ne, 0));
+    }
+  }
+  set_simd_level(SimdLevel::Avx2);
+
+  // Word at a time bool operations, the bits past the last element stay clear
+  BoolArray a(n);
+  BoolArray b(n);
+  for (size_t ii = 0; ii < n; ii++) {
+    a.push(ii % 3 == 0);
+    b.push(ii % 2 == 0);
+  }
+  for (size_t ii = 0; ii < 3; ii++) {
+    set_simd_level(levels[ii]);
+    BoolArray* both = bool_op(&a, BoolOp::And, &b);
+    BoolArray* either = bool_op(&a, BoolOp::Or, &b);
+    BoolArray* not_a = bool_op(&a, BoolOp::Not, nullptr);
+    for (size_t jj = 0; jj < n; jj++) {
+      GT_EQUALS(both->get(jj), (jj % 6 == 0));
+      GT_EQUALS(either->get(jj), (jj % 3 == 0 || jj % 2 == 0));
+      GT_EQUALS(not_a->get(jj), (jj % 3 != 0));
+    }
+    GT_EQUALS(count_true(both), (n + 5) / 6);
+    GT_EQUALS(count_true(not_a), n - (n + 2) / 3);
+    delete both;
+    delete either;
+    delete not_a;
+  }
+  set_simd_level(SimdLevel::Avx2);
+
+  delete[] ints;
+  delete[] doubles;
+  printf("Dataframe kernels test passed!\n");
+}
+
+void test_aggregate() {
+  KV_Store kv(0);
+  String name("agg");
+  DataFrameBuilder df_b("IDB", &name, &kv);
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 3 + 7;
+  for (size_t ii = 0; ii < count; ii++) {
+    r.set(0, (int)ii - 50);
+    r.set(1, ii * 0.25);
+    r.set(2, ii % 3 == 0);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  GT_EQUALS(df->sum(0), (double)((long)count * (count - 1) / 2 - 50 * (long)count));
+  GT_EQUALS(df->min(0), -50);
+  GT_EQUALS(df->max(0), count - 51);
+  GT_EQUALS(df->count(0), count);
+  GT_EQUALS(df->count_if(0, CmpOp::Lt, 0), 50);
+  GT_EQUALS(df->sum(1), count * (count - 1) / 8.0);
+  GT_EQUALS(df->mean(1), (count - 1) / 8.0);
+  GT_EQUALS(df->max(1), (count - 1) * 0.25);
+  GT_EQUALS(df->count_if(1, CmpOp::Ge, 10), count - 40);
+  GT_EQUALS(df->sum(2), (count + 2) / 3);
+  GT_EQUALS(df->min(2), 0);
+  GT_EQUALS(df->max(2), 1);
+  GT_EQUALS(df->count_if(2, CmpOp::Eq, 0), count - (count + 2) / 3);
+
+  // Columns aggregate on their own, with the same results
+  Column* ints = df->get_column(0);
+  GT_EQUALS(ints->sum(), df->sum(0));
+  GT_EQUALS(ints->min(), df->min(0));
+  GT_EQUALS(ints->mean(), df->mean(0));
+  GT_EQUALS(df->get_column(2)->count_if(CmpOp::Gt, 0), (count + 2) / 3);
+
+  delete df;
+  printf("Dataframe aggregate test passed!\n");
+}
+
+void test_missing() {
+  KD_Store kd(0);
+  String name("gaps");
+  DataFrameBuilder df_b("IDBS", &name, kd.get_kv());
+  Row r(df_b.df_->get_schema());
+  size_t count = ELEMENT_ARRAY_SIZE * 3 + 7;
+  for (size_t ii = 0; ii < count; ii++) {
+    String word("w");
+    word.concat(ii % 4);
+    r.set(0, (int)ii);
+    r.set(1, ii * 0.5);
+    r.set(2, ii % 2 == 0);
+    r.set(3, &word);
+    // Every fifth int, double and string is missing, and every bool of the first chunk
+    if (ii % 5 == 0) {
+      r.set_missing(0);
+      r.set_missing(1);
+      r.set_missing(3);
+    }
+    if (ii < ELEMENT_ARRAY_SIZE) r.set_missing(2);
+    df_b.add_row(r);
+  }
+  DataFrame* df = df_b.done();
+
+  size_t num_missing = (count + 4) / 5;
+  GT_EQUALS(df->num_missing(0), num_missing);
+  GT_EQUALS(df->num_missing(2), ELEMENT_ARRAY_SIZE);
+  GT_TRUE(df->is_missing(3, 5));
+  GT_FALSE(df->is_missing(3, 6));
+  GT_EQUALS(df->get_string(3, 5), nullptr);
+  GT_EQUALS(df->chunk_zone(0, 0).nulls_, ELEMENT_ARRAY_SIZE / 5);
+  Row read(df->get_schema());
+  df->fill_row(10, read);
+  GT_TRUE(read.is_missing(0) && read.is_missing(2) && read.get_string(3) == nullptr);
+  df->fill_row(11, read);
+  GT_TRUE(read.is_missing(2));
+  GT_FALSE(read.is_missing(0) || read.is_missing(3));
+  GT_EQUALS(read.get_int(0), 11);
+
+  // Aggregates leave missing values out
+  double sum = 0;
+  int max = 0;
+  size_t positive = 0;
+  for (size_t ii = 0; ii < count; ii++) {
+    if (ii % 5 == 0) continue;
+    sum += ii;
+    max = ii;
+    positive += ii > 100;
+  }
+  GT_EQUALS(df->sum(0), sum);
+  GT_EQUALS(df->min(0), 1);
+  GT_EQUALS(df->max(0), max);
+  GT_EQUALS(df->count(0), count - num_missing);
+  GT_EQUALS(df->mean(1), sum * 0.5 / (count - num_missing));
+  GT_EQUALS(df->count_if(0, CmpOp::Gt, 100), positive);
+  GT_EQUALS(df->count_if(0, CmpOp::Lt, 1), 0);
+  GT_EQUALS(df->count(2), count - ELEMENT_ARRAY_SIZE);
+  GT_EQUALS(df->min(2), 0);
+
+  // Missing keys form their own group, missing values are left out of it
+  GroupAggregates aggregates;
+  aggregates.add(AggOp::Count, 0);
+  aggregates.add(AggOp::Sum, 0);
+  aggregates.add(AggOp::Min, 1);
+  IntArray by_word(1);
+  by_word.push(3);
+  Key words_key("gaps_by_word", 0);
+  DataFrame* words = df->group_by(&words_key, &kd, by_word, aggregates);
+  GT_EQUALS(words->nrows(), 5);
+  size_t grouped = 0;
+  for (size_t ii = 0; ii < words->nrows(); ii++) {
+    grouped += words->get_int(1, ii);
+    if (!words->is_missing(0, ii)) continue;
+    GT_EQUALS(words->get_int(1, ii), num_missing);
+    GT_TRUE(words->is_missing(2, ii) && words->is_missing(3, ii));
+  }
+  GT_EQUALS(grouped, count);
+  delete words;
+
+  // Missing values sort first
+  IntArray by_int(1);
+  by_int.push(0);
+  Key sorted_key("gaps_sorted", 0);
+  DataFrame* sorted = df->sort(&sorted_key, &kd, by_int, true);
+  GT_EQUALS(sorted->nrows(), count);
+  for (size_t ii = 0; ii < num_missing; ii++) GT_TRUE(sorted->is_missing(0, ii));
+  GT_EQUALS(sorted->get_int(0, num_missing), 1);
+  GT_TRUE(sorted->is_missing(3, 0));
+  delete sorted;
+
+  // Rowers reading strings skip the missing ones
+  String words_name("gap_words");
+  DataFrameBuilder words_b("S", &words_name, kd.get_kv());
+  Row word_row(words_b.df_->get_schema());
+  for (size_t ii = 0; ii < count; ii++) {
+    if (df->is_missing(3, ii)) word_row.set_missing(0);
+    else word_row.set(0, df->get_string(3, ii));
+    words_b.add_row(word_row);
+  }
+  DataFrame* gap_words = words_b.done();
+  SIMap counts;
+  Adder adder(counts);
+  gap_words->map(adder);
+  GT_EQUALS(counts.size(), 4);
+  delete gap_words;
+
+  delete df;
+  printf("Dataframe missing values test passed!\n");
+}
+
+/*******************************************************************************
+ *  BorrowCheckRower::
+ *  Checks that the rows of a map over an "S" DataFrame borrow the strings of
+ *  its chunks rather than copies, and counts them.
+ */
+class BorrowCheckRower : public Rower {
+ public:
+  DataFrame* df_; // not owned
+  size_t rows_ = 0;
+
+  BorrowCheckRower(DataFrame* df) : df_(df) { }
+
+  bool accept(Row& r) {
+    assert(r.borrows() && r.get_string(0) == df_->get_string(0, rows_));
+    rows_++;
+    return true;
+  }
+
+  void join_delete(Rower* other) { delete other; }
+};
+
+void test_borrowed_rows() {
+  KD_Store kd(0);
+  // A borrowing row keeps the strings it is given
+  Schema schema("SI");
+  String hello("hello");
+  Row borrowing(schema, true);
+  borrowing.set(0, &hello);
+  GT_EQUALS(borrowing.get_string(0), &hello);
+  borrowing.set_missing(0);
+  GT_EQUALS(borrowing.get_string(0), nullptr);
+  Row owning(schema);
+  owning.set(0, &hello);
+  GT_TRUE(owning.get_string(0) != &hello && owning.get_string(0)->equals(&hello));
+
+  // Moving a row hands its strings to the builder
+  String name("moved");
+  DataFrameBuilder df_b(schema, &name, kd.get_kv());
+  size_t count = ELEMENT_ARRAY_SIZE + 9;
+  for (size_t ii = 0; ii < count; ii++) {
+    String word("w");
+    word.concat(ii);
+    owning.set(0, &word);
+    owning.set(1, (int)ii);
+    if (ii == 4) owning.set_missing(0);
+    String* taken = owning.get_string(0);
+    df_b.move_row(owning);
+    GT_TRUE(owning.is_missing(0));
+    GT_FALSE(owning.is_missing(1));
+    if (ii == 7) GT_EQUALS(static_cast<StringArray*>(df_b.buffers_.get(0))->get(7), taken);
+  }
+  DataFrame* df = df_b.done();
+  GT_EQUALS(df->nrows(), count);
+  GT_TRUE(df->is_missing(0, 4));
+  String last("w");
+  last.concat(count - 1);
+  GT_TRUE(df->get_string(0, count - 1)->equals(&last));
+
+  // Maps hand out the strings of the chunks
+  String** words = new String*[count];
+  for (size_t ii = 0; ii < count; ii++) {
+    String* word = df->get_string(0, ii);
+    words[ii] = word ? word->clone() : hello.clone();
+  }
+  Key words_key("borrowed_words", 0);
+  DataFrame* strings = DataFrame::from_array(&words_key, &kd, count, words);
+  BorrowCheckRower check(strings);
+  strings->map(check);
+  GT_EQUALS(check.rows_, count);
+
+  for (size_t ii = 0; ii < count; ii++) delete words[ii];
+  delete[] words;
+  delete strings;
+  delete df;
+  printf("Dataframe borrowed rows test passed!\n");
+}
+
+void test_bulk_append() {
+  KV_Store kv(0);
+  // A column appended in bulk is cut into chunks of the usual rows
+  String ints_name("bulk_ints");
+  DataFrameBuilder ints_b("I", &ints_name, &kv);
+  ints_b.set_chunk_rows(40);
+  int vals[130];
+  for (int ii = 0; ii < 130; ii++) vals[ii] = ii * 3;
+  ints_b.append_column_range(0, vals, 25);
+  ints_b.append_column_range(0, vals + 25, 105);
+  DataFrame* ints = ints_b.done();
+  GT_EQUALS(ints->nrows(), 130);
+  GT_EQUALS(ints->num_chunks(), 4);
+  GT_EQUALS(ints->chunk_length(3), 10);
+  GT_EQUALS(ints->get_int(0, 0), 0);
+  GT_EQUALS(ints->get_int(0, 41), 123);
+  GT_EQUALS(ints->get_int(0, 129), 387);
+
+  // Columns appended out of step only make chunks of the rows they all hold
+  String mixed_name("bulk_mixed");
+  DataFrameBuilder mixed_b("IDBS", &mixed_name, &kv);
+  mixed_b.set_chunk_rows(40);
+  double doubles[130];
+  bool bools[130];
+  String** strings = new String*[130];
+  for (size_t ii = 0; ii < 130; ii++) {
+    doubles[ii] = ii * 0.5;
+    bools[ii] = ii % 3 == 0;
+    strings[ii] = nullptr;
+    if (ii % 7 != 0) {
+      strings[ii] = new String("s");
+      strings[ii]->concat(ii);
+    }
+  }
+  mixed_b.append_column_range(0, vals, 130);
+  GT_EQUALS(mixed_b.df_->nrows(), 0);
+  Array* ahead = mixed_b.buffer_(0);
+  mixed_b.append_column_range(1, doubles, 60);
+  mixed_b.append_column_range(2, bools, 130);
+  mixed_b.append_column_range(3, strings, 50);
+  GT_EQUALS(mixed_b.df_->nrows(), 50);
+  GT_EQUALS(mixed_b.df_->num_chunks(), 1);
+  // The rows past the chunk stay where they were appended, the chunk was copied out of them
+  GT_TRUE(mixed_b.buffer_(0) == ahead && mixed_b.starts_[0] == 40);
+  mixed_b.append_column_range(3, strings + 50, 80);
+  mixed_b.append_column_range(1, doubles + 60, 70);
+  DataFrame* mixed = mixed_b.done();
+  GT_EQUALS(mixed->nrows(), 130);
+  GT_EQUALS(mixed->num_chunks(), 4);
+  for (size_t ii = 0; ii < 130; ii++) {
+    GT_EQUALS(mixed->get_int(0, ii), vals[ii]);
+    GT_EQUALS(mixed->get_double(1, ii), doubles[ii]);
+    GT_EQUALS(mixed->get_bool(2, ii), bools[ii]);
+    if (strings[ii]) GT_TRUE(mixed->get_string(3, ii)->equals(strings[ii]));
+    else GT_TRUE(mixed->is_missing(3, ii));
+  }
+
+  // Batches are appended a column at a time, keeping their missing values
+  String copy_name("bulk_copy");
+  DataFrameBuilder copy_b("IDBS", &copy_name, &kv);
+  copy_b.set_chunk_rows(40);
+  Schema schema("IDBS");
+  IntArray batch_ints(1);
+  DoubleArray batch_doubles(1);
+  BoolArray batch_bools(1);
+  StringArray batch_strings(1);
+  for (size_t ii = 0; ii < 70; ii++) {
+    batch_ints.push(vals[ii]);
+    batch_doubles.push(doubles[ii]);
+    batch_bools.push(bools[ii]);
+    batch_strings.push(strings[ii]);
+  }
+  batch_doubles.set_missing(5);
+  RowBatch batch(schema);
+  batch.set_chunk(0, &batch_ints);
+  batch.set_chunk(1, &batch_doubles);
+  batch.set_chunk(2, &batch_bools);
+  batch.set_chunk(3, &batch_strings);
+  batch.set_range(0, 70);
+  copy_b.append_batch(batch);
+  copy_b.append_batch(batch);
+  DataFrame* copy = copy_b.done();
+  GT_EQUALS(copy->nrows(), 140);
+  GT_EQUALS(copy->num_chunks(), 4);
+  GT_TRUE(copy->is_missing(1, 5));
+  GT_TRUE(copy->is_missing(1, 75));
+  GT_FALSE(copy->is_missing(1, 76));
+  GT_EQUALS(copy->get_int(0, 139), vals[69]);
+  GT_TRUE(copy->is_missing(3, 77));
+  GT_TRUE(copy->get_string(3, 78)->equals(strings[8]));
+
+  for (size_t ii = 0; ii < 130; ii++) delete strings[ii];
+  delete[] strings;
+  delete ints;
+  delete mixed;
+  delete copy;
+  printf("Dataframe bulk append test passed!\n");
+}
+
+void test_flush_pipeline() {
+  KV_Store kv(0);
+  // Full chunks are stored in the background, at most the flush depth of them at once
+  String piped_name("piped");
+  DataFrameBuilder piped_b("ISD", &piped_name, &kv);
+  GT_EQUALS(piped_b.get_flush_depth(), DEFAULT_FLUSH_DEPTH);
+  piped_b.set_chunk_rows(10);
+  String sync_name("sync");
+  DataFrameBuilder sync_b("ISD", &sync_name, &kv);
+  sync_b.set_flush_depth(0);
+  sync_b.set_chunk_rows(10);
+  Row row(piped_b.df_->get_schema());
+  for (size_t ii = 0; ii < 95; ii++) {
+    String word("f");
+    word.concat(ii % 4);
+    row.set(0, (int)ii);
+    row.set(1, &word);
+    row.set(2, ii * 0.25);
+    if (ii == 33) row.set_missing(2);
+    piped_b.add_row(row);
+    sync_b.add_row(row);
+    GT_TRUE(piped_b.flushes_.length() <= DEFAULT_FLUSH_DEPTH);
+    GT_EQUALS(sync_b.flushes_.length(), 0);
+  }
+  GT_EQUALS(piped_b.df_->num_chunks(), 9);
+  DataFrame* piped = piped_b.done();
+  GT_EQUALS(piped_b.flushes_.length(), 0);
+  DataFrame* sync = sync_b.done();
+  GT_EQUALS(piped->num_chunks(), 10);
+  GT_EQUALS(piped->nrows(), sync->nrows());
+  for (size_t ii = 0; ii < 95; ii++) {
+    GT_EQUALS(piped->get_int(0, ii), sync->get_int(0, ii));
+    GT_TRUE(piped->get_string(1, ii)->equals(sync->get_string(1, ii)));
+    GT_EQUALS(piped->is_missing(2, ii), (ii == 33));
+    if (ii != 33) GT_EQUALS(piped->get_double(2, ii), sync->get_double(2, ii));
+  }
+  // Zone maps are computed before the chunks are handed over
+  GT_EQUALS(piped->get_column(0)->get_zone(3).min_, 30);
+  piped_b.set_flush_depth(MAX_FLUSH_DEPTH + 3);
+  GT_EQUALS(piped_b.get_flush_depth(), MAX_FLUSH_DEPTH);
+
+  delete piped;
+  delete sync;
+  printf("Dataframe flush pipeline test passed!\n");
+}
+
+void test_placement() {
+  // Chunk placements home a chunk given its index
+  RoundRobinPlacement round_robin;
+  GT_EQUALS(round_robin.node_of_chunk(4, 3, 2), 1);
+  LocalPlacement local;
+  GT_EQUALS(local.node_of_chunk(4, 3, 2), 2);
+  IntArray capacities(3);
+  capacities.push(1);
+  capacities.push(3);
+  capacities.push(0);
+  WeightedPlacement weighted(capacities);
+  size_t homed[3] = { 0, 0, 0 };
+  for (size_t ii = 0; ii < 40; ii++) homed[weighted.node_of_chunk(ii, 3, 0)]++;
+  GT_EQUALS(homed[0], 10);
+  GT_EQUALS(homed[1], 30);
+  GT_EQUALS(homed[2], 0);
+
+  // Rows are hashed as PartitionRower hashes them, and ranged up to their bound
+  Schema schema("IS");
+  Row row(schema);
+  IntArray keys(1);
+  HashPlacement hashed(0);
+  for (int ii = 0; ii < 20; ii++) {
+    row.set(0, ii * 7);
+    keys.push(ii * 7);
+    GT_EQUALS(hashed.node_of_row(row, 3), field_hash_(&keys, 'I', ii) % 3);
+  }
+  IntArray bounds(2);
+  bounds.push(10);
+  bounds.push(20);
+  RangePlacement ranged(0, bounds);
+  int vals[6] = { 5, 10, 11, 20, 25, -3 };
+  size_t nodes[6] = { 0, 0, 1, 1, 2, 0 };
+  for (size_t ii = 0; ii < 6; ii++) {
+    row.set(0, vals[ii]);
+    GT_EQUALS(ranged.node_of_row(row, 3), nodes[ii]);
+  }
+  row.set_missing(0);
+  GT_EQUALS(ranged.node_of_row(row, 3), 0);
+  StringArray words(2);
+  String m("m");
+  words.push(&m);
+  RangePlacement by_word(1, words);
+  String apple("apple");
+  String pear("pear");
+  row.set(1, &apple);
+  GT_EQUALS(by_word.node_of_row(row, 2), 0);
+  row.set(1, &pear);
+  GT_EQUALS(by_word.node_of_row(row, 2), 1);
+
+  // Placed rows are built on their node and the frame holds them all
+  KV_Store kv(0);
+  String name("placed");
+  DataFrameBuilder placed_b(schema, &name, &kv);
+  placed_b.set_chunk_rows(10);
+  placed_b.set_placement(hashed);
+  for (int ii = 0; ii < 35; ii++) {
+    row.set(0, ii);
+    row.set(1, &pear);
+    placed_b.add_row(row);
+  }
+  IntArray batch_ints(1);
+  StringArray batch_strings(1);
+  for (int ii = 0; ii < 5; ii++) {
+    batch_ints.push(100 + ii);
+    batch_strings.push(&apple);
+  }
+  RowBatch batch(schema);
+  batch.set_chunk(0, &batch_ints);
+  batch.set_chunk(1, &batch_strings);
+  batch.set_range(0, 5);
+  placed_b.append_batch(batch);
+  DataFrame* placed = placed_b.done();
+  GT_EQUALS(placed->nrows(), 40);
+  GT_EQUALS(placed->num_chunks(), 4);
+  GT_EQUALS(placed->get_int(0, 36), 101);
+  GT_TRUE(placed->get_string(1, 39)->equals(&apple));
+  // The parts are named after the node building them, which other nodes building the frame are not
+  String part_key("placed_n0_p0_0_0");
+  GT_TRUE(placed->get_column(0)->keys_->get(0)->get_key()->equals(&part_key));
+  String local_name("local");
+  DataFrameBuilder local_b("I", &local_name, &kv);
+  local_b.set_placement(local);
+  local_b.append_column_range(0, vals, 6);
+  DataFrame* local_df = local_b.done();
+  GT_EQUALS(local_df->chunk_home_node(0), 0);
+  // Replicas never outnumber the nodes
+  local_b.set_replication(3);
+  GT_EQUALS(local_b.get_replication(), 1);
+
+  delete placed;
+  delete local_df;
+  printf("Dataframe placement test passed!\n");
+}
+
+void test_ship_map() {
+  int cpid[2];
+  String* server_ip = new String("127.0.0.1");
+  String* client_ip1 = new String("127.0.0.2");
+  String* client_ip2 = new String("127.0.0.3");
+  size_t count = ELEMENT_ARRAY_SIZE * 4;
+  rower_registry().add("IntFilterRower", IntFilterRower::deserialize);
+
+  RServer* server = new RServer(server_ip->c_str());
+
+  if ((cpid[0] = fork())) {
+
+  } else {
+    // Node 1 counts the words, half of the chunks are counted on node 0
+    sleep(0.5);
+    KD_Store* kd = new KD_Store(1, client_ip1->c_str(), server_ip->c_str());
+    sleep(2);
+
+    Key* key = new Key("words", 0);
+    DataFrame* df = kd->wait_and_get(key);
+    SIMap map;
+    Adder adder(map);
+    df->ship_map(adder);
+    String a("a");
+    String b("b");
+    GT_EQUALS(map.size(), 2);
+    GT_EQUALS(map.get(&a)->value, count / 2);
+    GT_EQUALS(map.get(&b)->value, count / 2);
+    // None of the remote chunks were fetched
+    GT_EQUALS(df->get_column(0)->get_remote_cache()->misses(), 0);
+    GT_EQUALS(df->get_column(0)->get_read_ahead()->stalls(), 0);
+
+    Key* ints_key = new Key("counts", 0);
+    DataFrame* ints = kd->wait_and_get(ints_key);
+    GT_EQUALS(ints->sum(0), (double)count * (count - 1) / 2);
+    GT_EQUALS(ints->max(0), count - 1);
+    GT_EQUALS(ints->count_if(0, CmpOp::Lt, ELEMENT_ARRAY_SIZE), ELEMENT_ARRAY_SIZE);
+    GT_EQUALS(ints->get_column(0)->get_remote_cache()->misses(), 0);
+
+    // The rows kept on node 0 stay there and follow the ones kept here
+    Key* evens_key = new Key("evens", 1);
+    IntFilterRower filter(2);
+    DataFrame* evens = ints->filter(evens_key, kd, filter);
+    GT_EQUALS(evens->nrows(), count / 2);
+    GT_EQUALS(evens->get_int(0, 0), ELEMENT_ARRAY_SIZE);
+    GT_EQUALS(evens->sum(0), (double)count * (count - 2) / 4);
+    IntArray* node_0_chunks = evens->chunks_homed_on(0);
+    IntArray* node_1_chunks = evens->chunks_homed_on(1);
+    GT_TRUE(node_0_chunks->length() > 0 && node_1_chunks->length() > 0);
+    GT_EQUALS(node_0_chunks->length() + node_1_chunks->length(), evens->num_chunks());
+    GT_EQUALS(evens->get_int(0, evens->nrows() - 1), ELEMENT_ARRAY_SIZE * 3 - 2);
+    delete node_0_chunks;
+    delete node_1_chunks;
+    delete evens;
+    delete evens_key;
+
+    // Every node finishes the groups its keys hash to
+    IntArray by_word(1);
+    by_word.push(0);
+    GroupAggregates aggregates;
+    aggregates.add(AggOp::Count, 0);
+    Key* counts_key = new Key("word_counts", 1);
+    DataFrame* counts = df->group_by(counts_key, kd, by_word, aggregates);
+    GT_EQUALS(counts->nrows(), 2);
+    GT_EQUALS(counts->get_int(1, 0), count / 2);
+    GT_EQUALS(counts->get_int(1, 1), count / 2);
+    GT_TRUE(!counts->get_string(0, 0)->equals(counts->get_string(0, 1)));
+    delete counts;
+    delete counts_key;
+
+    // Both strategies join the rows of both nodes, partitions are homed on either node
+    JoinStrategy strategies[2] = { JoinStrategy::Broadcast, JoinStrategy::Partitioned };
+    for (size_t ii = 0; ii < 2; ii++) {
+      Key* self_key = new Key("self", 1);
+      DataFrame* self = DataFrame::join(ints, ints, 0, 0, self_key, kd, strategies[ii]);
+      GT_EQUALS(self->nrows(), count);
+      GT_EQUALS(self->sum(0), (double)count * (count - 1) / 2);
+      GT_EQUALS(self->sum(1), (double)count * (count - 1) / 2);
+      IntArray* remote_chunks = self->chunks_homed_on(0);
+      GT_TRUE(remote_chunks->length() > 0 && remote_chunks->length() < self->num_chunks());
+      delete remote_chunks;
+      delete self;
+      delete self_key;
+    }
+
+    // Rows placed by hash land on the node they hash to, local chunks stay here
+    String placed_name("placed_counts");
+    DataFrameBuilder placed_b(ints->get_schema(), &placed_name, kd->get_kv());
+    HashPlacement hashed(0);
+    placed_b.set_placement(hashed);
+    Row row(ints->get_schema());
+    for (size_t ii = 0; ii < count; ii++) {
+      row.set(0, ints->get_int(0, ii));
+      placed_b.add_row(row);
+    }
+    DataFrame* placed = placed_b.done();
+    GT_EQUALS(placed->nrows(), count);
+    GT_EQUALS(placed->sum(0), (double)count * (count - 1) / 2);
+    IntArray placed_keys(1);
+    for (size_t ii = 0; ii < count; ii++) {
+      placed_keys.push(placed->get_int(0, ii));
+      GT_EQUALS(placed->chunk_home_node(placed->get_column(0)->chunk_of_(ii)),
+        field_hash_(&placed_keys, 'I', ii) % 2);
+    }
+    delete placed;
+    String kept_name("kept_counts");
+    DataFrameBuilder kept_b(ints->get_schema(), &kept_name, kd->get_kv());
+    LocalPlacement local;
+    kept_b.set_placement(local);
+    for (size_t ii = 0; ii < count; ii++) {
+      row.set(0, (int)ii);
+      kept_b.add_row(row);
+    }
+    DataFrame* kept = kept_b.done();
+    IntArray* kept_chunks = kept->local_chunks();
+    GT_EQUALS(kept_chunks->length(), kept->num_chunks());
+    delete kept_chunks;
+    delete kept;
+
+    // Replicated chunks are all read from this node
+    Key* replicated_key = new Key("replicated", 0);
+    DataFrame* replicated = kd->wait_and_get(replicated_key);
+    GT_EQUALS(replicated->get_column(0)->get_chunk_home_node(1), 1);
+    GT_EQUALS(replicated->chunk_home_node(0), 0);
+    for (size_t ii = 0; ii < replicated->num_chunks(); ii++)
+      GT_TRUE(replicated->get_column(0)->is_chunk_local(ii));
+    for (size_t ii = 0; ii < count; ii++) GT_EQUALS(replicated->get_int(0, ii), ii * 2);
+    GT_EQUALS(replicated->get_column(0)->get_remote_cache()->misses(), 0);
+    GT_EQUALS(replicated->get_column(0)->get_read_ahead()->issued(), 0);
+    GT_FALSE(ints->get_column(0)->is_chunk_local(0));
+    // A map over the replicated chunks is run from the local copies, none of it is shipped
+    IntArray* replicated_chunks = replicated->all_chunks_();
+    IntArray* ship_nodes = replicated->ship_nodes_(replicated_chunks);
+    GT_EQUALS(ship_nodes->length(), 0);
+    GT_EQUALS(replicated->sum(0), (double)count * (count - 1));
+    delete ship_nodes;
+    delete replicated_chunks;
+    delete replicated;
+    delete replicated_key;
+
+    // Every node sorts the range of the keys it is sent, the largest ones on node 0
+    IntArray by_int(1);
+    by_int.push(0);
+    Key* sorted_key = new Key("sorted", 1);
+    DataFrame* sorted = ints->sort(sorted_key, kd, by_int, false);
+    GT_EQUALS(sorted->nrows(), count);
+    for (size_t ii = 0; ii < count; ii++) GT_EQUALS(sorted->get_int(0, ii), count - 1 - ii);
+    GT_EQUALS(sorted->chunk_home_node(0), 0);
+    GT_EQUALS(sorted->chunk_home_node(sorted->num_chunks() - 1), 1);
+    delete sorted;
+    delete sorted_key;
+    delete ints;
+    delete ints_key;
+
+    kd->application_complete();
+
+    delete df;
+    delete kd;
+    delete key;
+    delete server_ip;
+    delete client_ip1;
+    delete client_ip2;
+    delete server;
+    exit(0);
+  }
+
+  if ((cpid[1] = fork())) {
+
+  } else {
+    // Node 0 builds the frame, chunks alternate between the two nodes
+    sleep(0.5);
+    KD_Store* kd = new KD_Store(0, client_ip2->c_str(), server_ip->c_str());
+    sleep(2);
+
+    Key* key = new Key("words", 0);
+    String a("a");
+    String b("b");
+    String** vals = new String*[count];
+    for (size_t ii = 0; ii < count; ii++) vals[ii] = ii % 2 == 0 ? &a : &b;
+    delete DataFrame::from_array(key, kd, count, vals);
+    Key* ints_key = new Key("counts", 0);
+    int* ints = new int[count];
+    for (size_t ii = 0; ii < count; ii++) ints[ii] = ii;
+    delete DataFrame::from_array(ints_key, kd, count, ints);
+    Key* replicated_key = new Key("replicated", 0);
+    String replicated_name("replicated");
+    DataFrameBuilder replicated_b("I", &replicated_name, kd->get_kv());
+    replicated_b.set_replication(BROADCAST_REPLICAS);
+    GT_EQUALS(replicated_b.get_replication(), 2);
+    for (size_t ii = 0; ii < count; ii++) ints[ii] = ii * 2;
+    replicated_b.append_column_range(0, ints, count);
+    DataFrame* replicated = replicated_b.done();
+    kd->put(replicated_key, replicated);
+    delete replicated;
+    delete replicated_key;
+
+    kd->application_complete();
+
+    delete kd;
+    delete key;
+    delete ints_key;
+    delete[] ints;
+    delete[] vals;
+    delete server_ip;
+    delete client_ip1;
+    delete client_ip2;
+    delete server;
+    exit(0);
+  }
+
+  server->run_server(10);
+  server->wait_for_shutdown();
+
+  int st;
+  waitpid(cpid[0], &st, 0);
+  GT_EQUALS(st, 0);
+  waitpid(cpid[1], &st, 0);
+  GT_EQUALS(st, 0);
+  delete server;
+  delete client_ip1;
+  delete client_ip2;
+  delete server_ip;
+  printf("Dataframe ship map test passed!\n");
+}
+
+/** A broadcast join whose build chunks are homed on both nodes it is shipped to, which must not
+  * wait on each other for them. */
+void test_broadcast_join() {
+  size_t num_nodes = 3;
+  int cpid[3];
+  const char* server_ip = "127.0.0.1";
+  const char* client_ips[3] = { "127.0.0.2", "127.0.0.3", "127.0.0.4" };
+  size_t count = ELEMENT_ARRAY_SIZE * 6;
+
+  RServer* server = new RServer(server_ip);
+
+  for (size_t node = 0; node < num_nodes; node++) {
+    if ((cpid[node] = fork())) continue;
+    sleep(0.5);
+    KD_Store* kd = new KD_Store(node, client_ips[node], server_ip);
+    sleep(2);
+    if (node == 0) {
+      // Both frames have chunks on every node, the smaller one is broadcast
+      Key probe_key("probe", 0);
+      Key build_key("build", 0);
+      int* ints = new int[count];
+      for (size_t ii = 0; ii < count; ii++) ints[ii] = ii;
+      DataFrame* probe = DataFrame::from_array(&probe_key, kd, count, ints);
+      for (size_t ii = 0; ii < count / 2; ii++) ints[ii] = ii * 2;
+      DataFrame* build = DataFrame::from_array(&build_key, kd, count / 2, ints);
+      for (size_t ii = 1; ii < num_nodes; ii++) {
+        IntArray* homed = build->chunks_homed_on(ii);
+        GT_TRUE(homed->length() > 0);
+        delete homed;
+      }
+
+      Key joined_key("joined", 0);
+      DataFrame* joined = DataFrame::join(probe, build, 0, 0, &joined_key, kd,
+        JoinStrategy::Broadcast);
+      GT_EQUALS(joined->nrows(), count / 2);
+      GT_EQUALS(joined->sum(0), (double)(count / 2) * (count - 2) / 2);
+      GT_EQUALS(joined->sum(1), joined->sum(0));
+      delete joined;
+      delete build;
+      delete probe;
+      delete[] ints;
+    }
+    kd->application_complete();
+    delete kd;
+    delete server;
+    exit(0);
+  }
+
+  server->run_server(10);
+  server->wait_for_shutdown();
+
+  for (size_t node = 0; node < num_nodes; node++) {
+    int st;
+    waitpid(cpid[node], &st, 0);
+    GT_EQUALS(st, 0);
+  }
+  delete server;
+  printf("Dataframe broadcast join test passed!\n");
+}
+
 int main(int argc, char **argv) {
   max_test();
   min_test();
@@ -758,10 +2615,33 @@ int main(int argc, char **argv) {
   test_get_schema();
   dataframe_constructor_tests();
   test();
+  test_chunk_cache();
+  test_chunk_sizing();
 
   // Map
   test_map_add();
   test_local_map();
+  test_read_ahead();
+  test_dict_strings();
+  test_bool_ops();
+  test_int_encodings();
+  test_projection();
+  test_filter();
+  test_zone_maps();
+  test_join();
+  test_group_by();
+  test_sort();
+  test_batch_map();
+  test_pmap();
+  test_kernels();
+  test_aggregate();
+  test_missing();
+  test_borrowed_rows();
+  test_bulk_append();
+  test_flush_pipeline();
+  test_placement();
+  test_ship_map();
+  test_broadcast_join();
 
   // From Constructors
   test_from_array_int();
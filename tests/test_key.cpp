@@ -36,10 +36,42 @@ void clone_test() {
     printf("Key clone test passed!\n");
 }
 
+void replicas_test() {
+    String key_string("replicated");
+    Key key(&key_string, 3, 2);
+    assert(key.get_replicas() == 2);
+    assert(key.replica_node(0, 4) == 3);
+    assert(key.replica_node(1, 4) == 0);
+    assert(key.is_on(3, 4) && key.is_on(0, 4));
+    assert(!key.is_on(1, 4) && !key.is_on(2, 4));
+    // Readers without a copy spread over the copies
+    assert(key.node_to_read(0, 4) == 0);
+    assert(key.node_to_read(1, 4) == 0);
+    assert(key.node_to_read(2, 4) == 3);
+    // A key homed on one node only is read from there
+    Key single(&key_string, 1);
+    assert(single.get_replicas() == 1);
+    assert(single.node_to_read(2, 4) == 1);
+    // More replicas than nodes copy the value on every node
+    Key broadcast(&key_string, 1, BROADCAST_REPLICAS);
+    assert(broadcast.num_copies(3) == 3);
+    for (size_t ii = 0; ii < 3; ii++) assert(broadcast.is_on(ii, 3));
+
+    char* serial = key.serialize();
+    Deserializer deserializer(serial);
+    Key copy(deserializer);
+    assert(copy.equals(&key) && copy.get_replicas() == 2);
+    // The replica count is part of the key, a broadcast copy is a different key
+    assert(!single.equals(&broadcast) && !broadcast.equals(&single));
+    delete[] serial;
+    printf("Key replicas test passed!\n");
+}
+
 int main(int argc, char const *argv[]) 
 {   
     constructor_test();
     clone_test();
+    replicas_test();
     printf("All Key tests passed!\n");
     return 0;
 } 
\ No newline at end of file
@@ -177,12 +177,16 @@ public:
     SetUpdater upd(delta);  
     newUsers->map(upd); // all of the new users are copied to delta.
     delete newUsers;
+    // The taggers only read the pid and the author uid of the commits
+    IntArray pid_uid(2);
+    pid_uid.push(0);
+    pid_uid.push(1);
     ProjectsTagger ptagger(delta, *pSet, projects);
-    commits->local_map(ptagger); // marking all projects touched by delta
+    commits->local_pmap(ptagger, pid_uid); // marking all projects touched by delta
     merge(ptagger.newProjects, "projects", stage);
     pSet->union_(ptagger.newProjects); // 
     UsersTagger utagger(ptagger.newProjects, *uSet, users);
-    commits->local_map(utagger);
+    commits->local_pmap(utagger, pid_uid);
     merge(utagger.newUsers, "users", stage + 1);
     uSet->union_(utagger.newUsers);
   }
@@ -409,9 +413,45 @@ void test_set_writer() {
   printf("Set writer test passed!\n");
 }
 
+void test_taggers() {
+  KD_Store kd(0);
+  Key key("commits", 0);
+  // pid x uid, user i commits to project i / 2
+  size_t count = ELEMENT_ARRAY_SIZE * 3;
+  Schema schema("II");
+  DataFrameBuilder df_b(schema, key.get_key(), kd.get_kv());
+  Row row(schema);
+  for (size_t ii = 0; ii < count; ii++) {
+    row.set(0, (int)(ii / 2));
+    row.set(1, (int)ii);
+    df_b.add_row(row);
+  }
+  DataFrame* commits = df_b.done();
+
+  Set uSet(count);
+  Set pSet(count / 2);
+  uSet.set(10);
+  uSet.set(count - 1);
+  ProjectsTagger ptagger(uSet, pSet, commits);
+  commits->local_pmap(ptagger);
+  assert(ptagger.newProjects.tagged() == 2);
+  assert(ptagger.newProjects.test(5) && ptagger.newProjects.test(count / 2 - 1));
+
+  Set users(count);
+  UsersTagger utagger(ptagger.newProjects, users, commits);
+  commits->local_pmap(utagger);
+  assert(utagger.newUsers.tagged() == 4);
+  assert(utagger.newUsers.test(10) && utagger.newUsers.test(11));
+  assert(utagger.newUsers.test(count - 2) && utagger.newUsers.test(count - 1));
+
+  delete commits;
+  printf("Taggers test passed!\n");
+}
+
 int main(int argc, char** argv) {
   test_set();
   test_set_updater();
   test_set_writer();
+  test_taggers();
   test_linus();
 }
\ No newline at end of file
@@ -463,6 +463,97 @@ void test_int_array() {
     printf("IntArray serialization passed!\n");
 }
 
+/** Round trips the ints with the encoding cheapest_encoding picks, which must be expected. */
+void check_int_encoding(IntArray& ints, char expected) {
+    char encoding = ints.cheapest_encoding();
+    assert(encoding == expected);
+    size_t plain_len = ints.serial_len();
+    ints.set_encoding(encoding);
+    assert(encoding == PLAIN_INT_ENCODING || ints.serial_len() < plain_len);
+    char* serial = ints.serialize();
+    Deserializer deserializer(serial);
+    IntArray decoded(deserializer);
+    assert(deserializer.get_serial_index() == ints.serial_len());
+    assert(decoded.equals(&ints) && decoded.serial_len() == plain_len);
+    delete[] serial;
+}
+
+void test_int_encodings() {
+    size_t count = 1000;
+    IntArray sorted(count);
+    IntArray clustered(count);
+    IntArray runs(count);
+    IntArray wide(count);
+    for (size_t ii = 0; ii < count; ii++) {
+        sorted.push(1000000 + ii * 3 + ii % 2);
+        clustered.push(-500 + (ii * 7919) % 100);
+        runs.push(ii / 250 - 2);
+        wide.push((int)((ii * 2654435761u) ^ (ii << 20)));
+    }
+    check_int_encoding(sorted, DELTA_INT_ENCODING);
+    check_int_encoding(clustered, FOR_INT_ENCODING);
+    check_int_encoding(runs, RLE_INT_ENCODING);
+    check_int_encoding(wide, PLAIN_INT_ENCODING);
+    // The statistics of an encoding are gathered once, changing the ints drops it
+    IntStats_ stats(runs.ints_, runs.length());
+    runs.set_encoding(stats.cheapest_encoding(), stats);
+    assert(runs.serial_len() == runs.header_serial_len_() + stats.encoded_len(RLE_INT_ENCODING));
+    runs.push(7);
+    assert(runs.encoding_ == PLAIN_INT_ENCODING);
+
+    // Extremes need the full 32 bits of offset and 33 bits of delta
+    IntArray extremes(4);
+    extremes.push(INT32_MAX);
+    extremes.push(INT32_MIN);
+    extremes.push(INT32_MAX);
+    extremes.push(0);
+    IntArray* encodings[3] = { &extremes, &extremes, &extremes };
+    char kinds[3] = { FOR_INT_ENCODING, DELTA_INT_ENCODING, RLE_INT_ENCODING };
+    for (size_t ii = 0; ii < 3; ii++) {
+        encodings[ii]->set_encoding(kinds[ii]);
+        char* serial = encodings[ii]->serialize();
+        Deserializer deserializer(serial);
+        IntArray decoded(deserializer);
+        assert(decoded.equals(&extremes));
+        delete[] serial;
+    }
+    IntArray single(1);
+    single.push(-7);
+    check_int_encoding(single, PLAIN_INT_ENCODING);
+    printf("IntArray encodings passed!\n");
+}
+
+void test_dense_array_serial_len() {
+    size_t header = sizeof(size_t) + sizeof(size_t) + sizeof(char);
+    IntArray int_array(1);
+    DoubleArray double_array(1);
+    BoolArray bool_array(1);
+    for (size_t ii = 0; ii < 130; ii++) {
+        int_array.push(ii);
+        double_array.push(ii * 0.5);
+        bool_array.push(ii % 2);
+    }
+    assert(int_array.serial_len() == header + 130 * sizeof(int));
+    assert(double_array.serial_len() == header + 130 * sizeof(double));
+    // 130 bools need three 64 bit words
+    assert(bool_array.serial_len() == header + 3 * sizeof(uint64_t));
+
+    char* serial = bool_array.serialize();
+    Deserializer deserializer(serial);
+    BoolArray bool_array2(deserializer);
+    assert(bool_array2.equals(&bool_array));
+    assert(bool_array2.size_ == 130);
+    delete[] serial;
+
+    serial = double_array.serialize();
+    Deserializer deserializer2(serial);
+    DoubleArray double_array2(deserializer2);
+    assert(double_array2.equals(&double_array));
+    assert(deserializer2.get_serial_index() == double_array.serial_len());
+    delete[] serial;
+    printf("Dense array serial length passed!\n");
+}
+
 void test_string_array() {
     String string1("big lol");
     String string2("hellko");
@@ -1281,6 +1372,179 @@ void serialize_clone_test() {
     printf("Serializer clone passed!\n");
 }
 
+void test_dict_string_array() {
+    String red("red");
+    String green("green");
+    StringArray strings(4);
+    for (size_t ii = 0; ii < 300; ii++) strings.push(ii % 3 == 0 ? &green : &red);
+
+    DictStringArray* dict = DictStringArray::encode(strings, 2);
+    assert(dict->length() == 300);
+    assert(dict->dictionary()->length() == 2);
+    assert(dict->get(0)->equals(&green) && dict->get(1)->equals(&red));
+    assert(dict->code_of(&green) == 0 && dict->codes()[297] == 0);
+    assert(dict->equals(&strings));
+    // One byte per code
+    assert(dict->serial_len() < strings.serial_len() / 4);
+    assert(DictStringArray::encode(strings, 1) == nullptr);
+
+    char* serial = dict->serialize();
+    Deserializer deserializer(serial);
+    StringArray* read = deserialize_string_array(deserializer);
+    DictStringArray* read_dict = dynamic_cast<DictStringArray*>(read);
+    assert(read_dict != nullptr && read_dict->length() == 300);
+    assert(read_dict->get(3)->equals(&green) && read_dict->get(4)->equals(&red));
+    String blue("blue");
+    assert(read_dict->code_of(&blue) == -1);
+
+    // Plain arrays are still read back as such, and codes widen with the dictionary
+    char* plain_serial = strings.serialize();
+    Deserializer plain_deserializer(plain_serial);
+    StringArray* plain = deserialize_string_array(plain_deserializer);
+    assert(dynamic_cast<DictStringArray*>(plain) == nullptr && plain->equals(&strings));
+    DictStringArray wide;
+    for (size_t ii = 0; ii < 300; ii++) {
+        String str("s");
+        str.concat(ii);
+        wide.push(&str);
+    }
+    char* wide_serial = wide.serialize();
+    Deserializer wide_deserializer(wide_serial);
+    DictStringArray wide2(wide_deserializer);
+    assert(wide2.codes()[299] == 299 && wide2.equals(&wide));
+
+    // Missing strings are encoded through the missing bits, and read back as such
+    StringArray sparse(4);
+    for (size_t ii = 0; ii < 100; ii++) sparse.push(ii % 5 == 0 ? nullptr : ii % 2 ? &red : &green);
+    DictStringArray* sparse_dict = DictStringArray::encode(sparse, 2);
+    assert(sparse_dict != nullptr && sparse_dict->num_missing() == 20);
+    assert(sparse_dict->get(5) == nullptr && sparse_dict->codes()[5] == -1);
+    assert(sparse_dict->equals(&sparse));
+    char* sparse_serial = sparse_dict->serialize();
+    Deserializer sparse_deserializer(sparse_serial);
+    DictStringArray sparse2(sparse_deserializer);
+    assert(sparse2.equals(&sparse) && sparse2.codes()[95] == -1 && sparse2.is_missing(95));
+    assert(DictStringArray::encode(sparse, 1) == nullptr);
+
+    delete[] serial;
+    delete[] plain_serial;
+    delete[] wide_serial;
+    delete[] sparse_serial;
+    delete sparse_dict;
+    delete read;
+    delete plain;
+    delete dict;
+    printf("DictStringArray serialization passed!\n");
+}
+
+void test_missing_elements() {
+    IntArray ints(4);
+    StringArray strings(4);
+    String word("word");
+    for (size_t ii = 0; ii < 130; ii++) {
+        ints.push((int)ii);
+        strings.push(ii % 3 == 0 ? nullptr : &word);
+    }
+    ints.set_missing(7);
+    ints.set_missing(129);
+    assert(ints.num_missing() == 2 && strings.num_missing() == 44);
+    assert(strings.get(3) == nullptr && strings.is_missing(3) && !strings.is_missing(4));
+
+    // Arrays without missing elements keep their serial form
+    IntArray plain(4);
+    plain.push(1);
+    IntArray with_one(4);
+    with_one.push(1);
+    with_one.set_missing(0);
+    assert(with_one.serial_len() == plain.serial_len() + sizeof(uint64_t));
+    assert(!with_one.equals(&plain));
+
+    char* int_serial = ints.serialize();
+    Deserializer int_deserializer(int_serial);
+    IntArray ints2(int_deserializer);
+    assert(ints2.equals(&ints) && ints2.is_missing(129) && !ints2.is_missing(128));
+    char* string_serial = strings.serialize();
+    Deserializer string_deserializer(string_serial);
+    StringArray* strings2 = deserialize_string_array(string_deserializer);
+    assert(strings2->equals(&strings) && strings2->get(129) == nullptr);
+    assert(strings2->get(128)->equals(&word));
+
+    // Removing an element shifts the bits after it
+    ints.remove(0);
+    assert(ints.is_missing(6) && ints.is_missing(128) && ints.num_missing() == 2);
+    strings.replace(0, &word);
+    assert(!strings.is_missing(0) && strings.num_missing() == 43);
+
+    delete[] int_serial;
+    delete[] string_serial;
+    delete strings2;
+    printf("Missing elements serialization passed!\n");
+}
+
+void test_blob_string_array() {
+    StringArray strings(4);
+    for (size_t ii = 0; ii < 150; ii++) {
+        String str("s");
+        str.concat(ii);
+        strings.push(ii % 10 == 3 ? nullptr : &str);
+    }
+    BlobStringArray blob(strings);
+    assert(blob.length() == 150 && blob.num_missing() == 15);
+    assert(blob.equals(&strings) && strings.equals(&blob));
+    assert(blob.get(13) == nullptr && blob.chars(13) == nullptr);
+    assert(strcmp(blob.get(149)->c_str(), "s149") == 0 && blob.get(149)->size() == 4);
+    assert(blob.chars_equal(42, "s42", 3) && !blob.chars_equal(42, "s4", 2));
+    // An offset instead of a length and a pointer per string
+    assert(blob.serial_len() < strings.serial_len());
+
+    char* serial = blob.serialize();
+    Deserializer deserializer(serial);
+    StringArray* read = deserialize_string_array(deserializer);
+    BlobStringArray* read_blob = dynamic_cast<BlobStringArray*>(read);
+    assert(read_blob != nullptr && read_blob->equals(&strings));
+    assert(read_blob->get(0)->c_str() == read_blob->chars(0) && read_blob->get(23) == nullptr);
+    BlobStringArray* copy = read_blob->clone();
+    assert(copy->equals(&blob) && copy->chars(5) != read_blob->chars(5));
+    copy->clear();
+    assert(copy->length() == 0 && copy->num_missing() == 0);
+
+    // Changing a blob turns it into a plain array of its own strings, through any pointer to it
+    StringArray* changed = read_blob->clone();
+    String added("added");
+    changed->push(&added);
+    delete changed->remove(0);
+    delete changed->replace(22, &added);
+    assert(changed->length() == 150 && changed->get(149)->equals(&added));
+    assert(strcmp(changed->get(0)->c_str(), "s1") == 0 && changed->get(22)->equals(&added));
+    BlobStringArray* changed_blob = dynamic_cast<BlobStringArray*>(changed);
+    assert(changed_blob->chars_equal(1, "s2", 2) && changed_blob->chars(12) == nullptr);
+    char* changed_serial = changed->serialize();
+    Deserializer changed_deserializer(changed_serial);
+    StringArray* changed_read = deserialize_string_array(changed_deserializer);
+    assert(changed_read->equals(changed) && changed_read->num_missing() == 14);
+    BlobStringArray* changed_copy = changed_blob->clone();
+    assert(changed_copy->equals(changed) && changed_copy->chars(5) != changed_blob->chars(5));
+
+    // Dictionary arrays keep their codes through the same changes
+    DictStringArray* dict = DictStringArray::encode(strings, 150);
+    delete dict->remove(0);
+    delete dict->replace(0, &added);
+    delete dict->replace(1, nullptr);
+    dict->push_owned(new String("s5"));
+    assert(dict->length() == 150 && dict->get(0)->equals(&added) && dict->get(1) == nullptr);
+    assert(dict->codes()[149] == dict->code_of(dict->get(4)) && dict->num_missing() == 16);
+
+    delete[] serial;
+    delete[] changed_serial;
+    delete read;
+    delete copy;
+    delete changed;
+    delete changed_read;
+    delete changed_copy;
+    delete dict;
+    printf("BlobStringArray serialization passed!\n");
+}
+
 int main(int argc, char const *argv[]) 
 {   
     serializing_test();
@@ -1288,7 +1552,12 @@ int main(int argc, char const *argv[])
     test_bool_array();
     test_double_array();
     test_int_array();
+    test_int_encodings();
     test_string_array();
+    test_dict_string_array();
+    test_missing_elements();
+    test_blob_string_array();
+    test_dense_array_serial_len();
     test_key();
     test_ack();
     test_put();
@@ -100,14 +100,38 @@ void test_doc_txt(char* file_path) {
     delete dataframe;
 }
 
+void test_missing_txt(char* file_path) {
+    KV_Store kv(0);
+    String name("data");
+    SoR sor(file_path, &name, &kv);
+    DataFrame* dataframe = sor.get_dataframe();
+
+    String* schema_types = dataframe->get_schema().types_;
+    assert(strcmp("ISD", schema_types->c_str()) == 0);
+    assert(dataframe->nrows() == 5);
+
+    // Fields written <> and fields past the end of a line are missing, <""> is not
+    assert(dataframe->is_missing(0, 0) && !dataframe->is_missing(0, 1));
+    assert(dataframe->is_missing(1, 1) && dataframe->get_string(1, 1) == nullptr);
+    assert(dataframe->is_missing(1, 2) && dataframe->is_missing(2, 2));
+    assert(!dataframe->is_missing(1, 3) && dataframe->get_string(1, 3)->size() == 0);
+    assert(dataframe->is_missing(2, 3) && !dataframe->is_missing(2, 4));
+    assert(dataframe->num_missing(2) == 3);
+    assert(dataframe->sum(0) == 39);
+
+    delete dataframe;
+}
+
 int main(int argh, char** argv) {
     char* easy_txt = const_cast<char*>("data/easy.txt");
     char* doc_txt = const_cast<char*>("data/doc.txt");
+    char* missing_txt = const_cast<char*>("data/missing.txt");
 
     test_file(easy_txt, 5, 1);
     test_file(doc_txt, 2, 5);
     test_easy_txt(easy_txt);
     test_doc_txt(doc_txt);
+    test_missing_txt(missing_txt);
     printf("SoR Tests Complete!\n");
     return 0;
 } 
\ No newline at end of file
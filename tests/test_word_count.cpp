@@ -60,7 +60,7 @@ public:
     p("Node ").p(node_index_).pln(": starting local count...");
     SIMap map;
     Adder add(map);
-    words->local_map(add);
+    words->local_pmap(add);
     assert(map.size() < FILE_WORD_COUNT);
     assert(map.size() > 0);
     delete words;
@@ -96,6 +96,19 @@ public:
     p("Different words: ").pln(map.size());
     assert(map.size() == DIFFERENT_WORD_COUNT);
     delete own;
+
+    // Shipping the count to the nodes holding the words gives the same counts
+    DataFrame* words = kd_.get(&in);
+    SIMap shipped;
+    Adder add(shipped);
+    words->ship_map(add);
+    assert(shipped.size() == DIFFERENT_WORD_COUNT);
+    StringArray* keys = shipped.key_set();
+    size_t total = 0;
+    for (size_t ii = 0; ii < keys->length(); ii++) total += shipped.get(keys->get(ii))->value;
+    assert(total == FILE_WORD_COUNT);
+    delete keys;
+    delete words;
   }
  
   void merge(DataFrame* df, SIMap& m) {
@@ -139,6 +152,7 @@ void test_word_count() {
   for (int i = 0; i < num_nodes; i++) {
     int st;
     waitpid(cpid[i], &st, 0);
+    assert(st == 0);
   }
   delete server;
   delete[] client_ips;